@@ -0,0 +1,403 @@
+#!/usr/bin/env python3
+"""Pack sprites of one pixel format into shared atlas pages.
+
+Every image (every frame of an animated one) is trimmed of its transparent
+borders, identical sprites are stored once, and the rest is packed into
+pages of PAGE_WIDTH x at most PAGE_HEIGHT pixels (bottom-left skyline, tallest
+sprites first). The pages are emitted as one C array, followed by a constexpr
+sprite table for ge-app/sprite.hpp:
+
+    namespace ge::atlas::<symbol> {
+      constexpr SpriteRef <name>;          // still images
+      constexpr SpriteRef <name>[];        // animations, one per frame
+      constexpr u32 <name>_FRAME_COUNT;
+      constexpr RotatedSprite <name>;      // <name>@<directions>=<image>
+    }
+
+A sprite given as name@N=image is pre-rotated to N directions around its
+pivot (--pivot name=x,y, the center by default), each direction trimmed on
+its own.
+
+With --rle, every row of the trimmed sprites is also described as runs of
+(transparent, opaque, blended) pixels, so that the blitter can skip the
+transparent ones and copy the opaque ones (see ge-app/gfx/rle.hpp). The runs
+index into the page pixels, which are not duplicated. Sprites that are mostly
+blended (soft glows, the whirlpool) gain nothing from runs and are left to the
+GPU blend.
+
+With --premultiplied (argb8888 only), the colors are stored multiplied by
+their alpha and the sprites are drawn with the premultiplied blend, see
+hal::gpu::blit_blend_premultiplied().
+"""
+
+import argparse
+
+import numpy as np
+from PIL import Image
+
+import bin2c
+import bin2c_image
+
+
+class Sprite:
+    def __init__(self, name, frame, img, duration, pivot=None):
+        self.name = name
+        self.frame = frame
+        self.duration = duration
+        self.width, self.height = img.size
+        self.pivot = pivot or (self.width // 2, self.height // 2)
+
+        bbox = (0, 0, self.width, self.height)
+        if img.mode == "RGBA":
+            # None when fully transparent
+            bbox = img.getchannel("A").getbbox() or (0, 0, 0, 0)
+        self.trim = (bbox[0], bbox[1])
+        self.w, self.h = bbox[2] - bbox[0], bbox[3] - bbox[1]
+        self.img = img.crop(bbox)
+        self.page, self.x, self.y = 0, 0, 0
+        self.dup_of = None
+
+
+def load_rotated(name, path, directions, pivot):
+    """The image at path rotated clockwise to each of the directions."""
+    img = Image.open(path).convert("RGBA")
+    if pivot is None:
+        pivot = (img.size[0] // 2, img.size[1] // 2)
+    sprites = []
+    for i in range(directions):
+        rotated, center = bin2c_image.rotate_around(img, i * 360 / directions, pivot)
+        sprites.append(Sprite(name, i, rotated, 0, center))
+    return sprites
+
+
+def load_sprites(name, path, mode, pivot=None):
+    """All frames of the image at path, trimmed unless the mode is opaque."""
+    img = Image.open(path)
+    frames = []
+    for i in range(getattr(img, "n_frames", 1)):
+        if i > 0:
+            img.seek(i)
+        frame = img.convert("RGBA").copy()
+        if mode == "rgb565":
+            frame = frame.convert("RGB")
+        frames.append((frame, img.info.get("duration", 100)))
+
+    if len(frames) == 1:
+        return [Sprite(name, None, frames[0][0], 0, pivot)]
+    return [Sprite(name, i, f, d, pivot) for i, (f, d) in enumerate(frames)]
+
+
+class Skyline:
+    """Bottom-left skyline packer for one page."""
+
+    def __init__(self, width, height):
+        self.width, self.height = width, height
+        self.segments = [(0, 0, width)]  # x, y, w
+        self.used_height = 0
+
+    def place(self, w, h):
+        best = None
+        for i, (x, _, _) in enumerate(self.segments):
+            if x + w > self.width:
+                break
+            # the sprite rests on the highest segment under it
+            y, covered, j = 0, 0, i
+            while covered < w:
+                y = max(y, self.segments[j][1])
+                covered += self.segments[j][2]
+                j += 1
+            if y + h <= self.height and (best is None or (y + h, x) < best[:2]):
+                best = (y + h, x, y)
+        if best is None:
+            return None
+
+        top, x, y = best
+        # replace the segments under the sprite by one at its top
+        segments = []
+        for sx, sy, sw in self.segments:
+            if sx + sw <= x or sx >= x + w:
+                segments.append((sx, sy, sw))
+                continue
+            if sx < x:
+                segments.append((sx, sy, x - sx))
+            if sx + sw > x + w:
+                segments.append((x + w, sy, sx + sw - (x + w)))
+        segments.append((x, top, w))
+        segments.sort()
+        self.segments = segments
+        self.used_height = max(self.used_height, top)
+        return x, y
+
+
+def pack(sprites, page_width, page_height):
+    """Places the sprites, returns the (width, height) of every page."""
+    unique = {}
+    to_place = []
+    for s in sprites:
+        if s.w == 0 or s.h == 0:
+            continue
+        key = (s.w, s.h, s.img.tobytes())
+        if key in unique:
+            s.dup_of = unique[key]
+        else:
+            unique[key] = s
+            to_place.append(s)
+
+    to_place.sort(key=lambda s: (-s.h, -s.w, s.name, s.frame or 0))
+    pages = []
+    for s in to_place:
+        if s.w > page_width or s.h > page_height:
+            raise ValueError(
+                f"{s.name}: {s.w}x{s.h} does not fit in a "
+                f"{page_width}x{page_height} page"
+            )
+        for index, page in enumerate(pages):
+            pos = page.place(s.w, s.h)
+            if pos is not None:
+                break
+        else:
+            pages.append(Skyline(page_width, page_height))
+            index, pos = len(pages) - 1, pages[-1].place(s.w, s.h)
+        s.page, (s.x, s.y) = index, pos
+
+    for s in sprites:
+        if s.dup_of is not None:
+            s.page, s.x, s.y = s.dup_of.page, s.dup_of.x, s.dup_of.y
+
+    return [(page_width, page.used_height) for page in pages]
+
+
+# sprites with more blended pixels than this are not run-length encoded
+RLE_MAX_BLENDED = 0.25
+
+
+def encode_runs(img):
+    """The rows of an RGBA image as runs, for --rle.
+
+    Every row is a count n followed by n (skip, opaque, blended) triples of
+    u8 lengths. Transparent pixels at the end of a row are left out.
+
+    Returns:
+        List of bytes, one per row
+    """
+    alpha = np.asarray(img.convert("RGBA"), dtype=np.uint8)[:, :, 3]
+    kinds = np.where(alpha == 0, 0, np.where(alpha == 255, 1, 2))
+    rows = []
+    for row in kinds:
+        # lengths of alternating skip/opaque/blended stretches
+        lengths = []
+        kind, x, w = 0, 0, len(row)
+        while x < w:
+            start = x
+            while x < w and row[x] == kind:
+                x += 1
+            lengths.append(x - start)
+            kind = (kind + 1) % 3
+        while len(lengths) % 3:
+            lengths.append(0)
+
+        triples = []
+        for i in range(0, len(lengths), 3):
+            skip, opaque, blended = lengths[i : i + 3]
+            # split lengths that don't fit a u8 with empty runs in between
+            while skip > 255:
+                triples.append((255, 0, 0))
+                skip -= 255
+            while opaque > 255:
+                triples.append((skip, 255, 0))
+                skip, opaque = 0, opaque - 255
+            while blended > 255:
+                triples.append((skip, opaque, 255))
+                skip, opaque, blended = 0, 0, blended - 255
+            triples.append((skip, opaque, blended))
+        while triples and triples[-1][1:] == (0, 0):
+            triples.pop()
+        if len(triples) > 255:
+            raise ValueError(f"row of {w} px has too many runs")
+        rows.append(bytes([len(triples)] + [v for t in triples for v in t]))
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("output_c")
+    parser.add_argument("output_h")
+    parser.add_argument("symbol")
+    parser.add_argument("mode", choices=["rgb565", "argb1555", "argb8888"])
+    parser.add_argument("--page-width", type=int, default=128)
+    parser.add_argument("--page-height", type=int, default=256)
+    parser.add_argument("--pivot", action="append", default=[], metavar="name=x,y")
+    parser.add_argument("--rle", action="store_true", help="emit sprite runs")
+    parser.add_argument(
+        "--premultiplied", action="store_true", help="premultiply colors by alpha"
+    )
+    parser.add_argument("sprites", nargs="+", metavar="name[@directions]=image")
+    args = parser.parse_args()
+
+    pivots = {}
+    for spec in args.pivot:
+        name, xy = spec.split("=", 1)
+        pivots[name] = tuple(int(v) for v in xy.split(","))
+
+    sym = args.symbol
+    names = []
+    sprites = []
+    for spec in args.sprites:
+        name, path = spec.split("=", 1)
+        directions = 0
+        if "@" in name:
+            name, directions = name.split("@", 1)
+            directions = int(directions)
+        names.append((name, directions))
+        if directions:
+            sprites += load_rotated(name, path, directions, pivots.get(name))
+        else:
+            sprites += load_sprites(name, path, args.mode, pivots.get(name))
+
+    page_sizes = pack(sprites, args.page_width, args.page_height)
+
+    # pages are stored one after the other
+    page_data = []
+    offsets = []
+    offset = 0
+    for i, (w, h) in enumerate(page_sizes):
+        page = Image.new("RGBA", (w, h), (0, 0, 0, 0))
+        for s in sprites:
+            if s.page == i and s.w > 0 and s.h > 0:
+                page.paste(s.img.convert("RGBA"), (s.x, s.y))
+        data, _, _ = bin2c_image.convert_image_to_data(
+            page, args.mode, args.premultiplied
+        )
+        page_data.append(data)
+        offsets.append(offset)
+        offset += w * h
+    data = np.concatenate(page_data) if page_data else np.zeros(0, np.uint16)
+
+    format_raw = {"argb8888": 0, "rgb565": 2, "argb1555": 3}[args.mode]
+    header_additional = f"""
+#define {sym}_PAGE_COUNT {len(page_sizes)}
+#define {sym}_FORMAT_RAW {format_raw}
+#define {sym}_FORMAT_CPP static_cast<ge::PixelFormat>({format_raw})
+"""
+
+    # runs of every sprite row, duplicates share the rows of their original
+    source_additional = ""
+    if args.rle:
+        row_offsets, runs = [], bytearray()
+        for s in sprites:
+            s.rle_row = "SpriteDesc::NO_RLE"
+            if s.dup_of is not None or s.w == 0 or s.h == 0:
+                continue
+            rows = encode_runs(s.img)
+            blended = sum(sum(row[3::3]) for row in rows)
+            if blended > RLE_MAX_BLENDED * s.w * s.h:
+                continue
+            s.rle_row = len(row_offsets)
+            for row in rows:
+                row_offsets.append(len(runs))
+                runs += row
+        for s in sprites:
+            if s.dup_of is not None:
+                s.rle_row = s.dup_of.rle_row
+
+        header_additional += f"""
+// see atlas.py --rle
+extern const uint32_t {sym}_rle_rows[];
+extern const uint8_t {sym}_rle_runs[];
+"""
+        rows_csv = ",".join(str(o) for o in row_offsets)
+        runs_csv = ",".join(str(b) for b in runs)
+        source_additional = (
+            f"const uint32_t {sym}_rle_rows[] = {{{rows_csv}}};\n"
+            f"const uint8_t {sym}_rle_runs[] = {{{runs_csv}}};\n"
+        )
+
+    bin2c.main(
+        data,
+        args.output_c,
+        args.output_h,
+        sym,
+        header_additional=header_additional,
+        dtype="uint32_t" if args.mode == "argb8888" else "uint16_t",
+        source_additional=source_additional,
+    )
+
+    # the sprite table, for C++ only
+    atlas_fields = [f"::{sym}", f"{sym}_FORMAT_CPP", "PAGES"]
+    if args.rle:
+        atlas_fields += [f"::{sym}_rle_rows", f"::{sym}_rle_runs"]
+    elif args.premultiplied:
+        atlas_fields += ["nullptr", "nullptr"]
+    if args.premultiplied:
+        atlas_fields.append("true")
+    lines = [
+        "",
+        "#ifdef __cplusplus",
+        '#include "ge-app/sprite.hpp"',
+        "",
+        "namespace ge {",
+        "namespace atlas {",
+        f"namespace {sym} {{",
+        "",
+        "constexpr AtlasPage PAGES[] = {",
+    ]
+    for (w, h), off in zip(page_sizes, offsets):
+        lines.append(f"    {{{off}, {w}, {h}}},")
+    lines += [
+        "};",
+        f"constexpr Atlas ATLAS{{{', '.join(atlas_fields)}}};",
+        "",
+        "// page, x, y, w, h, trim x, trim y, width, height, pivot x, pivot y,",
+        "// duration" + (", first RLE row" if args.rle else ""),
+        "constexpr SpriteDesc SPRITES[] = {",
+    ]
+    for s in sprites:
+        label = s.name if s.frame is None else f"{s.name}[{s.frame}]"
+        rle = f", {s.rle_row}" if args.rle else ""
+        lines.append(
+            f"    {{{s.page}, {s.x}, {s.y}, {s.w}, {s.h}, {s.trim[0]}, "
+            f"{s.trim[1]}, {s.width}, {s.height}, {s.pivot[0]}, {s.pivot[1]}, "
+            f"{s.duration}{rle}}}, // {label}"
+        )
+    lines += ["};", ""]
+
+    index = 0
+    for name, directions in names:
+        frames = [s for s in sprites if s.name == name]
+        refs = ", ".join(
+            f"{{ATLAS, SPRITES[{index + i}]}}" for i in range(len(frames))
+        )
+        if directions:
+            lines.append(f"constexpr SpriteRef {name}_DIRECTIONS[] = {{{refs}}};")
+            lines.append(
+                f"constexpr RotatedSprite {name}{{{name}_DIRECTIONS, {directions}}};"
+            )
+        elif frames[0].frame is None:
+            lines.append(f"constexpr SpriteRef {name}{{ATLAS, SPRITES[{index}]}};")
+        else:
+            lines.append(f"constexpr u32 {name}_FRAME_COUNT = {len(frames)};")
+            lines.append(f"constexpr SpriteRef {name}[] = {{{refs}}};")
+        index += len(frames)
+
+    lines += [
+        "",
+        f"}} // namespace {sym}",
+        "} // namespace atlas",
+        "} // namespace ge",
+        "#endif",
+    ]
+    with open(args.output_h, "a") as f:
+        f.write("\n".join(lines) + "\n")
+
+    used = sum(w * h for w, h in page_sizes)
+    loose = sum(s.width * s.height for s in sprites)
+    print(
+        f"atlas {sym}: {len(sprites)} sprites in {len(page_sizes)} page(s), "
+        f"{used} px instead of {loose} px"
+    )
+    if args.rle:
+        print(f"atlas {sym}: {len(runs)} bytes of runs for {len(row_offsets)} rows")
+
+
+if __name__ == "__main__":
+    main()
@@ -2,7 +2,15 @@ import sys
 import os
 
 
-def main(data, out_c, out_h, name, header_additional="", dtype="uint8_t"):
+def main(
+    data,
+    out_c,
+    out_h,
+    name,
+    header_additional="",
+    dtype="uint8_t",
+    source_additional="",
+):
     # -------- generate .c --------
     with open(out_c, "w") as f:
         f.write("#include <stdint.h>\n")
@@ -16,6 +24,9 @@ def main(data, out_c, out_h, name, header_additional="", dtype="uint8_t"):
         f.write("\n};\n\n")
 
         f.write(f"const uint32_t {name}_len = {len(data)};\n")
+        if source_additional:
+            f.write("\n")
+            f.write(source_additional)
 
         # Create parent dir
         os.makedirs(os.path.dirname(out_c), exist_ok=True)
@@ -4,7 +4,68 @@ import bin2c  # pyright: ignore[reportImplicitRelativeImport]
 import math
 
 
-def main(font_file: str, font_size: int, out_c: str, out_h: str, symbol: str):
+def encode_spans(pixels, width, height):
+    """The lit pixels of a glyph as horizontal spans, row by row.
+
+    Every row is a count n followed by n (x, length) pairs of u8, so that the
+    renderer writes whole spans instead of testing every bit of the cell.
+
+    Returns:
+        bytes of all the rows
+    """
+    out = bytearray()
+    for y in range(height):
+        row = pixels[y * width : (y + 1) * width]
+        spans = []
+        x = 0
+        while x < width:
+            if not row[x]:
+                x += 1
+                continue
+            start = x
+            while x < width and row[x]:
+                x += 1
+            spans.append((start, x - start))
+        out.append(len(spans))
+        for start, length in spans:
+            out += bytes([start, length])
+    return bytes(out)
+
+
+def encode_coverage(pixels, width, height, bpp):
+    """Coverage of a glyph cell, row by row, for A8 or A4.
+
+    This is the glyph as FreeType renders it in grayscale: anti-aliased
+    edges for outline fonts, only 0 and 255 for pixel fonts like Pixeloid at
+    their native sizes.
+
+    A4 packs two pixels per byte, the first one in the low nibble like the
+    DMA2D reads them. Every row starts on a byte, an odd width pads the last
+    byte of the row with a zero nibble.
+
+    Returns:
+        bytes of the cell
+    """
+    if bpp == 8:
+        return bytes(pixels)
+    out = bytearray()
+    for y in range(height):
+        row = [(v * 15 + 127) // 255 for v in pixels[y * width : (y + 1) * width]]
+        if width % 2:
+            row.append(0)
+        for x in range(0, len(row), 2):
+            out.append(row[x] | (row[x + 1] << 4))
+    return bytes(out)
+
+
+def main(
+    font_file: str,
+    font_size: int,
+    out_c: str,
+    out_h: str,
+    symbol: str,
+    coverage_bpp: int = 0,
+):
     # print getcwd
     print("Current working directory:", sys.path[0])
     print(font_file)
@@ -49,6 +110,9 @@ def main(font_file: str, font_size: int, out_c: str, out_h: str, symbol: str):
 
     buf = bytearray()
     advances = []
+    spans = bytearray()
+    span_offsets = []
+    coverage = bytearray()
 
     # We align text based on the baseline.
     # Usually, drawing at y = ascent - bbox_top is complex.
@@ -88,6 +152,41 @@ def main(font_file: str, font_size: int, out_c: str, out_h: str, symbol: str):
                 buf.append(byte_val)
         advances.append(real_advance)
 
+        span_offsets.append(len(spans))
+        spans += encode_spans(pixels, CELL_W, CELL_H)
+
+        if coverage_bpp:
+            # the same glyph in grayscale
+            img = Image.new("L", (CELL_W, CELL_H), 0)
+            draw = ImageDraw.Draw(img)
+            draw.text((0, ascent), ch, fill=255, font=font, anchor="ls")
+            coverage += encode_coverage(
+                list(img.getdata()), CELL_W, CELL_H, coverage_bpp
+            )
+
+    if len(spans) > 0xFFFF:
+        raise ValueError(f"{len(spans)} bytes of spans don't fit u16 offsets")
+    spans_csv = ",".join(str(b) for b in spans)
+    offsets_csv = ",".join(str(o) for o in span_offsets)
+
+    # cells of CELL_W x CELL_H coverage pixels, one after the other, A4 rows
+    # padded to whole bytes
+    if coverage_bpp:
+        coverage_csv = ",".join(str(b) for b in coverage)
+        coverage_header = (
+            f"#define {symbol}_COVERAGE_BPP {coverage_bpp}\n"
+            f"extern const uint8_t {symbol}_COVERAGE[];\n"
+        )
+        coverage_source = (
+            f"const uint8_t {symbol}_COVERAGE[] = {{{coverage_csv}}};\n"
+        )
+    else:
+        coverage_header = (
+            f"#define {symbol}_COVERAGE_BPP 0\n"
+            f"#define {symbol}_COVERAGE ((const uint8_t *)0)\n"
+        )
+        coverage_source = ""
+
     bin2c.main(
         buf,
         out_c,
@@ -101,18 +200,38 @@ def main(font_file: str, font_size: int, out_c: str, out_h: str, symbol: str):
 #define {symbol}_BYTES_PER_ROW {BYTES_PER_ROW}
 
 static const unsigned char {symbol}_ADVANCES[] = {{{", ".join(str(a) for a in advances)}}};
+
+// see bin2c_bitmap_font.py, encode_spans()
+extern const uint8_t {symbol}_SPANS[];
+extern const uint16_t {symbol}_SPAN_OFFSETS[];
+
+// coverage glyphs, see --coverage
+{coverage_header}
     """,
+        source_additional=(
+            f"const uint8_t {symbol}_SPANS[] = {{{spans_csv}}};\n"
+            f"const uint16_t {symbol}_SPAN_OFFSETS[] = {{{offsets_csv}}};\n"
+            + coverage_source
+        ),
     )
 
 
 if __name__ == "__main__":
     if len(sys.argv) < 6:
         print(
-            "usage: bin2c_bitmap_font.py <font.ttf> <output.c> <output.h> <symbol> <font_size> [additional_args...]"
+            "usage: bin2c_bitmap_font.py <font.ttf> <output.c> <output.h> <symbol> <font_size> [--coverage a8|a4]"
         )
         sys.exit(1)
 
     font_path, out_c, out_h, symbol, font_size_str = sys.argv[1:6]
-    # Additional args are ignored for now but accepted for consistency
     font_size = int(font_size_str)
-    main(font_path, font_size, out_c, out_h, symbol)
+    # --coverage also emits A8 or A4 coverage glyphs, for
+    # hal::gpu::blit_blend_alpha()
+    coverage_bpp = 0
+    extra = sys.argv[6:]
+    if "--coverage" in extra:
+        mode = extra[extra.index("--coverage") + 1].lower()
+        if mode not in ("a8", "a4"):
+            raise ValueError(f"unknown coverage format {mode}, use a8 or a4")
+        coverage_bpp = 8 if mode == "a8" else 4
+    main(font_path, font_size, out_c, out_h, symbol, coverage_bpp)
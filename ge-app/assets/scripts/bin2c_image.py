@@ -1,5 +1,6 @@
 #!/usr/bin/env python3
 
+import math
 import sys
 from PIL import Image
 import numpy as np
@@ -19,12 +20,20 @@ def argb888_to_argb1555(r, g, b, a):
     return ((1 if a else 0) << 15) | ((r >> 3) << 10) | ((g >> 3) << 5) | (b >> 3)
 
 
-def argb8_pack(r, g, b, a):
+def argb8_pack(r, g, b, a, premultiplied=False):
+    if premultiplied:
+        # round(c * a / 255), see hal::gpu::blit_blend_premultiplied()
+        r, g, b = ((c * a + 127) // 255 for c in (r, g, b))
     return (a << 24) | (r << 16) | (g << 8) | b
 
 
-def convert_image_to_data(img: Image.Image, mode: str):
-    """Convert a PIL Image to pixel data in the specified format."""
+def convert_image_to_data(img: Image.Image, mode: str, premultiplied=False):
+    """Convert a PIL Image to pixel data in the specified format.
+
+    With premultiplied, argb8888 colors are multiplied by their alpha.
+    """
+    if premultiplied and mode != "argb8888":
+        raise ValueError(f"{mode} can't be premultiplied, only argb8888")
     img = img.convert("RGBA")
     w, h = img.size
     px = img.load()
@@ -43,14 +52,123 @@ def convert_image_to_data(img: Image.Image, mode: str):
             elif mode == "argb1555":
                 data.append(argb888_to_argb1555(r, g, b, a > 0))
             elif mode == "argb8888":
-                data.append(argb8_pack(r, g, b, a))
+                data.append(argb8_pack(r, g, b, a, premultiplied))
             else:
                 raise ValueError(f"unknown mode: {mode}")
 
     return np.array(data, dtype=dtype), w, h
 
 
-def rotate_image(img: Image.Image, angle: int, mode: str):
+# Palettized modes: one index per pixel into an ARGB8888 palette (the DMA2D
+# CLUT format). "indexed" picks l4 when the image has at most 16 colors.
+INDEXED_MODES = ("l8", "l4", "indexed")
+
+
+def median_cut(colors, counts, max_colors):
+    """Group colors (N x 4 RGBA) into at most max_colors boxes.
+
+    The box with the widest channel range, weighted by its pixel count, is
+    split at the weighted median of that channel until there are enough boxes.
+
+    Returns:
+        List of arrays of indices into colors, one per box
+    """
+    colors = colors.astype(np.int64)
+
+    def measure(box):
+        c = colors[box]
+        ranges = c.max(0) - c.min(0)
+        ch = int(ranges.argmax())
+        return int(ranges[ch]) * int(counts[box].sum()), ch
+
+    boxes = [np.arange(len(colors))]
+    scores = [measure(boxes[0])]
+    while len(boxes) < max_colors:
+        best = max(range(len(boxes)), key=lambda i: scores[i][0])
+        score, ch = scores[best]
+        if score == 0:
+            break  # every box holds a single color
+        box = boxes[best]
+        order = box[np.argsort(colors[box, ch], kind="stable")]
+        cum = np.cumsum(counts[order])
+        split = int(np.searchsorted(cum, cum[-1] / 2)) + 1
+        split = min(max(split, 1), len(order) - 1)
+        boxes[best : best + 1] = [order[:split], order[split:]]
+        scores[best : best + 1] = [measure(order[:split]), measure(order[split:])]
+    return boxes
+
+
+def quantize_image(img: Image.Image, max_colors: int):
+    """Reduce an image to at most max_colors RGBA colors.
+
+    Images that already fit are kept exact. Fully transparent pixels share
+    one palette entry, so that they stay fully transparent.
+
+    Returns:
+        Tuple of (indices, palette): an H x W uint8 array and a list of
+        ARGB8888 colors
+    """
+    rgba = np.asarray(img.convert("RGBA"), dtype=np.uint8).reshape(-1, 4)
+    rgba = rgba.astype(np.uint32)
+    rgba[rgba[:, 3] == 0] = 0
+    keys = rgba[:, 0] << 24 | rgba[:, 1] << 16 | rgba[:, 2] << 8 | rgba[:, 3]
+    uniq, inverse, counts = np.unique(keys, return_inverse=True, return_counts=True)
+    colors = np.stack(
+        [(uniq >> 24) & 0xFF, (uniq >> 16) & 0xFF, (uniq >> 8) & 0xFF, uniq & 0xFF],
+        axis=1,
+    )
+
+    if len(uniq) <= max_colors:
+        boxes = [np.array([i]) for i in range(len(uniq))]
+    else:
+        transparent = np.flatnonzero(uniq == 0)
+        opaque = np.flatnonzero(uniq != 0)
+        boxes = [transparent] if len(transparent) else []
+        boxes += [
+            opaque[box]
+            for box in median_cut(
+                colors[opaque], counts[opaque], max_colors - len(boxes)
+            )
+        ]
+
+    palette = []
+    color_index = np.zeros(len(uniq), dtype=np.uint8)
+    for i, box in enumerate(boxes):
+        weights = counts[box]
+        mean = (colors[box] * weights[:, None]).sum(0) / weights.sum()
+        r, g, b, a = (int(v) for v in np.rint(mean))
+        palette.append(argb8_pack(r, g, b, a))
+        color_index[box] = i
+
+    w, h = img.size
+    return color_index[inverse].reshape(h, w), palette
+
+
+def convert_image_to_indexed(img: Image.Image, mode: str):
+    """Convert a PIL Image to palette indices, packed for mode.
+
+    l4 packs two pixels per byte, the first one in the low nibble.
+
+    Returns:
+        Tuple of (data, w, h, bits, palette)
+    """
+    if mode == "indexed":
+        _, palette = quantize_image(img, 256)
+        mode = "l4" if len(palette) <= 16 else "l8"
+
+    bits = 4 if mode == "l4" else 8
+    indices, palette = quantize_image(img, 1 << bits)
+    h, w = indices.shape
+    data = indices.reshape(-1)
+    if bits == 4:
+        if len(data) % 2:
+            data = np.append(data, np.uint8(0))
+        data = data[0::2] | (data[1::2] << 4)
+
+    return data.astype(np.uint8), w, h, bits, palette
+
+
+def rotate_image(img: Image.Image, angle: int, mode: str, premultiplied=False):
     """Rotate an image by the specified angle (must be multiple of ROTATION_ANGLE_INCREMENT).
 
     Args:
@@ -73,12 +191,37 @@ def rotate_image(img: Image.Image, angle: int, mode: str):
     # expand=True allows the image dimensions to change to fit the rotated content
     rotated = img.rotate(-angle, resample=Image.BICUBIC, expand=True)
 
-    data, w, h = convert_image_to_data(rotated, mode)
+    data, w, h = convert_image_to_data(rotated, mode, premultiplied)
 
     return data, w, h
 
 
-def process_animated_image(img_path: str, mode: str):
+def rotate_around(img: Image.Image, angle: float, pivot):
+    """Rotate an RGBA image clockwise by any angle around pivot.
+
+    The pivot is in pixel-edge coordinates, (0, 0) being the top-left corner of
+    the image. The result is a square canvas with the pivot at its center, big
+    enough for every angle, so that all rotations of an image line up. Trim it
+    afterwards.
+
+    Returns:
+        Tuple of (image, (pivot_x, pivot_y)) for the rotated image
+    """
+    px, py = pivot
+    w, h = img.size
+    radius = math.hypot(max(px, w - px), max(py, h - py))
+    half = int(math.ceil(radius))
+
+    canvas = Image.new("RGBA", (2 * half, 2 * half), (0, 0, 0, 0))
+    canvas.paste(img.convert("RGBA"), (int(half - px), int(half - py)))
+    if angle % 360 != 0:
+        # PIL rotates counter-clockwise around the center of the canvas
+        canvas = canvas.rotate(-angle, resample=Image.BICUBIC)
+
+    return canvas, (half, half)
+
+
+def process_animated_image(img_path: str, mode: str, premultiplied=False):
     """Process animated images (APNG, WEBP, GIF) and extract frames.
 
     Returns:
@@ -109,7 +252,7 @@ def process_animated_image(img_path: str, mode: str):
 
     if len(frames) == 1:
         # Not actually animated, process as single image
-        data, w, h = convert_image_to_data(frames[0], mode)
+        data, w, h = convert_image_to_data(frames[0], mode, premultiplied)
         return data, w, h, None, None, None, None
 
     # Create horizontal spritesheet from frames
@@ -122,7 +265,7 @@ def process_animated_image(img_path: str, mode: str):
     for i, frame in enumerate(frames):
         spritesheet.paste(frame, (i * frame_w, 0))
 
-    data, w, h = convert_image_to_data(spritesheet, mode)
+    data, w, h = convert_image_to_data(spritesheet, mode, premultiplied)
 
     return data, w, h, frame_w, frame_h, len(frames), frame_durations
 
@@ -135,6 +278,7 @@ def main(
     mode: str,
     rotation_angle: int = 0,
     animated: bool = False,
+    premultiplied: bool = False,
 ):
     """
     Main processing function.
@@ -147,19 +291,44 @@ def main(
         mode: Color mode (rgb565 or argb1555)
         rotation_angle: Rotation angle in degrees (must be multiple of 45, 0 = no rotation)
         animated: Whether to process as animated image
+        premultiplied: Whether to premultiply argb8888 colors by their alpha
     """
     header_additional = ""
+    source_additional = ""
     # see surface.hpp for these values
     format_raw = {
         "argb8888": 0,
         "rgb565": 2,
         "argb1555": 3,
+        "l8": 5,
+        "l4": 8,
+        "indexed": None,
     }[mode]
 
-    if rotation_angle != 0:
+    if mode in INDEXED_MODES:
+        if rotation_angle != 0 or animated:
+            raise ValueError(f"{mode} textures can't be rotated or animated")
+
+        img = Image.open(inp_img)
+        data, w, h, bits, palette = convert_image_to_indexed(img, mode)
+        format_raw = 5 if bits == 8 else 8
+        palette_csv = ",".join(f"0x{c:08x}" for c in palette)
+
+        header_additional = f"""
+#define {sym}_WIDTH {w}
+#define {sym}_HEIGHT {h}
+#define {sym}_FORMAT_RAW {format_raw}
+#define {sym}_FORMAT_CPP static_cast<ge::PixelFormat>({format_raw})
+#define {sym}_PALETTE_SIZE {len(palette)}
+
+// ARGB8888, for hal::gpu::load_palette()
+extern const uint32_t {sym}_palette[];
+        """
+        source_additional = f"const uint32_t {sym}_palette[] = {{{palette_csv}}};\n"
+    elif rotation_angle != 0:
         # Rotate image by specified angle
         img = Image.open(inp_img).convert("RGBA")
-        data, w, h = rotate_image(img, rotation_angle, mode)
+        data, w, h = rotate_image(img, rotation_angle, mode, premultiplied)
 
         header_additional = f"""
 #define {sym}_WIDTH {w}
@@ -169,7 +338,7 @@ def main(
     elif animated:
         # Process animated image
         data, w, h, frame_w, frame_h, frame_count, frame_durations = (
-            process_animated_image(inp_img, mode)
+            process_animated_image(inp_img, mode, premultiplied)
         )
 
         if frame_count is None:
@@ -195,7 +364,7 @@ static const unsigned short {sym}_FRAME_DURATIONS[] = {{{duration_values_csv}}};
     else:
         # Simple static image
         img = Image.open(inp_img)
-        data, w, h = convert_image_to_data(img, mode)
+        data, w, h = convert_image_to_data(img, mode, premultiplied)
 
         header_additional = f"""
 #define {sym}_WIDTH {w}
@@ -204,6 +373,12 @@ static const unsigned short {sym}_FRAME_DURATIONS[] = {{{duration_values_csv}}};
 #define {sym}_FORMAT_CPP static_cast<ge::PixelFormat>({format_raw})
         """
 
+    if premultiplied:
+        header_additional += f"""
+// colors premultiplied by alpha, see hal::gpu::blit_blend_premultiplied()
+#define {sym}_PREMULTIPLIED 1
+        """
+
     # Emit C/H via shared helper
     bin2c.main(
         data,
@@ -211,7 +386,10 @@ static const unsigned short {sym}_FRAME_DURATIONS[] = {{{duration_values_csv}}};
         out_h,
         sym,
         header_additional=header_additional,
-        dtype="uint16_t" if data.dtype == np.uint16 else "uint32_t",
+        dtype={np.uint8: "uint8_t", np.uint16: "uint16_t"}.get(
+            data.dtype.type, "uint32_t"
+        ),
+        source_additional=source_additional,
     )
 
 
@@ -230,6 +408,12 @@ Examples:
 
   # Animated image (APNG, WEBP, GIF)
   bin2c_image.py animation.png output.c output.h symbol argb1555 --animated
+
+  # Colors premultiplied by alpha, for hal::gpu::blit_blend_premultiplied()
+  bin2c_image.py sprite.png output.c output.h symbol argb8888 --premultiplied
+
+  # Palettized, L4 if the image has at most 16 colors, quantized L8 otherwise
+  bin2c_image.py background.png output.c output.h symbol indexed
         """,
     )
 
@@ -241,7 +425,7 @@ Examples:
         "mode",
         nargs="?",
         default="rgb565",
-        choices=["rgb565", "argb1555", "argb8888"],
+        choices=["rgb565", "argb1555", "argb8888", *INDEXED_MODES],
         help="Color mode (default: rgb565)",
     )
     parser.add_argument(
@@ -255,6 +439,11 @@ Examples:
         action="store_true",
         help="Process as animated image (APNG/WEBP/GIF)",
     )
+    parser.add_argument(
+        "--premultiplied",
+        action="store_true",
+        help="Premultiply colors by alpha (argb8888 only)",
+    )
     parser.add_argument(
         "extra_args", nargs="*", help="Additional arguments (for compatibility)"
     )
@@ -274,4 +463,13 @@ Examples:
     rotation_angle = args.rotate or 0
     animated = args.animated
 
-    main(inp_img, out_c, out_h, sym, mode, rotation_angle, animated)
+    main(
+        inp_img,
+        out_c,
+        out_h,
+        sym,
+        mode,
+        rotation_angle,
+        animated,
+        args.premultiplied,
+    )
@@ -1,8 +1,13 @@
 #pragma once
 
+#include "ge-hal/damage.hpp"
+#include "ge-hal/gpu.hpp"
 #include "ge-hal/surface.hpp"
+#include "ge-hal/typed_surface.hpp"
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
+#include <type_traits>
 
 namespace ge {
 
@@ -19,12 +24,22 @@ struct GlyphContext {
 // This API can also support variable-width fonts in the future to save space.
 class Font {
 public:
+  // glyph_spans are the lit pixels of each glyph as horizontal spans, from
+  // bin2c_bitmap_font.py: every row is a count n followed by n (x, length)
+  // pairs, the rows of glyph i start at glyph_span_offsets[i].
+  // glyph_coverage, if any, are the same glyphs in grayscale (--coverage of
+  // bin2c_bitmap_font.py): a cell of coverage_bpp (8 or 4) bits per pixel for
+  // each glyph, every row starting on a byte.
   Font(const u8 *glyph_data, u8 glyph_width, u8 glyph_height, char first_char,
-       char last_char, u8 glyph_byte_per_row, const u8 *glyph_advances)
+       char last_char, u8 glyph_byte_per_row, const u8 *glyph_advances,
+       const u8 *glyph_spans, const u16 *glyph_span_offsets,
+       const u8 *glyph_coverage = nullptr, u8 coverage_bpp = 0)
       : glyph_data(glyph_data), glyph_width(glyph_width),
         glyph_height(glyph_height), first_char(first_char),
         last_char(last_char), glyph_bytes_per_row(glyph_byte_per_row),
-        glyph_advances(glyph_advances) {}
+        coverage_bpp(coverage_bpp), glyph_advances(glyph_advances),
+        glyph_spans(glyph_spans), glyph_span_offsets(glyph_span_offsets),
+        glyph_coverage(glyph_coverage) {}
 
   static const Font &regular_font();
   static const Font &bold_font();
@@ -36,11 +51,152 @@ public:
   u32 line_height() const;
   u32 default_advance() const;
 
+  // cb returns the RGB565 color of each glyph pixel
   template <class ColorCallback>
   void render(const char *text, u32 max_len, Surface region, int x0, int y0,
               ColorCallback cb) const {
+    // one dispatch on the region format, the glyph loops are compiled per
+    // format
+    bool drawn = visit(region, [&](auto fb) {
+      render_typed(text, max_len, fb, x0, y0, cb);
+    });
+    if (!drawn)
+      std::printf("Unsupported pixel format for text\r\n");
+  }
+
+  // Same as render() with a callback returning color, without the call.
+  // With coverage glyphs these are blended by hal::gpu instead.
+  void render_colored(const char *text, u32 max_len, Surface region, int x,
+                      int y, std::uint16_t color) const {
+    if (glyph_coverage)
+      render(text, max_len, region, x, y, coverage_color(color));
+    else
+      render(text, max_len, region, x, y, SolidColor{color});
+  }
+
+  u32 text_width(const char *text, u32 max_len) const {
+    u32 width = 0;
+    for (auto ch = *text; ch && max_len; ch = *++text, --max_len) {
+      u8 const *glyph_data;
+      u8 glyph_w, glyph_h, advance;
+      bool has_glyph = get_glyph(ch, glyph_data, glyph_w, glyph_h, advance);
+      if (!has_glyph)
+        advance = default_advance();
+      width += advance;
+    }
+    return width;
+  }
+
+private:
+  friend class TextLayout;
+
+  struct SolidColor {
+    u16 color;
+  };
+
+  // A color for the coverage glyphs, as RGB565 and as the RGB888 of the blend
+  struct CoverageColor {
+    u16 color;
+    u32 rgb888;
+  };
+
+  static CoverageColor coverage_color(u16 color) {
+    return {color,
+            pixel::convert<PixelFormat::ARGB8888, PixelFormat::RGB565>(color) &
+                0x00FFFFFF};
+  }
+
+  // Whether glyphs drawn with cb are plotted by the CPU, which then has to
+  // wait for hal::gpu
+  template <class ColorCallback> static constexpr bool drawn_by_cpu() {
+    return !std::is_same<ColorCallback, CoverageColor>::value;
+  }
+
+  // Writes the glyph pixels [gx0, gx1) of a row, the glyph being at ctx.x
+  template <PixelFormat format, class ColorCallback> struct SpanWriter {
+    static void write(pixel::type_t<format> *row, int gx0, int gx1,
+                      const ColorCallback &cb, GlyphContext ctx) {
+      for (ctx.gx = gx0; ctx.gx < gx1; ++ctx.gx)
+        row[ctx.x + ctx.gx] =
+            pixel::convert<format, PixelFormat::RGB565>(cb(ctx));
+    }
+  };
+
+  template <PixelFormat format> struct SpanWriter<format, SolidColor> {
+    static void write(pixel::type_t<format> *row, int gx0, int gx1,
+                      const SolidColor &solid, const GlyphContext &ctx) {
+      pixel::fill_span<format>(
+          row + ctx.x + gx0, gx1 - gx0,
+          pixel::convert<format, PixelFormat::RGB565>(solid.color));
+    }
+  };
+
+  // Draws the glyph of ch with its top-left corner at (x, y), clipped to fb
+  // and to the rows it has in memory (see BaseSurface::band())
+  template <PixelFormat format, class ColorCallback>
+  void draw_glyph(TypedSurface<format> fb, char ch, int x, int y,
+                  const ColorCallback &cb) const {
+    // clip the glyph once, its spans are then written unchecked
+    const int gx0 = std::max(0, -x);
+    const int gx1 = std::min<int>(glyph_width, int(fb.get_width()) - x);
+    const int gy0 = std::max<int>(0, int(fb.get_row_begin()) - y);
+    const int gy1 = std::min<int>(glyph_height, int(fb.get_row_end()) - y);
+    const u8 *span = glyph_spans + glyph_span_offsets[ch - first_char];
+    GlyphContext ctx{ch, 0, 0, glyph_width, glyph_height, x, y};
+    for (ctx.gy = 0; ctx.gy < gy1; ++ctx.gy) {
+      u32 n = *span++;
+      if (ctx.gy < gy0) {
+        span += 2 * n;
+        continue;
+      }
+      auto *row = fb.row(y + ctx.gy).begin();
+      for (; n > 0; --n, span += 2) {
+        const int a = std::max<int>(gx0, span[0]);
+        const int b = std::min<int>(gx1, span[0] + span[1]);
+        if (a < b)
+          SpanWriter<format, ColorCallback>::write(row, a, b, cb, ctx);
+      }
+    }
+  }
+
+  // The coverage glyph of ch blended by hal::gpu, clipped to fb
+  template <PixelFormat format>
+  void draw_glyph(TypedSurface<format> fb, char ch, int x, int y,
+                  const CoverageColor &c) const {
+    const int gx0 = std::max(0, -x);
+    const int gx1 = std::min<int>(glyph_width, int(fb.get_width()) - x);
+    const int gy0 = std::max(0, -y);
+    const int gy1 = std::min<int>(glyph_height, int(fb.get_height()) - y);
+    if (gx0 >= gx1 || gy0 >= gy1)
+      return;
+    // A4 rows can't start inside a byte, such rare clips are plotted instead
+    if (coverage_bpp == 4 && (gx0 & 1)) {
+      hal::gpu::wait_idle();
+      draw_glyph(fb, ch, x, y, SolidColor{c.color});
+      return;
+    }
+    // in pixels, A4 rows are padded to whole bytes
+    const u32 stride = coverage_bpp == 4 ? (glyph_width + 1u) & ~1u
+                                         : u32(glyph_width);
+    const u32 cell = stride * glyph_height * coverage_bpp / 8;
+    ConstSurface glyph{glyph_coverage + (ch - first_char) * cell, stride,
+                       glyph_width, glyph_height,
+                       coverage_bpp == 4 ? PixelFormat::A4 : PixelFormat::A8};
+    const u32 w = gx1 - gx0, h = gy1 - gy0;
+    hal::gpu::blit_blend_alpha(fb.untyped().subsurface(x + gx0, y + gy0, w, h),
+                               glyph.subsurface(gx0, gy0, w, h), c.rgb888,
+                               0xFF);
+  }
+
+  template <PixelFormat format, class ColorCallback>
+  void render_typed(const char *text, u32 max_len, TypedSurface<format> fb,
+                    int x0, int y0, ColorCallback cb) const {
     int x = x0, y = y0;
-    const int max_x = region.get_width(), max_y = region.get_height();
+    const int max_x = fb.get_width(), max_y = fb.get_height();
+    if (drawn_by_cpu<ColorCallback>())
+      hal::gpu::wait_idle();
+    // bounding box of the glyphs drawn, for hal::damage
+    int min_x = max_x, min_y = max_y, end_x = 0, end_y = 0;
 
     auto measure_word = [&](const char *p) {
       int w = 0;
@@ -94,45 +250,31 @@ public:
       }
 
       if (has_glyph) {
-        for (int gy = 0; gy < glyph_h; ++gy) {
-          for (int gx = 0; gx < glyph_w; ++gx) {
-            int bit = gy * glyph_w + gx;
-            bool pixel_on = (glyph_data[bit >> 3] >> (7 - (bit & 7))) & 1;
-
-            if (pixel_on) {
-              auto color = cb(GlyphContext{ch, gx, gy, glyph_w, glyph_h, x, y});
-              region.set_pixel(x + gx, y + gy, color);
-            }
-          }
-        }
+        min_x = std::min(min_x, x);
+        min_y = std::min(min_y, y);
+        end_x = std::max(end_x, x + glyph_w);
+        end_y = std::max(end_y, y + glyph_h);
+        draw_glyph(fb, ch, x, y, cb);
       }
 
       x += advance;
     }
-  }
 
-  void render_colored(const char *text, u32 max_len, Surface region, int x,
-                      int y, std::uint16_t color) const {
-    render(text, max_len, region, x, y,
-           [color](const GlyphContext &) { return color; });
+    min_x = std::max(min_x, 0);
+    min_y = std::max(min_y, 0);
+    end_x = std::min(end_x, max_x);
+    end_y = std::min(end_y, max_y);
+    if (min_x < end_x && min_y < end_y)
+      hal::damage::mark(
+          fb.untyped().subsurface(min_x, min_y, end_x - min_x, end_y - min_y));
   }
 
-  u32 text_width(const char *text, u32 max_len) const {
-    u32 width = 0;
-    for (auto ch = *text; ch && max_len; ch = *++text, --max_len) {
-      u8 const *glyph_data;
-      u8 glyph_w, glyph_h, advance;
-      bool has_glyph = get_glyph(ch, glyph_data, glyph_w, glyph_h, advance);
-      if (!has_glyph)
-        advance = default_advance();
-      width += advance;
-    }
-    return width;
-  }
-
-private:
-  const u8 *glyph_data, *glyph_advances;
-  u8 glyph_width, glyph_height, glyph_bytes_per_row;
+  const u8 *glyph_data;
+  u8 glyph_width, glyph_height;
   char first_char, last_char;
+  u8 glyph_bytes_per_row, coverage_bpp;
+  const u8 *glyph_advances, *glyph_spans;
+  const u16 *glyph_span_offsets;
+  const u8 *glyph_coverage;
 };
 } // namespace ge
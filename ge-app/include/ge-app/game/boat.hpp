@@ -1,10 +1,11 @@
 #pragma once
 
-#include "assets/out/textures/default-boat.h"
+#include "assets/out/textures/sprites.h"
 #include "ge-app/aabb.hpp"
 #include "ge-app/game/player_stats.hpp"
-#include "ge-app/texture.hpp"
+#include "ge-app/sprite.hpp"
 #include "ge-hal/app.hpp"
+#include "ge-hal/timestep.hpp"
 #include <cmath>
 
 namespace ge {
@@ -15,6 +16,10 @@ template <class T = i32, class Rem = u32, Rem RemMax = 4096> struct Pos {
 
   constexpr Pos(i32 base) : base(base), rem(0) {}
 
+  float value() const {
+    return static_cast<float>(base) + static_cast<float>(rem) / RemMax;
+  }
+
   void update(float delta) {
     i64 to_add = delta * RemMax;
     i64 new_rem = static_cast<i64>(rem) + to_add;
@@ -34,32 +39,9 @@ public:
   u32 get_width() const { return boat.get_width(); }
   u32 get_height() const { return boat.get_height(); }
   void render(Surface region, const PlayerStats &stats) {
-    auto angle_to_8dir = [](float angle) {
-      // normalize to [0, 2π)
-      angle = std::fmod(angle, 2.0f * M_PI);
-      if (angle < 0)
-        angle += 2.0f * M_PI;
-
-      // add half-sector to round correctly
-      angle += M_PI / 8.0f;
-
-      // map to 0..7
-      int dir = int(angle / (M_PI / 4.0f)) & 7;
-      return dir;
-    };
-
-    // TODO: implement rotation (probably via sprite sheet for performance)
-    // float angle = -angle_to_8dir(get_relative_angle()) * M_PI_4;
-    // boat.blit_rotated(region, region.get_width() / 2, region.get_height() /
-    // 2,
-    //                   angle);
-    //
-    // region is a 64x64 region, but the boat texture is 32x64 only
-    auto boat_region =
-        region.subsurface((region.get_width() - boat.get_width()) / 2,
-                          (region.get_height() - boat.get_height()) / 2,
-                          boat.get_width(), boat.get_height());
-    boat.blit_blend(boat_region, 0xFF);
+    // region is a 64x64 region, the boat turns around its center
+    turning_boat.blit(region, region.get_width() / 2, region.get_height() / 2,
+                      -get_relative_angle());
 
     // render three mini 32 (region.get_width())x1 lines for HP, Food, Stamina
     auto hp_region = region.subsurface(
@@ -139,6 +121,9 @@ public:
       current_speed = std::max(current_speed, effective_base_speed);
     }
 
+    prev_x = x.value();
+    prev_y = y.value();
+    moved_at = hal::timestep::tick_count();
     const auto angle_val = get_angle();
     x.update(current_speed * std::cos(angle_val) * delta_time);
     y.update(current_speed * std::sin(angle_val) * delta_time);
@@ -146,14 +131,22 @@ public:
 
   i32 get_x() const { return x.base; }
   i32 get_y() const { return y.base; }
+
+  // Where to draw the boat, between the last two ticks
+  i32 get_render_x() const {
+    return static_cast<i32>(
+        std::floor(hal::timestep::interpolate(prev_x, x.value(), moved_at)));
+  }
+  i32 get_render_y() const {
+    return static_cast<i32>(
+        std::floor(hal::timestep::interpolate(prev_y, y.value(), moved_at)));
+  }
   float get_current_speed() const { return current_speed; }
 
 private:
-  Texture<default_boat_FORMAT_CPP> boat{
-      default_boat,
-      default_boat_WIDTH,
-      default_boat_HEIGHT,
-  };
+  // the boat as drawn gives the size, what is drawn is the nearest direction
+  SpriteRef boat = atlas::sprites::default_boat;
+  RotatedSprite turning_boat = atlas::sprites::boat;
 
   static constexpr float default_angle = M_PI_2;
   static constexpr float turn_rate = 1.5f;
@@ -168,5 +161,8 @@ private:
   float current_speed = boat_speed; // Current actual speed
 
   Pos<> x = 0, y = 0;
+  // position before the last move, and the tick of that move
+  float prev_x = 0.0f, prev_y = 0.0f;
+  u64 moved_at = 0;
 };
 } // namespace ge
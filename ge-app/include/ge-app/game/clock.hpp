@@ -53,9 +53,9 @@ public:
 
   const Timer &get_game_timer() const { return day_timer; }
 
-  void reset(App &app) {
-    // start at 6AM
-    day_timer.reset(app, DAY_LENGTH / 4);
+  // start at 6AM unless told otherwise (in ms since the first midnight)
+  void reset(App &app, i64 time = DAY_LENGTH / 4) {
+    day_timer.reset(app, time);
     sped_up = false;
   }
 
@@ -1,9 +1,8 @@
 #pragma once
 
-#include "ge-app/texture.hpp"
+#include "ge-app/sprite.hpp"
 
-#include "assets/out/textures/compass-base.h"
-#include "assets/out/textures/compass-needle.h"
+#include "assets/out/textures/sprites.h"
 
 namespace ge {
 class Compass {
@@ -12,16 +11,14 @@ public:
   u32 get_height() const { return base.get_height(); }
   void render(Surface &region, float angle) {
     static const float needle_angle_offset = 0;
-    base.blit(region);
-    // NOTE: these pixel offsets are chosen manually based on the texture design
-    needle.blit_rotated(region, 24, 28, needle_angle_offset - angle, 23.5,
-                        28.5);
+    base.blit(region, 0, 0);
+    // NOTE: these pixel offsets are chosen manually based on the texture
+    // design, the needle turns around its pivot (see assets/CMakeLists.txt)
+    needle.blit(region, 24, 28, needle_angle_offset - angle);
   }
 
 private:
-  Texture<compass_base_FORMAT_CPP> base{compass_base, compass_base_WIDTH,
-                                        compass_base_HEIGHT};
-  Texture<compass_needle_FORMAT_CPP> needle{
-      compass_needle, compass_needle_WIDTH, compass_needle_HEIGHT};
+  SpriteRef base = atlas::sprites::compass_base;
+  RotatedSprite needle = atlas::sprites::compass_needle;
 };
 } // namespace ge
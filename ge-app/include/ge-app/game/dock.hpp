@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ge-app/game/perspective.hpp"
 #include "ge-app/game/sky.hpp"
 #include "ge-hal/app.hpp"
 #include "ge-hal/gpu.hpp"
@@ -7,10 +8,15 @@
 namespace ge {
 class Dock {
 public:
+  // With a perspective, surface is the region it projects
   void render(App &app, Surface &surface, Clock &clock, i32 boat_x,
-              i32 boat_y) {
+              i32 boat_y, const PerspectiveMapping *perspective = nullptr) {
     // Dock rectangle: (-infty, -infty) -> (infty, -40)
     i32 dock_top = surface.get_height() - 40 + boat_y;
+    if (perspective) {
+      i32 x = 0;
+      perspective->project(x, dock_top);
+    }
     if (dock_top >= surface.get_height())
       return;
 
@@ -4,6 +4,9 @@
 #include "ge-app/rng.hpp"
 #include "ge-app/scenes/dialog.hpp"
 #include "ge-hal/app.hpp"
+#include "ge-hal/damage.hpp"
+#include "ge-hal/gpu.hpp"
+#include "ge-hal/typed_surface.hpp"
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
@@ -307,7 +310,7 @@ private:
     }
 
     // Weighted random selection
-    int random_weight = rand() % total_weight;
+    int random_weight = static_cast<int>(rng::next() % total_weight);
     int current_weight = 0;
     int caught_index = 0;
 
@@ -357,15 +360,21 @@ private:
     i32 sy = y0 < y1 ? 1 : -1;
     i32 err = dx - dy;
 
+    TypedSurface<PixelFormat::RGB565> pixels{region};
+    const i32 w = region.get_width(), h = region.get_height();
+    const i32 row_begin = region.get_row_begin(),
+              row_end = region.get_row_end();
+
+    hal::gpu::wait_idle();
+    mark_damage(region, std::min(x0, x1), std::min(y0, y1), dx + 1, dy + 1);
     while (true) {
       // Draw pixel (convert from center coordinates to screen coordinates)
-      i32 screen_x = x0 + region.get_width() / 2;
-      i32 screen_y = y0 + region.get_height() / 2;
+      i32 screen_x = x0 + w / 2;
+      i32 screen_y = y0 + h / 2;
 
-      if (screen_x >= 0 && screen_x < static_cast<i32>(region.get_width()) &&
-          screen_y >= 0 && screen_y < static_cast<i32>(region.get_height())) {
-        region.set_pixel<u16>(screen_x, screen_y, color);
-      }
+      if (screen_x >= 0 && screen_x < w && screen_y >= row_begin &&
+          screen_y < row_end)
+        pixels.at(screen_x, screen_y) = color;
 
       if (x0 == x1 && y0 == y1)
         break;
@@ -382,6 +391,17 @@ private:
     }
   }
 
+  // Marks a rect given in center coordinates, clipped to region
+  static void mark_damage(Surface &region, i32 x, i32 y, i32 w, i32 h) {
+    i32 x0 = std::max<i32>(x + region.get_width() / 2, 0);
+    i32 y0 = std::max<i32>(y + region.get_height() / 2, 0);
+    i32 x1 = std::min<i32>(x + w + region.get_width() / 2, region.get_width());
+    i32 y1 =
+        std::min<i32>(y + h + region.get_height() / 2, region.get_height());
+    if (x0 < x1 && y0 < y1)
+      hal::damage::mark(region.subsurface(x0, y0, x1 - x0, y1 - y0));
+  }
+
   void draw_bobber(Surface &region, i32 x, i32 y) {
     // Draw a 3x3 bobber (red color)
     const u16 BOBBER_COLOR = 0xF800; // Red in RGB565
@@ -390,16 +410,20 @@ private:
     i32 screen_x = x + region.get_width() / 2;
     i32 screen_y = y + region.get_height() / 2;
 
-    // Draw 3x3 square
-    for (i32 dy = -1; dy <= 1; dy++) {
-      for (i32 dx = -1; dx <= 1; dx++) {
-        i32 px = screen_x + dx;
-        i32 py = screen_y + dy;
-        if (px >= 0 && px < static_cast<i32>(region.get_width()) && py >= 0 &&
-            py < static_cast<i32>(region.get_height())) {
-          region.set_pixel<u16>(px, py, BOBBER_COLOR);
-        }
-      }
+    // Draw 3x3 square, clipped to the rows of region in memory
+    i32 x0 = std::max<i32>(screen_x - 1, 0);
+    i32 y0 = std::max<i32>(screen_y - 1, region.get_row_begin());
+    i32 x1 = std::min<i32>(screen_x + 2, region.get_width());
+    i32 y1 = std::min<i32>(screen_y + 2, region.get_row_end());
+    if (x0 >= x1 || y0 >= y1)
+      return;
+
+    hal::gpu::wait_idle();
+    mark_damage(region, x - 1, y - 1, 3, 3);
+    TypedSurface<PixelFormat::RGB565> pixels{region};
+    for (i32 py = y0; py < y1; ++py) {
+      auto row = pixels.row(py);
+      pixel::fill_span<PixelFormat::RGB565>(&row[x0], x1 - x0, BOBBER_COLOR);
     }
   }
 
@@ -39,6 +39,7 @@ public:
 
     items[item_count] = FishItem(name, rarity, caught_time, weight);
     item_count++;
+    version++;
     return true;
   }
 
@@ -55,7 +56,10 @@ public:
   }
 
   // Clear all items from inventory
-  void clear() { item_count = 0; }
+  void clear() {
+    item_count = 0;
+    version++;
+  }
 
   // Check if inventory is full
   bool is_full() const { return item_count >= MAX_ITEMS; }
@@ -90,12 +94,17 @@ public:
       items[i] = items[i + 1];
     }
     item_count--;
+    version++;
     return true;
   }
 
+  // Changes whenever the items do, for the screens that show them
+  u32 get_version() const { return version; }
+
 private:
   FishItem items[MAX_ITEMS];
   u32 item_count;
+  u32 version = 0;
 };
 
 } // namespace ge
@@ -1,25 +1,90 @@
 #pragma once
 
+#include <cassert>
 #include <cmath>
 #include <ge-hal/app.hpp>
 
 namespace ge {
+
+// Built with -DGE_PERSPECTIVE_WATER=ON, the world draws the sea in
+// perspective instead of as a flat top-down view
+#ifdef GE_PERSPECTIVE_WATER
+constexpr bool PERSPECTIVE_WATER = true;
+#else
+constexpr bool PERSPECTIVE_WATER = false;
+#endif
+
+// Mode-7 style projection of the sea onto the water region, with the boat at
+// its center. The sea is flat (one world pixel per screen pixel) up to a
+// quarter of the region ahead of the boat, and recedes towards the top of
+// the region past that. Everything behind the boat is drawn as in the flat
+// view.
 class PerspectiveMapping {
 public:
-  // x, y are relative to boat position
-  void transform_xy(float x, float y, float &out_x, float &out_y) {
+  // What a row of the region shows, for an integer-only scanline loop: world
+  // x (relative to the boat) at pixel sx is u_origin + sx * u_step, in 16.16
+  // fixed point
+  struct Row {
+    i32 depth; // world y ahead of the boat
+    i32 u_step;
+    i32 u_origin;
+  };
+
+  PerspectiveMapping(u32 width, u32 height)
+      : region_width(width), region_height(height) {
+    assert(height <= MAX_HEIGHT);
+    // the far edge has to stay below the horizon
+    assert(K * height / 2 < 1.0f);
+    for (u32 y = 0; y < height; ++y) {
+      float s = float(height / 2) - float(y);
+      float depth = depth_at(s);
+      float scale = scale_at(depth);
+      i32 u_step = static_cast<i32>(std::lround(65536.0f / scale));
+      rows[y] = {static_cast<i32>(std::floor(depth)), u_step,
+                 -static_cast<i32>(width / 2) * u_step};
+    }
+  }
+
+  u32 get_width() const { return region_width; }
+  u32 get_height() const { return region_height; }
+  const Row &row(u32 y) const { return rows[y]; }
+
+  // x, y are relative to boat position, y pointing ahead
+  void transform_xy(float x, float y, float &out_x, float &out_y) const {
     float scale = scale_at(y);
-    out_x = region_width / 2 + x * pixel_per_length_unit;
-    out_y = region_height / 2 - y * pixel_per_length_unit * scale;
+    out_x = region_width / 2 + x * scale;
+    out_y = region_height / 2 - y * scale;
   }
 
-  float scale_at(float y) {
-    return 1.0 / (1 + K * std::fmax(0, y * pixel_per_length_unit -
-                                           region_height / 4));
+  // Screen pixels per world pixel, y ahead of the boat
+  float scale_at(float y) const {
+    return 1.0f / (1 + K * std::fmax(0, y - region_height / 4));
+  }
+
+  // Moves a point from where the flat view draws it in the region to where
+  // it is in perspective
+  void project(i32 &x, i32 &y) const {
+    float out_x, out_y;
+    transform_xy(float(x - i32(region_width / 2)),
+                 float(i32(region_height / 2) - y), out_x, out_y);
+    x = static_cast<i32>(std::floor(out_x));
+    y = static_cast<i32>(std::floor(out_y));
   }
 
 private:
-  float K = 0.008, pixel_per_length_unit = 32.0f;
-  float region_width = ge::App::WIDTH, region_height = ge::App::WIDTH;
+  static constexpr u32 MAX_HEIGHT = App::HEIGHT;
+  static constexpr float K = 0.008f;
+
+  // The inverse of transform_xy() along y: the world y drawn s pixels above
+  // the boat
+  float depth_at(float s) const {
+    const float q = region_height / 4;
+    if (s <= q)
+      return s;
+    return s * (1 - K * q) / (1 - K * s);
+  }
+
+  u32 region_width, region_height;
+  Row rows[MAX_HEIGHT];
 };
 } // namespace ge
@@ -3,6 +3,7 @@
 #include "assets/out/textures/clouds.h"
 #include "ge-app/game/clock.hpp"
 #include "ge-app/gfx/color.hpp"
+#include "ge-app/sprite.hpp"
 #include "ge-app/texture.hpp"
 #include "ge-hal/app.hpp"
 #include "ge-hal/surface.hpp"
@@ -22,14 +23,37 @@ public:
   void render(App &app, Surface render_region, Clock &clock);
 
 private:
-  TextureARGB8888 sun_texture, moon_texture;
-  u16 cloud_lut[sizeof(CLOUD_COLORS) / sizeof(CLOUD_COLORS[0])];
+  // The cloud texture decoded once, each pixel being the cloud opacity
+  // (CLOUD_COLORS). The first columns are repeated after the texture, so
+  // that any screen-wide window of it is a single rectangle.
+  static constexpr u32 STRIP_WIDTH = CLOUD_TEXTURE_WIDTH + App::WIDTH;
+  static_assert(STRIP_WIDTH <= 2 * CLOUD_TEXTURE_WIDTH,
+                "the strip repeats the texture at most once");
+  // not on the stack, blits from it may run after render() returns
+  static u8 strip_memory[STRIP_WIDTH * CLOUD_TEXTURE_HEIGHT];
+  static bool strip_decoded;
+  static void decode_strip();
+
+  // The strip as L8: entry v is the cloud color at opacity v over the sky.
+  // A loaded palette must stay unchanged, so new colors go to the other one.
+  // Shared by all Sky instances, so that a palette is never recolored behind
+  // the back of the GPU.
+  static constexpr u32 PALETTE_SIZE = 256;
+  static u32 palettes[2][PALETTE_SIZE];
+  static u32 palette_index;
+  static u16 palette_sky, palette_cloud;
+  static bool palette_valid;
+  static void recolor(u16 sky_color, u16 cloud_color);
 
   struct Rect {
     i32 x, y, w, h;
   };
 
-  Rect render_celestial_object(const TextureARGB8888 &texture,
-                               Surface render_region, float t, u16 sky_color);
+  // Returns the rectangle drawn into, only the opaque part of the sprite
+  Rect render_celestial_object(const SpriteRef &sprite, Surface render_region,
+                               float t, u16 sky_color);
+  // Blends the clouds back over what r covers in the cloud band
+  void occlude(Surface render_region, u32 x_offset, const Rect &r,
+               u16 cloud_color);
 };
 } // namespace ge
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ge-app/game/perspective.hpp"
 #include "ge-app/game/sky.hpp"
 #include "ge-app/gfx/color.hpp"
 #include "ge-app/texture.hpp"
@@ -30,76 +31,83 @@ public:
 
   void render(App *app, Surface region, float time, u32 x_offset,
               u32 y_offset) {
-    u32 frame_index = app ? (app->now() % (water_texture_FRAME_COUNT *
-                                           water_texture_FRAME_DURATIONS[0])) /
-                                water_texture_FRAME_DURATIONS[0]
-                          : 0;
-
     const u32 pw = pattern_width();
     const u32 ph = pattern_height();
 
-    x_offset = (pw - (x_offset % pw)) % pw;
     y_offset %= ph;
 
-    auto current_frame_water_pattern =
-        this->water_pattern.subsurface(pw * frame_index, 0, pw, ph);
-
     const u32 rw = region.get_width();
     const u32 rh = region.get_height();
 
     assert(rw == App::WIDTH);
 
-    u16 blend_result[water_texture_FRAME_WIDTH * water_texture_FRAME_HEIGHT];
-    Surface blend_surface{blend_result, pw, pw, ph, PixelFormat::RGB565};
-
-    // First, fill the blend surface with the water color
-    hal::gpu::fill(blend_surface, 0x0000);
-
-    // Then, blend with the water pattern
-    u32 sky_luminance = std::isnan(time) ? 0xFF : Sky::luminance_at_time(time);
-    sky_luminance = sky_luminance * 3 / 2 + 48;
-    if (sky_luminance > 255)
-      sky_luminance = 255;
-    // scale to 0-255 range for blending (approximation)
-    hal::gpu::blit_blend(blend_surface, current_frame_water_pattern,
-                         sky_luminance);
-
-    auto water_pattern = blend_surface.as_const();
-
-    Surface row_region{row_memory, rw, rw, ph,
-                       PixelFormat::RGB565}; // temporary row buffer
-    // 1. Render a full row (rw x ph) to the temporary region at (0, y_offset)
-    // First, render the part from (x_offset, y_offset)
-    for (u32 x = x_offset; x < rw; x += pw) {
-      hal::gpu::blit(row_region.subsurface(x, 0, rw - x, ph), water_pattern);
-    }
-    // Secondly, render the remaining part from (0, y_offset) to (x_offset,
-    // y_offset + ph)
-    if (x_offset > 0) {
-      hal::gpu::blit(row_region.subsurface(0, 0, x_offset, ph),
-                     water_pattern.subsurface(pw - x_offset, 0, x_offset, ph));
-    }
-    // After this, we have a complete row rendered in row_region
+    // A full row (rw x ph), starting x_offset into the pattern
+    auto row_region = strip_for(frame_index_at(app), luminance_at(time))
+                          .subsurface(x_offset % pw, 0, rw, ph);
 
-    // 2. Repeat the row to fill the entire region
+    // 1. Repeat the row to fill the region from (0, y_offset)
     for (u32 y = y_offset; y < rh; y += ph) {
       hal::gpu::blit(region.subsurface(0, y, rw, std::min(ph, rh - y)),
-                     row_region.as_const());
+                     row_region);
     }
 
-    // 3. Fill in the upper region from (0, 0) to (rw, y_offset) too
+    // 2. Fill in the upper region from (0, 0) to (rw, y_offset) too
     if (y_offset < ph) {
-      hal::gpu::blit(
-          region.subsurface(0, 0, rw, y_offset),
-          row_region.subsurface(0, ph - y_offset, rw, y_offset).as_const());
+      hal::gpu::blit(region.subsurface(0, 0, rw, y_offset),
+                     row_region.subsurface(0, ph - y_offset, rw, y_offset));
     }
   }
 
+  // The same sea in perspective, drawn by the CPU one scanline at a time.
+  // The flat part of the mapping looks exactly like render().
+  void render_perspective(App *app, Surface region, float time,
+                          const PerspectiveMapping &perspective, u32 x_offset,
+                          u32 y_offset);
+
   u32 pattern_width() const { return water_texture_FRAME_WIDTH; }
   u32 pattern_height() const { return water_pattern.get_height(); }
 
 private:
-  static u16 row_memory[App::WIDTH * water_texture_HEIGHT];
+  // The shaded pattern repeated over a row, one tile wider than the screen
+  // so that a row at any x offset is a subsurface of it
+  static constexpr u32 STRIP_WIDTH = App::WIDTH + water_texture_FRAME_WIDTH;
+  // The animation frames at the current light, and the map
+  static constexpr u32 STRIP_CACHE_SIZE = 4;
+
+  static u32 frame_index_at(App *app) {
+    return app ? (app->now() % (water_texture_FRAME_COUNT *
+                                water_texture_FRAME_DURATIONS[0])) /
+                     water_texture_FRAME_DURATIONS[0]
+               : 0;
+  }
+
+  // The opacity of the pattern over black at a time of day, full for NAN.
+  // Rounded to the nearest of 16 levels (0, 17, ..., 255), so that the strip
+  // cache still hits while the light changes at dawn and dusk.
+  static u32 luminance_at(float time) {
+    u32 sky_luminance =
+        std::isnan(time) ? 0xFF : Sky::luminance_at_time(time);
+    sky_luminance = std::min<u32>(sky_luminance * 3 / 2 + 48, 255);
+    return (sky_luminance + 8) / 17 * 17;
+  }
+
+  struct Strip {
+    u32 frame_index = 0, luminance = 0;
+    u32 last_used = 0;
+    bool valid = false;
+  };
+
+  // The strip for an animation frame blended at the given luminance, built
+  // when it is not cached yet. The cache is shared by all Water instances,
+  // they use the same texture.
+  ConstSurface strip_for(u32 frame_index, u32 luminance);
+
+  static Strip strips[STRIP_CACHE_SIZE];
+  // not on the stack, blits from it may run after render() returns. The
+  // definition in water.cpp puts it in GE_LAYER_STORAGE.
+  static u16 strip_memory[STRIP_CACHE_SIZE]
+                         [STRIP_WIDTH * water_texture_HEIGHT];
+  static u32 strip_clock;
 
   u16 water_color =
       hsv_to_rgb565(142, 255, 181); // initial water color (greenish)
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "ge-hal/gpu.hpp"
+#include "ge-hal/surface.hpp"
+
+#ifdef GE_HAL_STM32
+#include "ge-hal/stm/sdram.hpp"
+// Layers are up to a screen in size, too large for the internal SRAM
+#define GE_LAYER_STORAGE GE_SDRAM
+#else
+#define GE_LAYER_STORAGE
+#endif
+
+namespace ge {
+
+// Retained-mode drawing for screens that only change when a few inputs do:
+// the screen is drawn into an offscreen surface when its key changes, and
+// otherwise composited into the framebuffer with one hal::gpu blit (a blend
+// for formats with alpha, so the layer can sit over a live background).
+//
+// The pixels are a static buffer of the screen, declared GE_LAYER_STORAGE so
+// that they are in SDRAM on the STM32.
+class CachedLayer {
+public:
+  // FNV-1a over the inputs the drawing depends on
+  class Key {
+  public:
+    Key &add(u64 value) {
+      for (u32 i = 0; i < 8; ++i)
+        mix(static_cast<u8>(value >> (i * 8)));
+      return *this;
+    }
+    Key &add(const char *text) {
+      for (; *text; ++text)
+        mix(static_cast<u8>(*text));
+      mix(0);
+      return *this;
+    }
+
+    u64 get() const { return hash; }
+
+  private:
+    void mix(u8 byte) { hash = (hash ^ byte) * 1099511628211ull; }
+
+    u64 hash = 14695981039346656037ull;
+  };
+
+  CachedLayer(void *pixels, u32 width, u32 height,
+              PixelFormat format = PixelFormat::RGB565)
+      : surface{pixels, width, width, height, format} {}
+
+  // Composites the layer into dst, after drawing it with draw(Surface &) if
+  // it does not hold what was drawn for key yet. Can be called for every
+  // strip band, only the first one draws.
+  template <class Draw> void render(Surface &dst, u64 key, Draw &&draw) {
+    if (!drawn || key != drawn_key) {
+      draw(surface);
+      drawn_key = key;
+      drawn = true;
+    }
+    if (has_alpha_channel(surface.get_pixel_format()))
+      hal::gpu::blit_blend(dst, surface.as_const(), 0xFF);
+    else
+      hal::gpu::blit(dst, surface.as_const());
+  }
+
+  // For Scene::needs_redraw(): whether the framebuffer lacks what render()
+  // would composite for key
+  bool needs_redraw(u64 key) const { return !on_screen || key != screen_key; }
+  // For Scene::on_rendered()
+  void on_rendered(u64 key) {
+    screen_key = key;
+    on_screen = true;
+  }
+  // For Scene::invalidate(): the framebuffer lost the layer, which is still
+  // good to composite again
+  void invalidate() { on_screen = false; }
+
+  u32 get_width() const { return surface.get_width(); }
+  u32 get_height() const { return surface.get_height(); }
+
+private:
+  Surface surface;
+  u64 drawn_key = 0, screen_key = 0;
+  bool drawn = false, on_screen = false;
+};
+
+} // namespace ge
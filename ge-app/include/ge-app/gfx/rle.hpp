@@ -0,0 +1,99 @@
+#pragma once
+
+#include "ge-hal/damage.hpp"
+#include "ge-hal/gpu.hpp"
+#include "ge-hal/surface.hpp"
+#include "ge-hal/typed_surface.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace ge {
+namespace gfx {
+
+// Sprite blits done by the CPU from run-length rows (atlas.py --rle). Every
+// row is a count n followed by n (skip, opaque, blended) triples of lengths:
+// transparent pixels are skipped without being read, opaque ones are copied
+// (a memcpy when the formats match) and only the blended ones, usually the
+// anti-aliased edges, are blended (with the premultiplied blend for
+// premultiplied sprites). The runs index into the sprite pixels, which stay
+// in the atlas pages. Drawing waits for hal::gpu to be idle, so the STM32
+// build has no runs and queues DMA2D blends instead.
+namespace rle {
+
+// Draws the part of a sprite at (src_x, src_y) of the size of dst. src is the
+// whole (trimmed) sprite and rows the offsets of its rows into runs.
+template <PixelFormat src_format, PixelFormat dst_format>
+void draw(TypedSurface<dst_format> dst, ConstTypedSurface<src_format> src,
+          const u32 *rows, const u8 *runs, u32 src_x, u32 src_y, u8 alpha,
+          bool premultiplied) {
+  const u32 x0 = src_x, x1 = src_x + dst.get_width();
+
+  // [a, b) of the source row, clipped, onto the destination row
+  auto clipped = [&](u32 a, u32 b, auto *out, auto *in, auto op) {
+    a = std::max(a, x0);
+    b = std::min(b, x1);
+    if (a < b)
+      op(out + (a - x0), in + a, b - a);
+  };
+  auto copy = [](auto *out, auto *in, u32 n) {
+    pixel::convert_span<dst_format, src_format>(out, in, n);
+  };
+  auto blend = [alpha, premultiplied](auto *out, auto *in, u32 n) {
+    if (premultiplied)
+      pixel::blend_premultiplied_span<dst_format, src_format>(out, in, n,
+                                                              alpha);
+    else
+      pixel::blend_span<dst_format, src_format>(out, in, n, alpha);
+  };
+
+  for (u32 y = dst.get_row_begin(); y < dst.get_row_end(); ++y) {
+    const u8 *run = runs + rows[src_y + y];
+    auto *out = dst.row(y).begin();
+    auto *in = src.row(src_y + y).begin();
+    u32 x = 0;
+    for (u32 n = *run++; n > 0 && x < x1; --n, run += 3) {
+      u32 opaque = x + run[0];
+      u32 blended = opaque + run[1];
+      x = blended + run[2];
+      // with a global alpha, opaque pixels are blended too
+      if (alpha == 0xFF)
+        clipped(opaque, blended, out, in, copy);
+      else
+        clipped(opaque, blended, out, in, blend);
+      clipped(blended, x, out, in, blend);
+    }
+  }
+}
+
+template <PixelFormat src_format>
+bool draw(const Surface &dst, ConstTypedSurface<src_format> src,
+          const u32 *rows, const u8 *runs, u32 src_x, u32 src_y, u8 alpha,
+          bool premultiplied) {
+  return visit(dst, [&](auto typed_dst) {
+    draw<src_format, decltype(typed_dst)::format>(
+        typed_dst, src, rows, runs, src_x, src_y, alpha, premultiplied);
+  });
+}
+
+// Same with the formats known at run time, one dispatch per call
+inline void draw(const Surface &dst, const ConstSurface &src, const u32 *rows,
+                 const u8 *runs, u32 src_x, u32 src_y, u8 alpha,
+                 bool premultiplied = false) {
+  if (dst.get_width() == 0 || dst.get_row_begin() == dst.get_row_end() ||
+      alpha == 0)
+    return;
+  hal::gpu::wait_idle();
+  hal::damage::mark(dst);
+
+  bool drawn = false;
+  visit(src, [&](auto typed_src) {
+    drawn =
+        draw(dst, typed_src, rows, runs, src_x, src_y, alpha, premultiplied);
+  });
+  if (!drawn)
+    std::printf("Unsupported pixel formats for RLE sprites\r\n");
+}
+
+} // namespace rle
+} // namespace gfx
+} // namespace ge
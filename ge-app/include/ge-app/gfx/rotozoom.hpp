@@ -0,0 +1,152 @@
+#pragma once
+
+#include "ge-hal/damage.hpp"
+#include "ge-hal/gpu.hpp"
+#include "ge-hal/surface.hpp"
+#include "ge-hal/typed_surface.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace ge {
+namespace gfx {
+
+// Rotated and scaled blits done by the CPU, nearest-neighbour. Each
+// destination row is walked with 16.16 fixed-point source coordinates,
+// stepped incrementally, over exactly the span that lands inside the source
+// rectangle. The per-pixel work is pixel::put() for the (source, destination)
+// format pair, picked at compile time, or the premultiplied blend for
+// premultiplied sources.
+namespace rotozoom {
+
+// --- Span clipping ---
+
+inline i64 floor_div(i64 a, i64 b) {
+  i64 q = a / b;
+  return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
+
+// Narrows [lo, hi] to the steps i where 0 <= (f + df * i) >> 16 < limit
+inline void clip_span(i64 f, i64 df, i64 limit, i64 &lo, i64 &hi) {
+  const i64 end = limit << 16;
+  if (df == 0) {
+    if (f < 0 || f >= end)
+      hi = lo - 1;
+    return;
+  }
+  if (df > 0) {
+    lo = std::max(lo, -floor_div(f, df));
+    hi = std::min(hi, -floor_div(f - end, df) - 1);
+  } else {
+    hi = std::min(hi, floor_div(f, -df));
+    lo = std::max(lo, floor_div(f - end, -df) + 1);
+  }
+}
+
+// --- Rasterizer ---
+
+// Draws src rotated clockwise by angle_rad and scaled by scale, with the
+// source point (src_cx, src_cy) (in pixel indices) on the destination pixel
+// (dst_cx, dst_cy)
+template <PixelFormat src_format, PixelFormat dst_format,
+          bool premultiplied = false>
+void draw(TypedSurface<dst_format> dst, ConstTypedSurface<src_format> src,
+          int dst_cx, int dst_cy, float angle_rad, float scale, float src_cx,
+          float src_cy) {
+  const i32 sw = src.get_width(), sh = src.get_height();
+  if (sw == 0 || sh == 0 || !(scale > 0.0f))
+    return;
+
+  // destination -> source: the inverse rotation, divided by the scale
+  const float c = std::cos(angle_rad) / scale;
+  const float s = std::sin(angle_rad) / scale;
+
+  // Bounding box of the source rectangle on the destination. A sample lands
+  // in pixel round(u), i.e. the source covers [-0.5, w - 0.5).
+  float min_x = 1e9f, max_x = -1e9f, min_y = 1e9f, max_y = -1e9f;
+  const float us[2] = {-0.5f - src_cx, sw - 0.5f - src_cx};
+  const float vs[2] = {-0.5f - src_cy, sh - 0.5f - src_cy};
+  const float k2 = 1.0f / (c * c + s * s); // scale squared
+  for (float u : us) {
+    for (float v : vs) {
+      // forward rotation, the transpose of the inverse one, times the scale
+      float x = (c * u - s * v) * k2;
+      float y = (s * u + c * v) * k2;
+      min_x = std::min(min_x, x);
+      max_x = std::max(max_x, x);
+      min_y = std::min(min_y, y);
+      max_y = std::max(max_y, y);
+    }
+  }
+
+  // only the rows of dst in memory, see BaseSurface::band()
+  const i32 W = dst.get_width();
+  const i32 row_begin = dst.get_row_begin(), row_end = dst.get_row_end();
+  const i32 x0 = std::max(0, dst_cx + (i32)std::floor(min_x) - 1);
+  const i32 x1 = std::min(W - 1, dst_cx + (i32)std::ceil(max_x) + 1);
+  const i32 y0 = std::max(row_begin, dst_cy + (i32)std::floor(min_y) - 1);
+  const i32 y1 = std::min(row_end - 1, dst_cy + (i32)std::ceil(max_y) + 1);
+  if (x0 > x1 || y0 > y1)
+    return;
+
+  hal::gpu::wait_idle();
+  hal::damage::mark(
+      dst.untyped().subsurface(x0, y0, x1 - x0 + 1, y1 - y0 + 1));
+
+  // 16.16 steps along a destination row and column. The +0.5 makes the
+  // truncation of the coordinates round to the nearest source pixel.
+  const i32 du_dx = (i32)std::lround(c * 65536.0f);
+  const i32 dv_dx = (i32)std::lround(-s * 65536.0f);
+  const i32 du_dy = (i32)std::lround(s * 65536.0f);
+  const i32 dv_dy = (i32)std::lround(c * 65536.0f);
+  i64 row_u = std::llround(
+      (c * (x0 - dst_cx) + s * (y0 - dst_cy) + src_cx + 0.5f) * 65536.0f);
+  i64 row_v = std::llround(
+      (-s * (x0 - dst_cx) + c * (y0 - dst_cy) + src_cy + 0.5f) * 65536.0f);
+
+  const auto *src_data = src.data();
+  const u32 src_stride = src.get_stride();
+
+  for (i32 y = y0; y <= y1; ++y, row_u += du_dy, row_v += dv_dy) {
+    i64 lo = 0, hi = x1 - x0;
+    clip_span(row_u, du_dx, sw, lo, hi);
+    clip_span(row_v, dv_dx, sh, lo, hi);
+    if (lo > hi)
+      continue;
+
+    // inside the span both coordinates are non-negative and in range
+    u32 u = static_cast<u32>(row_u + du_dx * lo);
+    u32 v = static_cast<u32>(row_v + dv_dx * lo);
+    auto *out = &dst.at(x0 + lo, y);
+    for (i64 i = lo; i <= hi; ++i, ++out, u += du_dx, v += dv_dx) {
+      auto c = src_data[(v >> 16) * src_stride + (u >> 16)];
+      if (premultiplied)
+        pixel::blend_premultiplied_pixel<dst_format>(
+            *out, pixel::Traits<src_format>::unpack(c));
+      else
+        pixel::put<src_format, dst_format>(*out, c);
+    }
+  }
+}
+
+template <PixelFormat src_format>
+void draw(const Surface &dst, const ConstSurface &src, int dst_cx, int dst_cy,
+          float angle_rad, float scale, float src_cx, float src_cy,
+          bool premultiplied = false) {
+  bool drawn = visit(dst, [&](auto typed_dst) {
+    constexpr auto dst_format = decltype(typed_dst)::format;
+    ConstTypedSurface<src_format> typed_src{src};
+    if (premultiplied)
+      draw<src_format, dst_format, true>(typed_dst, typed_src, dst_cx, dst_cy,
+                                         angle_rad, scale, src_cx, src_cy);
+    else
+      draw<src_format, dst_format>(typed_dst, typed_src, dst_cx, dst_cy,
+                                   angle_rad, scale, src_cx, src_cy);
+  });
+  if (!drawn)
+    std::printf("Unsupported destination format for rotozoom\r\n");
+}
+
+} // namespace rotozoom
+} // namespace gfx
+} // namespace ge
@@ -2,9 +2,22 @@
 
 #include "ge-hal/gpu.hpp"
 #include "ge-hal/surface.hpp"
+#include "ge-hal/typed_surface.hpp"
 
 namespace ge {
-inline void draw_rect(const Surface &surface, u16 color, u32 stroke_width = 2) {
+// An RGB565 color as hal::gpu::fill() takes it for the surface, opaque for
+// the formats with alpha
+inline u32 fill_color(const Surface &surface, u16 color) {
+  u32 result = color;
+  visit(surface, [&](auto fb) {
+    result = pixel::convert<decltype(fb)::format, PixelFormat::RGB565>(color);
+  });
+  return result;
+}
+
+inline void draw_rect(const Surface &surface, u16 rgb565,
+                      u32 stroke_width = 2) {
+  const u32 color = fill_color(surface, rgb565);
   hal::gpu::fill(surface.subsurface(0, 0, surface.get_width(), stroke_width),
                  color);
   hal::gpu::fill(surface.subsurface(0, surface.get_height() - stroke_width,
@@ -8,6 +8,14 @@ struct PCG32 {
   u64 state = 0x853c49e6748fea9bULL;
   u64 inc = 0xda3e39cb94b95bdbULL;
 
+  // Restart the sequence from a seed (pcg32_srandom, keeping the stream)
+  void seed(u64 init_state) {
+    state = 0;
+    (*this)();
+    state += init_state;
+    (*this)();
+  }
+
   static constexpr result_type min() { return 0; }
   static constexpr result_type max() { return UINT32_MAX; }
 
@@ -23,6 +31,8 @@ struct PCG32 {
 };
 
 namespace rng {
+// Seed from the platform's entropy source, or from the input recording being
+// replayed (see ge-hal/replay.hpp)
 void init_seed();
 
 inline u32 next() { return PCG32::instance()(); }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ge-hal/app.hpp"
+#include "ge-hal/profiler.hpp"
 #include "ge-hal/surface.hpp"
 
 namespace ge {
@@ -11,6 +12,9 @@ public:
   explicit Scene(App &app) : app(app) {}
   virtual ~Scene() = default;
 
+  // Shown by the profiler
+  virtual const char *name() const { return "Scene"; }
+
   // --- lifecycle -------------------------------------------------
 
   virtual bool is_active() const { return true; }
@@ -18,9 +22,31 @@ public:
   // Update logic
   virtual void tick(float /*dt*/) {}
 
-  // Render into framebuffer region
+  // Render into framebuffer region. With strip rendering (hal::strips) this
+  // is called once per band, each time with the same state, so it should
+  // not change what needs_redraw() depends on: on_rendered() does.
   virtual void render(Surface & /*fb_region*/) {}
 
+  // Called once render() has drawn the whole frame
+  virtual void on_rendered() {}
+
+  // --- redraw ----------------------------------------------------
+
+  // Whether render() would draw something different from the last frame.
+  // When no active scene needs a redraw, the frame is not rendered (nor
+  // presented) at all. Scenes that draw nothing, or only change on input,
+  // override this.
+  virtual bool needs_redraw() const { return true; }
+
+  // Whatever this scene drew before is gone (another scene was shown or
+  // hidden over it), so the next render() must draw everything.
+  virtual void invalidate() {}
+
+  // Whether render() covers all of its region with opaque pixels. In a
+  // ContainerScene, the scenes below an opaque one are still ticked but
+  // neither rendered nor asked whether they need a redraw.
+  virtual bool is_opaque() const { return false; }
+
   // --- input -----------------------------------------------------
 
   // Return true if event is handled / captured
@@ -77,8 +103,7 @@ public:
   }
 
   template <class SceneContainer> void set_scenes(SceneContainer &container) {
-    scenes = container.data();
-    scene_count = static_cast<u32>(container.size());
+    set_scenes(container.data(), static_cast<u32>(container.size()));
   }
 
   // --- lifecycle -------------------------------------------------
@@ -88,21 +113,63 @@ public:
     for (u32 i = 0; i < scene_count; ++i) {
       Scene *s = scenes[i];
       if (s && s->is_active()) {
+        hal::profiler::Scope scope{s->name(), hal::profiler::Category::Tick};
         s->tick(dt);
       }
     }
   }
 
   void render(Surface &fb_region) override {
+    u32 visible = visible_mask();
+    if (visible != rendered_mask)
+      invalidate();
+
     // Bottom -> top
     for (u32 i = 0; i < scene_count; ++i) {
       Scene *s = scenes[i];
-      if (s && s->is_active()) {
+      if (visible & (1u << i)) {
+        hal::profiler::Scope scope{s->name(),
+                                   hal::profiler::Category::Render};
         s->render(fb_region);
       }
     }
   }
 
+  void on_rendered() override {
+    rendered_mask = visible_mask();
+    for (u32 i = 0; i < scene_count; ++i) {
+      if (rendered_mask & (1u << i))
+        scenes[i]->on_rendered();
+    }
+  }
+
+  bool needs_redraw() const override {
+    u32 visible = visible_mask();
+    if (visible != rendered_mask)
+      return true;
+    for (u32 i = 0; i < scene_count; ++i) {
+      if ((visible & (1u << i)) && scenes[i]->needs_redraw())
+        return true;
+    }
+    return false;
+  }
+
+  void invalidate() override {
+    rendered_mask = INVALID_MASK;
+    for (u32 i = 0; i < scene_count; ++i) {
+      if (scenes[i])
+        scenes[i]->invalidate();
+    }
+  }
+
+  bool is_opaque() const override {
+    for (u32 i = 0; i < scene_count; ++i) {
+      if (scenes[i] && scenes[i]->is_active() && scenes[i]->is_opaque())
+        return true;
+    }
+    return false;
+  }
+
   // --- input -----------------------------------------------------
 
   bool on_joystick_moved(float dt, float x, float y) override {
@@ -141,8 +208,26 @@ protected:
   }
 
 private:
+  // Bit i is set if sub-scene i is active and not below an opaque one
+  u32 visible_mask() const {
+    u32 mask = 0;
+    for (u32 i = 0; i < scene_count; ++i) {
+      Scene *s = scenes[i];
+      if (!s || !s->is_active())
+        continue;
+      if (s->is_opaque())
+        mask = 0;
+      mask |= 1u << i;
+    }
+    return mask;
+  }
+
+  // Never a valid mask, there are at most 31 sub-scenes
+  static constexpr u32 INVALID_MASK = 1u << 31;
+
   Scene **scenes;
   u32 scene_count;
+  u32 rendered_mask = INVALID_MASK;
 };
 } // namespace scenes
 } // namespace ge
@@ -13,9 +13,12 @@ class BuzzScene : public Scene {
 public:
   BuzzScene(RootScene &parent);
 
+  const char *name() const override { return "BuzzScene"; }
+
   void buzz_for(i64 time);
 
   void tick(float dt) override;
+  bool needs_redraw() const override { return false; }
   bool on_button_clicked(Button btn) override {
     buzz_for(50);
     return false;
@@ -16,6 +16,8 @@ class DialogScene : public Scene {
 public:
   explicit DialogScene(RootScene &parent);
 
+  const char *name() const override { return "DialogScene"; }
+
   void render(Surface &fb_region) override;
   bool on_button_clicked(Button btn) override;
 
@@ -39,6 +41,7 @@ private:
   i64 start_time;
   i64 ms_per_char;
   DialogMessage msg;
+  i64 desc_length = 0;
   bool has_msg = false;
 };
 
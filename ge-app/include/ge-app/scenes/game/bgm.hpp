@@ -10,9 +10,13 @@ class BGMScene : public Scene {
 public:
   BGMScene(GameScene &parent);
 
+  const char *name() const override { return "game::BGMScene"; }
+
   void on_enter();
   void on_exit();
 
+  bool needs_redraw() const override { return false; }
+
 private:
   GameScene &parent;
 };
@@ -9,6 +9,8 @@ class GameOverScene : public Scene {
 public:
   GameOverScene(GameScene &parent);
 
+  const char *name() const override { return "GameOverScene"; }
+
   void render(Surface &fb_region) override;
   bool on_button_clicked(Button btn) override;
 
@@ -10,6 +10,8 @@ class ClockScene : public Scene {
 public:
   ClockScene(HUDScene &parent);
 
+  const char *name() const override { return "ClockScene"; }
+
   void render(Surface &fb_region) override;
 
 private:
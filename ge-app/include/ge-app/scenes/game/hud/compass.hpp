@@ -13,6 +13,8 @@ class CompassScene : public Scene {
 public:
   CompassScene(HUDScene &parent);
 
+  const char *name() const override { return "CompassScene"; }
+
   void render(Surface &fb_region) override;
 
 private:
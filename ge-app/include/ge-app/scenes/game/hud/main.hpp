@@ -18,6 +18,8 @@ class HUDScene : public ContainerScene {
 public:
   HUDScene(GameScene &parent);
 
+  const char *name() const override { return "HUDScene"; }
+
   WorldScene &get_world_scene();
 
   GameMode get_current_mode() const {
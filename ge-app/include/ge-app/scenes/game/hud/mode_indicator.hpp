@@ -14,6 +14,8 @@ class ModeIndicatorScene : public Scene {
 public:
   ModeIndicatorScene(HUDScene &parent);
 
+  const char *name() const override { return "ModeIndicatorScene"; }
+
   void render(Surface &fb_region) override;
 
   bool on_button_clicked(Button btn) override {
@@ -12,6 +12,8 @@ class YHUDScene : public Scene {
 public:
   YHUDScene(HUDScene &parent);
 
+  const char *name() const override { return "YHUDScene"; }
+
   void render(Surface &fb_region) override;
 
 private:
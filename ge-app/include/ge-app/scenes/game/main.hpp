@@ -20,6 +20,8 @@ class GameScene : public ContainerScene {
 public:
   explicit GameScene(RootScene &parent);
 
+  const char *name() const override { return "GameScene"; }
+
   game::WorldScene &get_world_scene() { return world; }
   game::ManagementUIScene &get_management_ui_scene() { return management_ui; }
   DialogScene &get_dialog_scene();
@@ -3,6 +3,7 @@
 #include "ge-app/font.hpp"
 #include "ge-app/game/inventory.hpp"
 #include "ge-app/game/player_stats.hpp"
+#include "ge-app/gfx/cached_layer.hpp"
 #include "ge-app/scenes/base.hpp"
 #include "ge-app/ui/menu.hpp"
 #include "ge-hal/app.hpp"
@@ -22,6 +23,8 @@ class InventoryScene : public Scene {
 public:
   InventoryScene(ManagementUIScene &parent);
 
+  const char *name() const override { return "InventoryScene"; }
+
   Inventory &get_inventory() { return inventory; }
 
   void start_new_game() {
@@ -37,6 +40,82 @@ public:
   }
 
   void render(Surface &fb_region) override {
+    layer.render(fb_region, layer_key(), [&](Surface &s) { draw(s); });
+  }
+
+  void on_rendered() override { layer.on_rendered(layer_key()); }
+
+  // Only drawn again when the items or the selection change
+  bool needs_redraw() const override {
+    return layer.needs_redraw(layer_key());
+  }
+  void invalidate() override { layer.invalidate(); }
+  bool is_opaque() const override { return true; }
+
+  bool on_button_clicked(Button btn) override {
+    if (btn == Button::Button1) {
+      // Eat selected fish
+      if (inventory.get_item_count() > 0 &&
+          selected_index < inventory.get_item_count()) {
+        const auto &item = inventory.get_item(selected_index);
+
+        // Check if it's a poisonous or non-food item
+        bool is_edible = true;
+        float food_value = 10.0f; // Base food value
+
+        // Pufferfish is poisonous
+        if (strstr(item.name, "Pufferfish") != nullptr) {
+          is_edible = false;
+        }
+        // Boots and chests are not edible
+        if (strstr(item.name, "Boot") != nullptr ||
+            strstr(item.name, "Chest") != nullptr) {
+          is_edible = false;
+        }
+
+        if (is_edible) {
+          auto &player_stats = get_player_stats();
+          // Consume the fish - food value based on weight
+          food_value = item.weight * 20.0f; // 1kg = 20 food
+          player_stats.consume_fish(food_value);
+
+          // Remove from inventory
+          inventory.remove_fish(selected_index);
+
+          // Adjust selected_index if needed
+          if (selected_index >= inventory.get_item_count() &&
+              selected_index > 0) {
+            selected_index--;
+          }
+          // Adjust scroll if needed
+          if (scroll_offset >= inventory.get_item_count()) {
+            scroll_offset = get_max_scroll();
+          }
+        }
+      }
+      return true; // Event captured
+    } else if (btn == Button::Button2) {
+      // Return to management menu
+      on_back_action();
+      return true; // Event captured
+    }
+    return Scene::on_button_clicked(btn); // Check sub-scenes
+  }
+
+  void on_back_action();
+
+  bool is_active() const override;
+
+private:
+  ManagementUIScene &parent;
+  Inventory inventory;
+  PlayerStats &get_player_stats();
+  u32 scroll_offset;
+  u32 selected_index;
+  bool joy_moved = false;
+  CachedLayer layer;
+
+  void draw(Surface &fb_region) {
     // Clear screen with dark background
     hal::gpu::fill(fb_region, 0x0000);
 
@@ -106,68 +185,14 @@ public:
                         fb_region.get_height() - line_height - 10, 0x7BEF);
   }
 
-  bool on_button_clicked(Button btn) override {
-    if (btn == Button::Button1) {
-      // Eat selected fish
-      if (inventory.get_item_count() > 0 &&
-          selected_index < inventory.get_item_count()) {
-        const auto &item = inventory.get_item(selected_index);
-
-        // Check if it's a poisonous or non-food item
-        bool is_edible = true;
-        float food_value = 10.0f; // Base food value
-
-        // Pufferfish is poisonous
-        if (strstr(item.name, "Pufferfish") != nullptr) {
-          is_edible = false;
-        }
-        // Boots and chests are not edible
-        if (strstr(item.name, "Boot") != nullptr ||
-            strstr(item.name, "Chest") != nullptr) {
-          is_edible = false;
-        }
-
-        if (is_edible) {
-          auto &player_stats = get_player_stats();
-          // Consume the fish - food value based on weight
-          food_value = item.weight * 20.0f; // 1kg = 20 food
-          player_stats.consume_fish(food_value);
-
-          // Remove from inventory
-          inventory.remove_fish(selected_index);
-
-          // Adjust selected_index if needed
-          if (selected_index >= inventory.get_item_count() &&
-              selected_index > 0) {
-            selected_index--;
-          }
-          // Adjust scroll if needed
-          if (scroll_offset >= inventory.get_item_count()) {
-            scroll_offset = get_max_scroll();
-          }
-        }
-      }
-      return true; // Event captured
-    } else if (btn == Button::Button2) {
-      // Return to management menu
-      on_back_action();
-      return true; // Event captured
-    }
-    return Scene::on_button_clicked(btn); // Check sub-scenes
+  u64 layer_key() const {
+    return CachedLayer::Key{}
+        .add(inventory.get_version())
+        .add(scroll_offset)
+        .add(selected_index)
+        .get();
   }
 
-  void on_back_action();
-
-  bool is_active() const override;
-
-private:
-  ManagementUIScene &parent;
-  Inventory inventory;
-  PlayerStats &get_player_stats();
-  u32 scroll_offset;
-  u32 selected_index;
-  bool joy_moved = false;
-
   u32 get_max_scroll() const {
     const u32 max_visible_items = 8;
     if (inventory.get_item_count() <= max_visible_items) {
@@ -26,6 +26,8 @@ class ManagementUIScene : public ContainerScene {
 public:
   ManagementUIScene(GameScene &parent);
 
+  const char *name() const override { return "ManagementUIScene"; }
+
   // Navigation methods called by management menu
   void show_status_screen();
   void show_inventory_screen();
@@ -45,6 +47,9 @@ public:
 
   bool is_active() const override;
 
+  // The part of fb, centered, that the background takes
+  Surface bg_region(Surface &fb);
+  // Blends the background over fb, returns bg_region(fb)
   Surface render_bg(Surface &fb);
 
   void start_new_game() {
@@ -64,7 +69,7 @@ private:
   std::array<Scene *, 4> management_sub_scenes = {
       &management_menu, &status_scene, &inventory_scene, &map_scene};
 
-  TextureARGB8888 bg_texture;
+  IndexedTexture bg_texture;
 };
 
 } // namespace game
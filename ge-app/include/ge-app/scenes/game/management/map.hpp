@@ -31,6 +31,8 @@ class MapScene : public Scene {
 public:
   MapScene(ManagementUIScene &parent);
 
+  const char *name() const override { return "MapScene"; }
+
   void start_new_game() {
     // Clear bookmarks
     for (u32 i = 0; i < MAX_BOOKMARKS; i++) {
@@ -60,6 +62,9 @@ public:
     return true;
   }
 
+  // The water covers the whole screen
+  bool is_opaque() const override { return true; }
+
   void render(Surface &fb_region) override {
     // Render ocean texture
     water.render(nullptr, fb_region, NAN,
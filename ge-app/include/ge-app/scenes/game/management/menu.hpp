@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ge-app/font.hpp"
+#include "ge-app/gfx/cached_layer.hpp"
 #include "ge-app/scenes/base.hpp"
 #include "ge-app/ui/menu.hpp"
 #include "ge-hal/app.hpp"
@@ -23,12 +24,23 @@ class MenuScene : public Scene {
 public:
   MenuScene(ManagementUIScene &parent);
 
+  const char *name() const override { return "management::MenuScene"; }
+
   void tick(float dt) override {
     auto joystick = app.get_joystick_state();
     menu.move_selection(joystick.y);
   }
 
   void render(Surface &fb_region) override;
+  void on_rendered() override {
+    layer.on_rendered(menu.get_selected_index());
+  }
+
+  // Only the selection changes what the menu looks like
+  bool needs_redraw() const override {
+    return layer.needs_redraw(menu.get_selected_index());
+  }
+  void invalidate() override { layer.invalidate(); }
 
   bool on_button_clicked(Button btn) override {
     if (btn == Button::Button1) {
@@ -49,6 +61,10 @@ private:
 
   ui::Menu menu;
   ui::MenuItem menu_items[3];
+  // ARGB8888, the background has transparent corners
+  CachedLayer layer;
+
+  void draw(Surface &layer_surface);
 };
 
 } // namespace mgmt
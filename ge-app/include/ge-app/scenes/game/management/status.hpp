@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ge-app/gfx/cached_layer.hpp"
 #include "ge-app/scenes/base.hpp"
 #include "ge-hal/surface.hpp"
 
@@ -15,18 +16,33 @@ class StatusScene : public Scene {
 public:
   explicit StatusScene(ManagementUIScene &parent);
 
+  const char *name() const override { return "StatusScene"; }
+
   void render(Surface &fb_region) override;
+  void on_rendered() override { layer.on_rendered(layer_key()); }
   bool on_button_clicked(Button btn) override;
 
+  // Only drawn again when the numbers on it change
+  bool needs_redraw() const override {
+    return layer.needs_redraw(layer_key());
+  }
+  void invalidate() override { layer.invalidate(); }
+  bool is_opaque() const override { return true; }
+
   void on_back_action();
 
   bool is_active() const override;
 
 private:
+  // Everything the screen shows
+  u64 layer_key() const;
+  void draw(Surface &fb_region);
+
   // Helper to draw a status bar
   void draw_status_bar(const Surface &region, float percent, u16 color);
 
   ManagementUIScene &parent;
+  CachedLayer layer;
 };
 
 } // namespace mgmt
@@ -17,6 +17,8 @@ class BoatUpdateScene : public Scene {
 public:
   BoatUpdateScene(BoatScene &parent);
 
+  const char *name() const override { return "BoatUpdateScene"; }
+
   void render(Surface &fb_region) override;
   void tick(float dt) override;
 
@@ -28,6 +30,8 @@ class BoatSteeringScene : public Scene {
 public:
   BoatSteeringScene(BoatScene &parent);
 
+  const char *name() const override { return "BoatSteeringScene"; }
+
   bool on_joystick_moved(float dt, float x, float y) override;
   bool on_button_held(Button btn) override;
   bool on_button_finished_hold(Button btn) override;
@@ -43,6 +47,8 @@ class BoatScene : public ContainerScene {
 public:
   BoatScene(WorldScene &parent);
 
+  const char *name() const override { return "BoatScene"; }
+
   void on_exit() { boat_steering_scene.on_exit(); }
 
   void on_mode_changed(GameMode old_mode, GameMode new_mode) {
@@ -13,6 +13,8 @@ class DockScene : public Scene {
 public:
   DockScene(WorldScene &parent);
 
+  const char *name() const override { return "DockScene"; }
+
   void render(Surface &fb_region) override;
 
 private:
@@ -18,6 +18,8 @@ class FishingUpdateScene : public Scene {
 public:
   FishingUpdateScene(FishingScene &parent);
 
+  const char *name() const override { return "FishingUpdateScene"; }
+
   void tick(float dt) override;
   void render(Surface &fb_region) override;
 
@@ -29,6 +31,8 @@ class FishingInputScene : public Scene {
 public:
   FishingInputScene(FishingScene &parent);
 
+  const char *name() const override { return "FishingInputScene"; }
+
   bool on_button_clicked(Button btn) override;
   bool on_joystick_moved(float dt, float x, float y) override;
 
@@ -42,6 +46,8 @@ class FishingScene : public ContainerScene {
 public:
   FishingScene(WorldScene &parent);
 
+  const char *name() const override { return "FishingScene"; }
+
   void on_mode_changed(GameMode old_mode, GameMode new_mode);
 
 private:
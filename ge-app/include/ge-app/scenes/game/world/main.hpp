@@ -5,6 +5,7 @@
 #include "ge-app/game/boat.hpp"
 #include "ge-app/game/clock.hpp"
 #include "ge-app/game/inventory.hpp"
+#include "ge-app/game/perspective.hpp"
 #include "ge-app/game/player_stats.hpp"
 #include "ge-app/scenes/base.hpp"
 #include "ge-app/scenes/buzz.hpp"
@@ -43,6 +44,11 @@ class WorldScene : public ContainerScene {
 public:
   WorldScene(GameScene &parent);
 
+  const char *name() const override { return "WorldScene"; }
+
+  // the sky and the water cover the screen every frame
+  bool is_opaque() const override { return true; }
+
   void start_new_game() {
     boat_scene.start_new_game();
     obstacle_scene.start_new_game();
@@ -60,6 +66,7 @@ public:
   f32 get_world_dt() const { return world_dt; }
 
   Boat &get_boat() { return boat_scene.get_boat(); }
+  world::ObstacleScene &get_obstacle_scene() { return obstacle_scene; }
   Inventory &get_inventory();
   BuzzScene &get_buzz_scene();
 
@@ -74,6 +81,15 @@ public:
                                 App::HEIGHT - SKY_HEIGHT);
   }
 
+  // How the water region is projected, nullptr without PERSPECTIVE_WATER
+  const PerspectiveMapping *get_perspective() const {
+#ifdef GE_PERSPECTIVE_WATER
+    return &perspective;
+#else
+    return nullptr;
+#endif
+  }
+
   GameMode get_current_mode() const;
   DialogScene &get_dialog_scene();
 
@@ -87,6 +103,10 @@ public:
 private:
   static constexpr u32 SKY_HEIGHT = 80;
   GameScene &parent;
+#ifdef GE_PERSPECTIVE_WATER
+  // A table of a few KB, built with floats, so not in the default build
+  PerspectiveMapping perspective{App::WIDTH, App::HEIGHT - SKY_HEIGHT};
+#endif
 
   // Temporary storage
   f32 world_dt = 0.0; // world delta time
@@ -1,11 +1,14 @@
 #pragma once
 
-#include "assets/out/textures/whirlpool.h"
+#include "assets/out/textures/sprites.h"
 #include "ge-app/aabb.hpp"
 #include "ge-app/arrayvec.hpp"
 #include "ge-app/game/boat.hpp"
+#include "ge-app/game/perspective.hpp"
 #include "ge-app/rng.hpp"
 #include "ge-app/scenes/base.hpp"
+#include "ge-app/sprite.hpp"
+#include "ge-hal/timestep.hpp"
 #include <cmath>
 
 namespace ge {
@@ -17,17 +20,18 @@ namespace world {
 class Whirlpool {
 public:
   Whirlpool(App &app, float x, float y)
-      : x(x), y(y), spawn_time(app.now() * 1e-3) {}
+      : x(x), y(y), prev_x(x), prev_y(y), spawn_time(app.now() * 1e-3) {}
 
   float get_x() const { return x; }
   float get_y() const { return y; }
 
   AABB hitbox() const {
+    const auto &frame = atlas::sprites::whirlpool[0];
     AABB texture_hitbox{
-        static_cast<i32>(x - whirlpool_FRAME_WIDTH / 2),
-        static_cast<i32>(y - whirlpool_FRAME_HEIGHT / 2),
-        whirlpool_FRAME_WIDTH,
-        whirlpool_FRAME_HEIGHT,
+        static_cast<i32>(x - frame.get_width() / 2),
+        static_cast<i32>(y - frame.get_height() / 2),
+        static_cast<i32>(frame.get_width()),
+        static_cast<i32>(frame.get_height()),
     };
 
     return texture_hitbox;
@@ -37,6 +41,9 @@ public:
             u32 &damage_reduction) {
     auto boat_x = boat.get_x();
     auto boat_y = boat.get_y();
+    prev_x = x;
+    prev_y = y;
+    moved_at = hal::timestep::tick_count();
     // --- movement ---
     float to_boat_x = static_cast<float>(boat_x) - x;
     float to_boat_y = static_cast<float>(boat_y) - y;
@@ -90,7 +97,9 @@ public:
     }
   }
 
-  void render(App &app, Boat &boat, Surface &region) {
+  // region is the water region, projected by perspective if not null
+  void render(App &app, Boat &boat, Surface &region,
+              const PerspectiveMapping *perspective = nullptr) {
     auto state_info = get_state_info(app);
     u8 opacity = state_info.opacity;
     if (opacity == 0)
@@ -98,31 +107,24 @@ public:
 
     auto state = state_info.state;
 
+    using atlas::sprites::whirlpool;
     const u32 frame_idx = static_cast<u32>(
-        (app.now() / whirlpool_FRAME_DURATIONS[0]) % whirlpool_FRAME_COUNT);
+        (app.now() / whirlpool[0].get_duration()) %
+        atlas::sprites::whirlpool_FRAME_COUNT);
 
-    // --- world -> screen ---
+    // --- world -> screen, between the last two ticks ---
+    float render_x = hal::timestep::interpolate(prev_x, x, moved_at);
+    float render_y = hal::timestep::interpolate(prev_y, y, moved_at);
 
-    i32 dst_x = static_cast<i32>(x - boat.get_x() + region.get_width() / 2);
+    i32 dst_x = static_cast<i32>(render_x - boat.get_render_x() +
+                                 region.get_width() / 2);
 
-    i32 dst_y = static_cast<i32>(boat.get_y() - y + region.get_height() / 2);
+    i32 dst_y = static_cast<i32>(boat.get_render_y() - render_y +
+                                 region.get_height() / 2);
+    if (perspective)
+      perspective->project(dst_x, dst_y);
 
-    // --- source rect ---
-    i32 src_x = static_cast<i32>(frame_idx * whirlpool_FRAME_WIDTH);
-    i32 src_y = 0;
-    i32 w = whirlpool_FRAME_WIDTH;
-    i32 h = whirlpool_FRAME_HEIGHT;
-
-    if (!clip_blit_rect(region.get_width(), region.get_height(), dst_x, dst_y,
-                        src_x, src_y, w, h))
-      return;
-
-    auto src =
-        whirlpool_texture.subsurface(u32(src_x), u32(src_y), u32(w), u32(h));
-
-    auto dst = region.subsurface(u32(dst_x), u32(dst_y), u32(w), u32(h));
-
-    hal::gpu::blit_blend(dst, src, opacity);
+    whirlpool[frame_idx].blit(region, dst_x, dst_y, opacity);
   }
 
   enum class State {
@@ -161,19 +163,25 @@ public:
 
 private:
   float x, y;
+  // position before the last move, and the tick of that move
+  float prev_x, prev_y;
+  u64 moved_at = 0;
   float spawn_time;
-  TextureARGB8888 whirlpool_texture{whirlpool, whirlpool_WIDTH,
-                                    whirlpool_HEIGHT, whirlpool_FORMAT_CPP};
 };
 
 class ObstacleScene : public Scene {
 public:
   ObstacleScene(WorldScene &parent);
 
+  const char *name() const override { return "ObstacleScene"; }
+
   void tick(float dt) override;
   void render(Surface &fb_region) override;
   void start_new_game() { whirlpools.clear(); }
 
+  // Returns false if there are too many whirlpools already
+  bool spawn_whirlpool(float x, float y);
+
 private:
   WorldScene &parent;
 
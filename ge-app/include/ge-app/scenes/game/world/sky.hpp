@@ -13,6 +13,8 @@ class SkyScene : public Scene {
 public:
   SkyScene(WorldScene &parent);
 
+  const char *name() const override { return "SkyScene"; }
+
   void render(Surface &fb_region) override;
 
 private:
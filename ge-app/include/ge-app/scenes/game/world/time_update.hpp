@@ -13,7 +13,10 @@ class TimeUpdateScene : public Scene {
 public:
   TimeUpdateScene(WorldScene &parent);
 
+  const char *name() const override { return "TimeUpdateScene"; }
+
   void tick(float dt) override;
+  bool needs_redraw() const override { return false; }
 
   bool on_button_held(Button btn) override;
   bool on_button_finished_hold(Button btn) override;
@@ -13,6 +13,8 @@ class WaterScene : public Scene {
 public:
   WaterScene(WorldScene &parent);
 
+  const char *name() const override { return "WaterScene"; }
+
   void render(Surface &fb_region) override;
 
 private:
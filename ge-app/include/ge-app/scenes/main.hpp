@@ -21,10 +21,13 @@ class RootScene : public ContainerScene {
 public:
   RootScene(App &app);
 
+  const char *name() const override { return "RootScene"; }
+
   void start_game();
   void exit();
 
   DialogScene &get_dialog_scene() { return dialog_scene; }
+  GameScene &get_game_scene() { return game_scene; }
 
   bool is_current_screen(RootSceneScreen screen) const {
     return current_screen == screen;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ge-app/gfx/cached_layer.hpp"
 #include "ge-app/scenes/base.hpp"
 #include "ge-app/texture.hpp"
 #include "ge-hal/app.hpp"
@@ -15,10 +16,18 @@ class CreditsScene : public Scene {
 public:
   explicit CreditsScene(MenuScene &parent);
 
+  const char *name() const override { return "CreditsScene"; }
+
   void tick(float dt) override;
   void render(Surface &fb_region) override;
+  void on_rendered() override { layer.on_rendered(0); }
   bool on_button_clicked(Button btn) override;
 
+  // Static page, drawn once and copied in when it is shown again
+  bool needs_redraw() const override { return layer.needs_redraw(0); }
+  void invalidate() override { layer.invalidate(); }
+  bool is_opaque() const override { return true; }
+
   // Handle back action
   void on_back_action();
 
@@ -27,6 +36,9 @@ public:
 private:
   MenuScene &parent;
   TextureRGB565 menu_bg_texture;
+  CachedLayer layer;
+
+  void draw(Surface &fb_region);
 };
 
 } // namespace menu
@@ -21,6 +21,8 @@ class MenuScene : public ContainerScene {
 public:
   MenuScene(RootScene &parent);
 
+  const char *name() const override { return "MenuScene"; }
+
   void start_game();
   void exit();
 
@@ -10,9 +10,13 @@ class BGMScene : public Scene {
 public:
   BGMScene(MenuScene &parent);
 
+  const char *name() const override { return "menu::BGMScene"; }
+
   void on_enter();
   void on_exit();
 
+  bool needs_redraw() const override { return false; }
+
 private:
   MenuScene &parent;
 };
@@ -17,10 +17,18 @@ class MenuSelectScene : public Scene {
 public:
   explicit MenuSelectScene(MenuScene &parent);
 
+  const char *name() const override { return "MenuSelectScene"; }
+
   void tick(float dt) override;
   void render(Surface &fb_region) override;
+  void on_rendered() override;
   bool on_button_clicked(Button btn) override;
 
+  bool needs_redraw() const override;
+  void invalidate() override;
+  // the background is drawn whole every time
+  bool is_opaque() const override { return true; }
+
   void on_menu_action(MenuAction action);
 
   bool is_active() const override;
@@ -32,6 +40,10 @@ private:
   const char *subtitle;
 
   TextureRGB565 menu_bg_texture;
+
+  // Selection currently on screen, only valid if drawn is set
+  u32 rendered_selection = 0;
+  bool drawn = false;
 };
 
 } // namespace menu
@@ -5,6 +5,7 @@
 #include "ge-app/ui/option_selector.hpp"
 #include "ge-app/ui/slider.hpp"
 #include "ge-hal/app.hpp"
+#include "ge-hal/damage.hpp"
 #include "ge-hal/surface.hpp"
 
 namespace ge {
@@ -25,10 +26,16 @@ class SettingsScene : public Scene {
 public:
   explicit SettingsScene(MenuScene &parent);
 
+  const char *name() const override { return "SettingsScene"; }
+
   void tick(float dt) override;
   void render(Surface &fb_region) override;
+  void on_rendered() override;
   bool on_button_clicked(Button btn) override;
 
+  bool needs_redraw() const override;
+  void invalidate() override;
+
   // Getters
   bool is_button_flipped() const;
   float get_music_volume() const;
@@ -47,6 +54,22 @@ private:
   bool joy_moved_y;
 
   TextureRGB565 menu_bg_texture;
+
+  // Everything an item's appearance depends on
+  struct ItemState {
+    u32 selected_item;
+    float music_volume, sfx_volume;
+    u32 button_flip;
+  };
+
+  ItemState item_state() const;
+  static bool item_changed(const ItemState &a, const ItemState &b, u32 item);
+  static hal::damage::Rect item_rect(const Surface &fb_region, u32 item);
+  void render_item(Surface &fb_region, u32 item);
+
+  // What is currently on screen, only valid if drawn is set
+  ItemState rendered;
+  bool drawn = false;
 };
 
 } // namespace menu
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "ge-app/gfx/rle.hpp"
+#include "ge-app/gfx/rotozoom.hpp"
+#include "ge-app/texture.hpp"
+#include "ge-hal/gpu.hpp"
+#include "ge-hal/surface.hpp"
+#include <cmath>
+
+namespace ge {
+
+// Sprites packed into shared pages by texture_atlas() (see
+// ge-app/assets/scripts/atlas.py). The generated header declares one
+// constexpr SpriteRef per sprite (an array of them for animations, a
+// RotatedSprite for pre-rotated ones) in ge::atlas::<atlas name>.
+
+struct AtlasPage {
+  u32 offset; // in pixels, into the atlas data
+  u16 width, height;
+};
+
+struct Atlas {
+  const void *data;
+  PixelFormat format;
+  const AtlasPage *pages;
+  // atlas.py --rle only: the offset of every sprite row into rle_runs
+  const u32 *rle_rows = nullptr;
+  const u8 *rle_runs = nullptr;
+  // atlas.py --premultiplied: ARGB8888 colors premultiplied by their alpha
+  bool premultiplied = false;
+
+  ConstSurface page(u16 index) const {
+    const auto &p = pages[index];
+    auto bytes = static_cast<const u8 *>(data) +
+                 p.offset * pixel_format_bpp(format) / 8;
+    return ConstSurface{bytes, p.width, p.width, p.height, format};
+  }
+};
+
+struct SpriteDesc {
+  u16 page;
+  // the sprite on its page, trimmed of its transparent borders
+  u16 x, y, w, h;
+  // where the trimmed rectangle is in the untrimmed image
+  u16 trim_x, trim_y;
+  // the untrimmed image, which is what callers position
+  u16 width, height;
+  i16 pivot_x, pivot_y;
+  // animation frames only, in ms
+  u16 duration;
+  // index of the first row of the sprite in Atlas::rle_rows, NO_RLE for the
+  // sprites drawn with a plain blend
+  u32 rle_row;
+
+  static constexpr u32 NO_RLE = 0xFFFFFFFF;
+};
+
+class SpriteRef {
+public:
+  constexpr SpriteRef(const Atlas &atlas, const SpriteDesc &desc)
+      : atlas(&atlas), desc(&desc) {}
+
+  u32 get_width() const { return desc->width; }
+  u32 get_height() const { return desc->height; }
+  i32 get_pivot_x() const { return desc->pivot_x; }
+  i32 get_pivot_y() const { return desc->pivot_y; }
+  u32 get_duration() const { return desc->duration; }
+  const SpriteDesc &get_desc() const { return *desc; }
+
+  // The trimmed pixels
+  ConstSurface surface() const {
+    return atlas->page(desc->page).subsurface(desc->x, desc->y, desc->w,
+                                              desc->h);
+  }
+
+  // Blends the sprite into region with the top-left corner of the untrimmed
+  // image at (x, y), clipped to region. Sprites with runs (atlas.py --rle,
+  // host builds only) are drawn by the CPU, skipping their transparent
+  // pixels; the others are hal::gpu blends.
+  void blit(const Surface &region, i32 x, i32 y, u8 alpha = 0xFF) const {
+    i32 dst_x = x + desc->trim_x, dst_y = y + desc->trim_y;
+    i32 src_x = 0, src_y = 0, w = desc->w, h = desc->h;
+    if (!clip_blit_rect(region.get_width(), region.get_height(), dst_x, dst_y,
+                        src_x, src_y, w, h))
+      return;
+    auto dst = region.subsurface(dst_x, dst_y, w, h);
+    if (atlas->rle_runs && desc->rle_row != SpriteDesc::NO_RLE) {
+      gfx::rle::draw(dst, surface(), atlas->rle_rows + desc->rle_row,
+                     atlas->rle_runs, src_x, src_y, alpha,
+                     atlas->premultiplied);
+      return;
+    }
+    auto src = surface().subsurface(src_x, src_y, w, h);
+    if (atlas->premultiplied)
+      hal::gpu::blit_blend_premultiplied(dst, src, alpha);
+    else
+      hal::gpu::blit_blend(dst, src, alpha);
+  }
+
+  // Same, with the pivot at (x, y)
+  void blit_at_pivot(const Surface &region, i32 x, i32 y,
+                     u8 alpha = 0xFF) const {
+    blit(region, x - desc->pivot_x, y - desc->pivot_y, alpha);
+  }
+
+  // Texture<>::blit_rotated() of the sprite, the source center in untrimmed
+  // coordinates (the pivot by default)
+  template <PixelFormat format, class Region>
+  void blit_rotated(Region &region, int dst_cx, int dst_cy, float angle_rad,
+                    float src_cx = NAN, float src_cy = NAN) const {
+    if (std::isnan(src_cx))
+      src_cx = desc->pivot_x;
+    if (std::isnan(src_cy))
+      src_cy = desc->pivot_y;
+    gfx::rotozoom::draw<format>(region, surface(), dst_cx, dst_cy, angle_rad,
+                                1.0f, src_cx - desc->trim_x,
+                                src_cy - desc->trim_y, atlas->premultiplied);
+  }
+
+private:
+  const Atlas *atlas;
+  const SpriteDesc *desc;
+};
+
+// A sprite pre-rotated at build time to evenly spaced directions, each
+// around the pivot, direction 0 being the image as drawn. Picking the nearest
+// direction replaces the per-pixel math of Texture<>::blit_rotated() by a
+// plain blend blit.
+class RotatedSprite {
+public:
+  constexpr RotatedSprite(const SpriteRef *directions, u32 num_directions)
+      : directions(directions), num_directions(num_directions) {}
+
+  u32 get_num_directions() const { return num_directions; }
+
+  // The direction nearest to angle_rad, clockwise on screen like
+  // Texture<>::blit_rotated()
+  const SpriteRef &at(float angle_rad) const {
+    float turns = angle_rad * (0.5f / static_cast<float>(M_PI));
+    i32 index = static_cast<i32>(std::floor(turns * num_directions + 0.5f));
+    index %= static_cast<i32>(num_directions);
+    if (index < 0)
+      index += num_directions;
+    return directions[index];
+  }
+
+  // Blends the sprite rotated by angle_rad with its pivot at (x, y)
+  void blit(const Surface &region, i32 x, i32 y, float angle_rad,
+            u8 alpha = 0xFF) const {
+    at(angle_rad).blit_at_pivot(region, x, y, alpha);
+  }
+
+private:
+  const SpriteRef *directions;
+  u32 num_directions;
+};
+
+} // namespace ge
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "ge-app/arrayvec.hpp"
+#include "ge-app/font.hpp"
+
+namespace ge {
+
+// The line breaks and glyph positions of a string in a font, wrapped the way
+// Font::render() does it, so that text shown every frame is not re-measured
+// and re-wrapped every frame.
+class TextLayout {
+public:
+  static constexpr u32 MAX_GLYPHS = 192;
+
+  struct Glyph {
+    i16 x, y;   // relative to the top-left corner of the text
+    u16 source; // index of the character in the string
+    char ch;
+  };
+
+  // Lays out text in a width x height box, false if it has more than
+  // MAX_GLYPHS glyphs
+  bool compute(const Font &font, const char *text, int width, int height);
+
+  // The layout of text in a width x height box, from a small LRU cache keyed
+  // by font, box and string, its address and its contents. nullptr for texts
+  // that do not fit in a TextLayout or are too long to cache, callers fall
+  // back to Font::render() then. The layout stays valid until the next call.
+  static const TextLayout *cached(const Font &font, const char *text,
+                                  int width, int height);
+
+  // Same as Font::render() at (x0, y0) in the box the text was laid out in,
+  // for the first max_len characters of the string
+  template <class ColorCallback>
+  void render(Surface region, int x0, int y0, ColorCallback cb,
+              u32 max_len = -1) const {
+    bool drawn = visit(region, [&](auto fb) {
+      render_typed(fb, x0, y0, cb, max_len);
+    });
+    if (!drawn)
+      std::printf("Unsupported pixel format for text\r\n");
+  }
+
+  void render_colored(Surface region, int x0, int y0, std::uint16_t color,
+                      u32 max_len = -1) const {
+    if (font->glyph_coverage)
+      render(region, x0, y0, Font::coverage_color(color), max_len);
+    else
+      render(region, x0, y0, Font::SolidColor{color}, max_len);
+  }
+
+  // Number of characters in the string, laid out or not
+  u32 length() const { return text_length; }
+  // Size of the box the glyphs take
+  int get_width() const { return extent_w; }
+  int get_height() const { return extent_h; }
+
+private:
+  template <PixelFormat format, class ColorCallback>
+  void render_typed(TypedSurface<format> fb, int x0, int y0,
+                    const ColorCallback &cb, u32 max_len) const {
+    const int max_x = fb.get_width(), max_y = fb.get_height();
+    if (Font::drawn_by_cpu<ColorCallback>())
+      hal::gpu::wait_idle();
+    // bounding box of the glyphs drawn, for hal::damage
+    int min_x = max_x, min_y = max_y, end_x = 0, end_y = 0;
+    const int glyph_w = font->glyph_width, glyph_h = font->glyph_height;
+    // glyphs are in string order, progressive reveal stops early
+    for (const auto &g : glyphs) {
+      if (g.source >= max_len)
+        break;
+      const int x = x0 + g.x, y = y0 + g.y;
+      min_x = std::min(min_x, x);
+      min_y = std::min(min_y, y);
+      end_x = std::max(end_x, x + glyph_w);
+      end_y = std::max(end_y, y + glyph_h);
+      font->draw_glyph(fb, g.ch, x, y, cb);
+    }
+
+    min_x = std::max(min_x, 0);
+    min_y = std::max(min_y, 0);
+    end_x = std::min(end_x, max_x);
+    end_y = std::min(end_y, max_y);
+    if (min_x < end_x && min_y < end_y)
+      hal::damage::mark(
+          fb.untyped().subsurface(min_x, min_y, end_x - min_x, end_y - min_y));
+  }
+
+  const Font *font = nullptr;
+  ArrayVec<Glyph, MAX_GLYPHS> glyphs;
+  u32 text_length = 0;
+  int extent_w = 0, extent_h = 0;
+};
+
+} // namespace ge
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "ge-app/gfx/rotozoom.hpp"
 #include "ge-hal/gpu.hpp"
+#include "ge-hal/pixel.hpp"
 #include "ge-hal/surface.hpp"
 #include <algorithm>
 #include <cmath>
@@ -8,19 +10,7 @@
 
 namespace ge {
 
-namespace detail {
-template <usize N> struct uintN {};
-
-template <> struct uintN<16> {
-  using type = u16;
-};
-template <> struct uintN<32> {
-  using type = u32;
-};
-} // namespace detail
-
-template <PixelFormat format,
-          class DType = typename detail::uintN<pixel_format_bpp(format)>::type>
+template <PixelFormat format, class DType = pixel::type_t<format>>
 class Texture : public ConstSurface {
 public:
   Texture(const DType *color_data, u32 width, u32 height,
@@ -30,6 +20,11 @@ public:
     assert(ctor_format == format);
   }
 
+  // A view of part of another surface, e.g. a sprite on an atlas page
+  explicit Texture(const ConstSurface &surface) : ConstSurface{surface} {
+    assert(surface.get_pixel_format() == format);
+  }
+
   void blit(const Surface &region) {
     hal::gpu::blit_blend(region, *this, 0xFF);
   }
@@ -38,83 +33,26 @@ public:
     hal::gpu::blit_blend(region, *this, alpha);
   }
 
+  // Blends the texture rotated clockwise by angle_rad around the source point
+  // (src_cx, src_cy) (its center by default), which lands on the destination
+  // pixel (dst_cx, dst_cy)
   template <class Region>
-  void blit_rotated(
-      Region &region, int dst_cx,
-      int dst_cy,      // destination center (screen coords)
-      float angle_rad, // clockwise or CCW, your choice, just be consistent
-      float src_cx = NAN, float src_cy = NAN) {
-    const int W = region.get_width();
-    const int H = region.get_height();
-
-    // Precompute sin/cos
-    float c = std::cos(angle_rad);
-    float s = std::sin(angle_rad);
-
-    // Sprite center in source space
+  void blit_rotated(Region &region, int dst_cx, int dst_cy, float angle_rad,
+                    float src_cx = NAN, float src_cy = NAN) const {
+    blit_rotozoom(region, dst_cx, dst_cy, angle_rad, 1.0f, src_cx, src_cy);
+  }
+
+  // Same, also scaled by scale
+  template <class Region>
+  void blit_rotozoom(Region &region, int dst_cx, int dst_cy, float angle_rad,
+                     float scale, float src_cx = NAN,
+                     float src_cy = NAN) const {
     if (std::isnan(src_cx))
       src_cx = (get_width() - 1) * 0.5f;
     if (std::isnan(src_cy))
       src_cy = (get_height() - 1) * 0.5f;
-
-    // Compute conservative bounding box radius
-    float hw = get_width() * 0.5f;
-    float hh = get_height() * 0.5f;
-    float r = std::sqrt(hw * hw + hh * hh);
-
-    int x0 = std::max(0, (int)std::floor(dst_cx - r));
-    int x1 = std::min(W - 1, (int)std::ceil(dst_cx + r));
-    int y0 = std::max(0, (int)std::floor(dst_cy - r));
-    int y1 = std::min(H - 1, (int)std::ceil(dst_cy + r));
-
-    // For each destination pixel, map back into source via inverse rotation
-    // Inverse rotation matrix for [c -s; s c] is [c s; -s c]
-    for (int y = y0; y <= y1; ++y) {
-      float dy = (float)y - (float)dst_cy;
-      for (int x = x0; x <= x1; ++x) {
-        float dx = (float)x - (float)dst_cx;
-
-        float u = c * dx + s * dy + src_cx;
-        float v = -s * dx + c * dy + src_cy;
-
-        int sx = (int)std::lround(u);
-        int sy = (int)std::lround(v);
-
-        if ((unsigned)sx < (unsigned)get_width() &&
-            (unsigned)sy < (unsigned)get_height()) {
-          auto col = *static_cast<const DType *>(pixel_at(sx, sy));
-          if (!has_alpha_channel(format)) {
-            region.set_pixel(x, y, col);
-          } else if (format == PixelFormat::ARGB1555) {
-            if (col & 0x8000U) {
-              region.set_pixel(x, y, col);
-            }
-          } else if (format == PixelFormat::ARGB8888 &&
-                     region.get_pixel_format() == PixelFormat::RGB565) {
-            // for the time being we only support ARGB8888 -> RGB565 blit with
-            // alpha
-            auto src_color = region.get_pixel(x, y);
-            u8 src_r = (src_color >> 11) & 0x1F;
-            u8 src_g = (src_color >> 5) & 0x3F;
-            u8 src_b = src_color & 0x1F;
-            u8 dst_a = (col >> 24) & 0xFF;
-            u8 dst_r = (col >> 16) & 0xFF;
-            u8 dst_g = (col >> 8) & 0xFF;
-            u8 dst_b = col & 0xFF;
-            // Alpha blend
-            u8 out_r = (dst_r * dst_a + (src_r << 3) * (255 - dst_a)) / 255;
-            u8 out_g = (dst_g * dst_a + (src_g << 2) * (255 - dst_a)) / 255;
-            u8 out_b = (dst_b * dst_a + (src_b << 3) * (255 - dst_a)) / 255;
-            u16 out_color =
-                ((out_r >> 3) << 11) | ((out_g >> 2) << 5) | (out_b >> 3);
-            region.set_pixel(x, y, out_color);
-          } else {
-            std::printf("Unsupported format for blit_rotated with alpha\r\n");
-            return;
-          }
-        }
-      }
-    }
+    gfx::rotozoom::draw<format>(region, *this, dst_cx, dst_cy, angle_rad,
+                                scale, src_cx, src_cy);
   }
 };
 
@@ -122,6 +60,39 @@ using TextureRGB565 = Texture<PixelFormat::RGB565>;
 using TextureARGB1555 = Texture<PixelFormat::ARGB1555>;
 using TextureARGB8888 = Texture<PixelFormat::ARGB8888>;
 
+// An L8 or L4 texture and its ARGB8888 palette, from the indexed modes of
+// bin2c_image.py. Drawing loads the palette first, which costs nothing when
+// it is already loaded.
+class IndexedTexture : public ConstSurface {
+public:
+  IndexedTexture(const u8 *indices, u32 width, u32 height, PixelFormat format,
+                 const u32 *palette, u32 palette_size)
+      : ConstSurface{indices, width, width, height, format}, palette(palette),
+        palette_size(palette_size) {
+    assert(format == PixelFormat::L8 || format == PixelFormat::L4);
+  }
+
+  void load_palette() const { hal::gpu::load_palette(palette, palette_size); }
+
+  // Copies the part of the texture at (x, y) to region, alpha ignored. For
+  // L4, x + y * width must be even.
+  void blit(const Surface &region, u32 x = 0, u32 y = 0) const {
+    load_palette();
+    hal::gpu::blit_indexed(
+        region, subsurface(x, y, region.get_width(), region.get_height()));
+  }
+
+  // Blends the texture with the palette alpha times alpha
+  void blit_blend(const Surface &region, u8 alpha = 0xFF) const {
+    load_palette();
+    hal::gpu::blit_blend(region, *this, alpha);
+  }
+
+private:
+  const u32 *palette;
+  u32 palette_size;
+};
+
 inline bool clip_blit_rect(i32 fb_w, i32 fb_h, i32 &dst_x, i32 &dst_y,
                            i32 &src_x, i32 &src_y, i32 &w, i32 &h) {
   // Clip left
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "ge-app/font.hpp"
+#include "ge-hal/core.hpp"
+#include "ge-hal/gpu.hpp"
+#include "ge-hal/profiler.hpp"
+#include "ge-hal/surface.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace ge {
+namespace ui {
+
+// hal::profiler numbers drawn over the top of the screen: the frame time,
+// then the most expensive zones by average time per frame
+class ProfilerOverlay {
+public:
+  static constexpr u32 MAX_ROWS = 12;
+
+  void render(Surface &fb) {
+    namespace profiler = hal::profiler;
+    const auto &font = Font::regular_font();
+    const u32 lh = font.line_height();
+
+    u32 count = 0;
+    profiler::ZoneStats frame{};
+    for (u32 i = 0; i < profiler::zone_count(); ++i) {
+      auto s = profiler::zone_stats(i);
+      if (s.category == profiler::Category::Frame)
+        frame = s;
+      else if (s.samples > 0)
+        stats[count++] = s;
+    }
+    std::sort(stats, stats + count,
+              [](const profiler::ZoneStats &a, const profiler::ZoneStats &b) {
+                return a.avg_us > b.avg_us;
+              });
+    count = std::min<u32>(count, u32{MAX_ROWS});
+
+    auto box = fb.subsurface(0, 0, fb.get_width(), (count + 2) * lh + 4);
+    hal::gpu::fill(box, 0x0000);
+
+    char buf[48];
+    std::snprintf(buf, sizeof(buf), "frame %u.%02u ms  p99 %u.%02u ms",
+                  static_cast<unsigned>(frame.avg_us / 1000),
+                  static_cast<unsigned>(frame.avg_us % 1000 / 10),
+                  static_cast<unsigned>(frame.p99_us / 1000),
+                  static_cast<unsigned>(frame.p99_us % 1000 / 10));
+    font.render_colored(buf, -1, box, 2, 2, 0xFFE0);
+    render_row(box, 2 + lh, "zone (us)", "avg", "p99", "max", 0x07FF);
+
+    for (u32 i = 0; i < count; ++i) {
+      const auto &s = stats[i];
+      char name[24], avg[8], p99[8], max[8];
+      // the same scene shows up once per category
+      std::snprintf(name, sizeof(name), "%c %s", category_tag(s.category),
+                    s.name);
+      std::snprintf(avg, sizeof(avg), "%u", static_cast<unsigned>(s.avg_us));
+      std::snprintf(p99, sizeof(p99), "%u", static_cast<unsigned>(s.p99_us));
+      std::snprintf(max, sizeof(max), "%u", static_cast<unsigned>(s.max_us));
+      render_row(box, 2 + (i + 2) * lh, name, avg, p99, max, 0xFFFF);
+    }
+  }
+
+private:
+  static char category_tag(hal::profiler::Category category) {
+    switch (category) {
+    case hal::profiler::Category::Tick:
+      return 'T';
+    case hal::profiler::Category::Render:
+      return 'R';
+    case hal::profiler::Category::Gpu:
+      return 'G';
+    default:
+      return ' ';
+    }
+  }
+
+  // name on the left, numbers right-aligned in three columns
+  static void render_row(Surface &box, u32 y, const char *name,
+                         const char *avg, const char *p99, const char *max,
+                         u16 color) {
+    const auto &font = Font::regular_font();
+    const int right[] = {static_cast<int>(box.get_width()) - 82,
+                         static_cast<int>(box.get_width()) - 42,
+                         static_cast<int>(box.get_width()) - 2};
+    const char *cols[] = {avg, p99, max};
+    // names longer than the first column are cut
+    u32 name_len = (right[0] - 34) / font.default_advance();
+    font.render_colored(name, name_len, box, 2, y, color);
+    for (int i = 0; i < 3; ++i) {
+      int x = right[i] - static_cast<int>(font.text_width(cols[i], -1));
+      font.render_colored(cols[i], -1, box, x, y, color);
+    }
+  }
+
+  hal::profiler::ZoneStats stats[hal::profiler::MAX_ZONES];
+};
+
+} // namespace ui
+} // namespace ge
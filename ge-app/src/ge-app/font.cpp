@@ -12,7 +12,11 @@ const Font &Font::regular_font() {
                    font_pixeloid_9px_FIRST_CHAR,
                    font_pixeloid_9px_LAST_CHAR,
                    font_pixeloid_9px_BYTES_PER_ROW,
-                   font_pixeloid_9px_ADVANCES};
+                   font_pixeloid_9px_ADVANCES,
+                   font_pixeloid_9px_SPANS,
+                   font_pixeloid_9px_SPAN_OFFSETS,
+                   font_pixeloid_9px_COVERAGE,
+                   font_pixeloid_9px_COVERAGE_BPP};
   return font;
 }
 
@@ -23,7 +27,11 @@ const Font &Font::bold_font() {
                    font_pixeloid_9px_bold_FIRST_CHAR,
                    font_pixeloid_9px_bold_LAST_CHAR,
                    font_pixeloid_9px_bold_BYTES_PER_ROW,
-                   font_pixeloid_9px_bold_ADVANCES};
+                   font_pixeloid_9px_bold_ADVANCES,
+                   font_pixeloid_9px_bold_SPANS,
+                   font_pixeloid_9px_bold_SPAN_OFFSETS,
+                   font_pixeloid_9px_bold_COVERAGE,
+                   font_pixeloid_9px_bold_COVERAGE_BPP};
   return font;
 }
 
@@ -34,7 +42,11 @@ const Font &Font::big_font() {
                    font_pixeloid_18px_FIRST_CHAR,
                    font_pixeloid_18px_LAST_CHAR,
                    font_pixeloid_18px_BYTES_PER_ROW,
-                   font_pixeloid_18px_ADVANCES};
+                   font_pixeloid_18px_ADVANCES,
+                   font_pixeloid_18px_SPANS,
+                   font_pixeloid_18px_SPAN_OFFSETS,
+                   font_pixeloid_18px_COVERAGE,
+                   font_pixeloid_18px_COVERAGE_BPP};
   return font;
 }
 
@@ -1,6 +1,7 @@
 #include "ge-app/game/sky.hpp"
-#include "assets/out/textures/moon.h"
-#include "assets/out/textures/sun.h"
+#include "assets/out/textures/sprites.h"
+#include "ge-app/gfx/cached_layer.hpp"
+#include "ge-hal/pixel.hpp"
 
 namespace ge {
 
@@ -112,15 +113,57 @@ inline u16 cloud_from_sky(u16 sky, float t) {
   return c;
 }
 
-Sky::Sky()
-    : sun_texture{sun, sun_WIDTH, sun_HEIGHT, sun_FORMAT_CPP},
-      moon_texture{moon, moon_WIDTH, moon_HEIGHT, moon_FORMAT_CPP} {}
+Sky::Sky() {}
+
+// in SDRAM on the STM32, like the cached layers
+GE_LAYER_STORAGE u8 Sky::strip_memory[STRIP_WIDTH * CLOUD_TEXTURE_HEIGHT];
+bool Sky::strip_decoded = false;
+u32 Sky::palettes[2][PALETTE_SIZE];
+u32 Sky::palette_index = 0;
+u16 Sky::palette_sky = 0, Sky::palette_cloud = 0;
+bool Sky::palette_valid = false;
 
 u8 Sky::luminance_at_time(float t) {
   u16 sc = sky_color(t);
   return luminance565(sc);
 }
 
+void Sky::decode_strip() {
+  for (u32 y = 0; y < CLOUD_TEXTURE_HEIGHT; ++y) {
+    u8 *row = strip_memory + y * STRIP_WIDTH;
+    const u8 *row_rle = &bg_clouds[CLOUD_ROW_OFFSETS[y]];
+    for (u32 x = 0; x < CLOUD_TEXTURE_WIDTH;) {
+      u8 elem = *row_rle++;
+      u32 len = elem >> 4;
+      len = (len < 0xF) ? (len + 1) : *row_rle++;
+      len = std::min<u32>(len, CLOUD_TEXTURE_WIDTH - x);
+      std::memset(row + x, CLOUD_COLORS[elem & 0x0F], len);
+      x += len;
+    }
+    // wrap around
+    std::memcpy(row + CLOUD_TEXTURE_WIDTH, row,
+                STRIP_WIDTH - CLOUD_TEXTURE_WIDTH);
+  }
+  strip_decoded = true;
+}
+
+void Sky::recolor(u16 sky_color, u16 cloud_color) {
+  if (palette_valid && sky_color == palette_sky &&
+      cloud_color == palette_cloud)
+    return;
+
+  palette_index ^= 1;
+  auto &palette = palettes[palette_index];
+  for (u8 opacity : CLOUD_COLORS) {
+    palette[opacity] = pixel::convert<PixelFormat::ARGB8888,
+                                      PixelFormat::RGB565>(
+        blend_rgb565(sky_color, cloud_color, opacity));
+  }
+  palette_sky = sky_color;
+  palette_cloud = cloud_color;
+  palette_valid = true;
+}
+
 void Sky::render(App &app, Surface render_region, Clock &clock) {
   auto x_offset = clock.get_game_timer().get(app) / 1000 % CLOUD_TEXTURE_WIDTH;
   auto sky_color = ::ge::sky_color(clock.time_in_day(app));
@@ -128,108 +171,57 @@ void Sky::render(App &app, Surface render_region, Clock &clock) {
 
   const int W = render_region.get_width();
   const int H = render_region.get_height();
-  const int TEX_W = CLOUD_TEXTURE_WIDTH;
-  auto fb = render_region;
+  assert(H == 80);
+  assert(u32(W) <= STRIP_WIDTH - CLOUD_TEXTURE_WIDTH);
+
+  if (!strip_decoded)
+    decode_strip();
+  recolor(sky_color, cloud_color);
 
   // Fill sky upper region
   hal::gpu::fill(render_region.subsurface(0, 0, W, H - CLOUD_TEXTURE_HEIGHT),
                  sky_color);
 
-  // temporary: recalculate cloud LUT every frame
-  for (usize i = 0; i < sizeof(CLOUD_COLORS) / sizeof(CLOUD_COLORS[0]); ++i) {
-    cloud_lut[i] = blend_rgb565(sky_color, cloud_color, CLOUD_COLORS[i]);
-  }
-
-  assert(H == 80);
-  int stride = bg_clouds_len / H;
+  // then the clouds over a plain sky, one indexed copy
+  ConstSurface strip{strip_memory, STRIP_WIDTH, STRIP_WIDTH,
+                     CLOUD_TEXTURE_HEIGHT, PixelFormat::L8};
+  hal::gpu::load_palette(palettes[palette_index], PALETTE_SIZE);
+  hal::gpu::blit_indexed(
+      render_region.subsurface(0, H - CLOUD_TEXTURE_HEIGHT, W,
+                               CLOUD_TEXTURE_HEIGHT),
+      strip.subsurface(x_offset, 0, W, CLOUD_TEXTURE_HEIGHT));
 
-  auto sun = render_celestial_object(sun_texture, render_region,
+  auto sun = render_celestial_object(atlas::sprites::sun, render_region,
                                      clock.time_in_day(app), sky_color);
-  bool sun_visible = (sun.w > 0 && sun.h > 0);
+  occlude(render_region, x_offset, sun, cloud_color);
   auto moon = render_celestial_object(
-      moon_texture, render_region,
+      atlas::sprites::moon, render_region,
       std::fmod(clock.time_in_day(app) + 0.5f, 1.0f), sky_color);
-  bool moon_visible = (moon.w > 0 && moon.h > 0);
-
-  for (i32 dy = 0; dy < CLOUD_TEXTURE_HEIGHT; ++dy) {
-    const u8 *row_rle = &bg_clouds[CLOUD_ROW_OFFSETS[dy]];
-    i32 tex_x = 0;
-
-    auto y = dy + H - CLOUD_TEXTURE_HEIGHT;
-    const bool sun_row = sun_visible && (y >= sun.y && y < sun.y + sun.h);
-
-    while (true) {
-      u8 elem = *row_rle++;
-      i32 len = elem >> 4;
-      i32 value = elem & 0x0F;
-      len = (len < 0xF) ? (len + 1) : *row_rle++;
+  occlude(render_region, x_offset, moon, cloud_color);
+}
 
-      i32 run_start = tex_x;
-      tex_x += len;
-
-      // map texture X → screen X with wrap
-      i32 sx = run_start - x_offset;
-      if (sx < 0)
-        sx += TEX_W;
-
-      auto draw_span = [&](i32 dx, i32 span_len) {
-        if (span_len <= 0 || dx >= W)
-          return;
-
-        span_len = std::min(span_len, W - dx);
-
-        auto overlaps = [&](const Sky::Rect &r) {
-          return r.w > 0 && y >= r.y && y < r.y + r.h &&
-                 !(dx + span_len <= r.x || dx >= r.x + r.w);
-        };
-
-        bool sun_hit = sun_visible && overlaps(sun);
-        bool moon_hit = moon_visible && overlaps(moon);
-
-        // fast path: no celestial overlap at all
-        if (!sun_hit && !moon_hit) {
-          hal::gpu::fill(fb.subsurface(dx, y, span_len, 1), cloud_lut[value]);
-          return;
-        }
-
-        // slow path: per-pixel blend where needed
-        for (i32 x = dx; x < dx + span_len; ++x) {
-          u16 out = cloud_lut[value];
-
-          // sun already drawn into framebuffer
-          if (sun_visible && x >= sun.x && x < sun.x + sun.w && y >= sun.y &&
-              y < sun.y + sun.h) {
-            u16 bg = fb.get_pixel(x, y);
-            out = blend_rgb565(bg, cloud_color, CLOUD_COLORS[value]);
-          }
-
-          // moon already drawn into framebuffer
-          if (moon_visible && x >= moon.x && x < moon.x + moon.w &&
-              y >= moon.y && y < moon.y + moon.h) {
-            u16 bg = fb.get_pixel(x, y);
-            out = blend_rgb565(bg, cloud_color, CLOUD_COLORS[value]);
-          }
-
-          fb.set_pixel(x, y, out);
-        }
-      };
-
-      // normal span
-      if (sx < W)
-        draw_span(sx, len);
-
-      // wrapped span
-      if (sx + len > TEX_W)
-        draw_span(0, (sx + len) - TEX_W);
-
-      if (tex_x >= TEX_W)
-        break;
-    }
-  }
+void Sky::occlude(Surface render_region, u32 x_offset, const Rect &r,
+                  u16 cloud_color) {
+  const i32 band_y = render_region.get_height() - CLOUD_TEXTURE_HEIGHT;
+  const i32 y0 = std::max(r.y, band_y);
+  const i32 y1 = std::min(r.y + r.h, band_y + CLOUD_TEXTURE_HEIGHT);
+  if (r.w <= 0 || y0 >= y1)
+    return;
+
+  // the strip pixels are the cloud opacities, i.e. an A8 coverage
+  ConstSurface coverage{strip_memory, STRIP_WIDTH, STRIP_WIDTH,
+                        CLOUD_TEXTURE_HEIGHT, PixelFormat::A8};
+  u32 rgb888 =
+      pixel::convert<PixelFormat::ARGB8888, PixelFormat::RGB565>(cloud_color) &
+      0xFFFFFF;
+  hal::gpu::blit_blend_alpha(
+      render_region.subsurface(r.x, y0, r.w, y1 - y0),
+      coverage.subsurface(x_offset + r.x, y0 - band_y, r.w, y1 - y0), rgb888,
+      0xFF);
 }
 
-Sky::Rect Sky::render_celestial_object(const TextureARGB8888 &texture,
-                                       Surface fb, float t, u16 sky_color) {
+Sky::Rect Sky::render_celestial_object(const SpriteRef &sprite, Surface fb,
+                                       float t, u16 sky_color) {
   constexpr float SUNRISE = 0.25f;
   constexpr float SUNSET = 0.75f;
 
@@ -241,32 +233,30 @@ Sky::Rect Sky::render_celestial_object(const TextureARGB8888 &texture,
   const i32 W = fb.get_width();
   const i32 H = fb.get_height();
 
-  const i32 SUN_W = texture.get_width();
-  const i32 SUN_H = texture.get_height();
+  const i32 SUN_W = sprite.get_width();
+  const i32 SUN_H = sprite.get_height();
 
   // --- center-based position ---
   i32 cx = i32(day_t * (W + SUN_W)) - SUN_W / 2;
   i32 cy = i32((H - 12) - std::sin(day_t * M_PI) * (H - 22));
 
-  // --- top-left ---
-  i32 dst_x = cx - SUN_W / 2;
-  i32 dst_y = cy - SUN_H / 2;
+  // --- top-left of the opaque part ---
+  const auto &desc = sprite.get_desc();
+  i32 dst_x = cx - SUN_W / 2 + desc.trim_x;
+  i32 dst_y = cy - SUN_H / 2 + desc.trim_y;
 
   i32 src_x = 0;
   i32 src_y = 0;
-  i32 draw_w = SUN_W;
-  i32 draw_h = SUN_H;
+  i32 draw_w = desc.w;
+  i32 draw_h = desc.h;
 
   if (!clip_blit_rect(W, H, dst_x, dst_y, src_x, src_y, draw_w, draw_h))
     return {0, 0, 0, 0};
 
-  auto src =
-      texture.subsurface(u32(src_x), u32(src_y), u32(draw_w), u32(draw_h));
-
   auto dst = fb.subsurface(u32(dst_x), u32(dst_y), u32(draw_w), u32(draw_h));
 
   hal::gpu::fill(dst, sky_color);
-  hal::gpu::blit_blend(dst, src, 0xFF);
+  sprite.blit(fb, cx - SUN_W / 2, cy - SUN_H / 2);
 
   return {dst_x, dst_y, draw_w, draw_h};
 }
@@ -1,5 +1,89 @@
 #include "ge-app/game/water.hpp"
+#include "ge-app/gfx/cached_layer.hpp"
+#include "ge-hal/damage.hpp"
+#include "ge-hal/typed_surface.hpp"
 
 namespace ge {
-u16 Water::row_memory[App::WIDTH * water_texture_HEIGHT] = {0};
+namespace {
+constexpr bool is_power_of_two(u32 n) { return n && !(n & (n - 1)); }
+} // namespace
+
+// render_perspective() wraps texel coordinates with masks
+static_assert(is_power_of_two(water_texture_FRAME_WIDTH) &&
+                  is_power_of_two(water_texture_HEIGHT),
+              "the water pattern has to be a power of two in size");
+
+Water::Strip Water::strips[STRIP_CACHE_SIZE];
+// in SDRAM on the STM32, like the cached layers
+GE_LAYER_STORAGE u16 Water::strip_memory[STRIP_CACHE_SIZE]
+                                        [STRIP_WIDTH * water_texture_HEIGHT];
+u32 Water::strip_clock = 0;
+
+ConstSurface Water::strip_for(u32 frame_index, u32 luminance) {
+  const u32 pw = pattern_width();
+  const u32 ph = pattern_height();
+
+  u32 victim = 0;
+  for (u32 i = 0; i < STRIP_CACHE_SIZE; ++i) {
+    auto &strip = strips[i];
+    if (strip.valid && strip.frame_index == frame_index &&
+        strip.luminance == luminance) {
+      strip.last_used = ++strip_clock;
+      return ConstSurface{strip_memory[i], STRIP_WIDTH, STRIP_WIDTH, ph};
+    }
+    if (strips[victim].valid &&
+        (!strip.valid || strip.last_used < strips[victim].last_used))
+      victim = i;
+  }
+
+  Surface strip_surface{strip_memory[victim], STRIP_WIDTH, STRIP_WIDTH, ph};
+  auto tile = strip_surface.subsurface(0, 0, pw, ph);
+
+  // The frame blended over black at the sky luminance
+  hal::gpu::fill(tile, 0x0000);
+  hal::gpu::blit_blend(tile,
+                       water_pattern.subsurface(pw * frame_index, 0, pw, ph),
+                       luminance);
+
+  // then repeated over the rest of the strip
+  for (u32 x = pw; x < STRIP_WIDTH; x += pw) {
+    hal::gpu::blit(strip_surface.subsurface(x, 0, STRIP_WIDTH - x, ph),
+                   tile.as_const());
+  }
+
+  strips[victim] = Strip{frame_index, luminance, ++strip_clock, true};
+  return strip_surface.as_const();
+}
+
+void Water::render_perspective(App *app, Surface region, float time,
+                               const PerspectiveMapping &perspective,
+                               u32 x_offset, u32 y_offset) {
+  const u32 pw = pattern_width();
+  const u32 ph = pattern_height();
+  assert(region.get_width() == perspective.get_width() &&
+         region.get_height() == perspective.get_height());
+  assert(region.get_pixel_format() == PixelFormat::RGB565);
+
+  // the first tile of the strip is the shaded frame
+  ConstTypedSurface<PixelFormat::RGB565> tile{
+      strip_for(frame_index_at(app), luminance_at(time))};
+  hal::gpu::wait_idle();
+
+  TypedSurface<PixelFormat::RGB565> fb{region};
+  const u32 w = fb.get_width();
+  // texel coordinates of the boat, as render() places the pattern
+  const u32 u_boat = (w / 2 + x_offset) << 16;
+  const u32 v_boat = fb.get_height() / 2 - y_offset;
+  for (u32 y = fb.get_row_begin(); y < fb.get_row_end(); ++y) {
+    const auto &r = perspective.row(y);
+    const u16 *texels = tile.row((v_boat - r.depth) & (ph - 1)).begin();
+    const u32 step = r.u_step;
+    u32 u = u_boat + r.u_origin;
+    for (u16 &px : fb.row(y)) {
+      px = texels[(u >> 16) & (pw - 1)];
+      u += step;
+    }
+  }
+  hal::damage::mark(region);
 }
+} // namespace ge
@@ -1,12 +1,11 @@
 #include "ge-app/rng.hpp"
+#include "ge-hal/replay.hpp"
 
-#ifdef GE_HAL_PC
+#if defined(GE_HAL_PC)
 #include <random>
-#else
-#ifdef GE_HAL_STM32
+#elif defined(GE_HAL_STM32)
 #include "ge-hal/stm/rng.hpp"
 #endif
-#endif
 
 namespace ge {
 PCG32 &PCG32::instance() {
@@ -16,13 +15,23 @@ PCG32 &PCG32::instance() {
 
 namespace rng {
 void init_seed() {
-  u32 seed = 0;
-#ifdef GE_HAL_PC
+  u64 seed = 0;
+  if (hal::replay::replayed_seed(seed)) {
+    PCG32::instance().seed(seed);
+    return;
+  }
+
+#if defined(GE_HAL_PC)
   seed = std::random_device{}(); // get OS RNG seed
-#else
+#elif defined(GE_HAL_STM32)
   hal::stm::init_rng();
   seed = hal::stm::rng_read();
+#else
+  // headless uses a fixed seed, so that runs are reproducible
+  seed = PCG32{}.state;
 #endif
+  PCG32::instance().seed(seed);
+  hal::replay::record_seed(seed);
 }
 } // namespace rng
 } // namespace ge
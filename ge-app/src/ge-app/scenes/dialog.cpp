@@ -1,13 +1,30 @@
 #include "ge-app/scenes/dialog.hpp"
 #include "ge-app/font.hpp"
 #include "ge-app/scenes/main.hpp"
+#include "ge-app/text_layout.hpp"
 #include "ge-hal/gpu.hpp"
 
+#include <algorithm>
 #include <cstring>
 
 namespace ge {
 namespace scenes {
 
+namespace {
+
+// Dialog text is laid out once and drawn from the layout cache every frame
+void render_text(const Font &font, const char *text, u32 max_len,
+                 Surface region) {
+  const auto *layout = TextLayout::cached(font, text, region.get_width(),
+                                          region.get_height());
+  if (layout)
+    layout->render_colored(region, 0, 0, 0xFFFF, max_len);
+  else
+    font.render_colored(text, max_len, region, 0, 0, 0xFFFF);
+}
+
+} // namespace
+
 DialogScene::DialogScene(RootScene &parent)
     : Scene(parent.get_app()), parent{parent}, start_time(0), ms_per_char(50) {}
 
@@ -27,14 +44,15 @@ void DialogScene::render(Surface &fb_region) {
                              region.get_height() - PADDING * 2);
 
   const auto &bold_font = Font::bold_font();
-  bold_font.render_colored(msg.title, -1, region, 0, 0, 0xFFFF);
+  render_text(bold_font, msg.title, -1, region);
 
   region = region.subsurface(0, bold_font.line_height(), region.get_width(),
                              region.get_height() - bold_font.line_height());
 
-  u32 num_chars = (app.now() - start_time) / ms_per_char;
-  Font::regular_font().render_colored(msg.desc, num_chars, region, 0, 0,
-                                      0xFFFF);
+  // the typewriter effect only moves the end of the laid out text
+  i64 num_chars = (app.now() - start_time) / ms_per_char;
+  render_text(Font::regular_font(), msg.desc,
+              static_cast<u32>(std::min<i64>(num_chars, desc_length)), region);
 }
 
 bool DialogScene::on_button_clicked(Button btn) {
@@ -58,12 +76,13 @@ void DialogScene::set_start_time(i64 time) { start_time = time; }
 
 bool DialogScene::message_complete() {
   return !has_msg ||
-         (app.now() - start_time) / ms_per_char >= std::strlen(msg.desc);
+         (app.now() - start_time) / ms_per_char >= desc_length;
 }
 
 void DialogScene::show_message(const char *title, const char *desc) {
   start_time = app.now();
   msg = {title, desc};
+  desc_length = std::strlen(desc);
   has_msg = true;
 }
 
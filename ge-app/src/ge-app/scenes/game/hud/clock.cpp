@@ -1,5 +1,5 @@
 #include "ge-app/scenes/game/hud/clock.hpp"
-#include "assets/out/textures/sign.h"
+#include "assets/out/textures/sprites.h"
 #include "ge-app/scenes/game/hud/main.hpp"
 #include <cinttypes>
 
@@ -12,16 +12,15 @@ ClockScene::ClockScene(HUDScene &parent)
     : Scene(parent.get_app()), parent(parent) {}
 
 void ClockScene::render(Surface &fb_region) {
-  static TextureARGB8888 sign_texture{sign, sign_WIDTH, sign_HEIGHT,
-                                      sign_FORMAT_CPP};
-  sign_texture.blit(fb_region);
+  const auto &sign = atlas::sprites::sign;
+  sign.blit(fb_region, 0, 0);
 
   auto &clock = parent.get_clock();
   char day[32];
   std::snprintf(day, sizeof day, "Day %" PRIu32, clock.get_num_days(app));
   auto &font = Font::regular_font();
   auto width = font.text_width(day, -1);
-  auto x = (sign_WIDTH - width) / 2;
+  auto x = (sign.get_width() - width) / 2;
   font.render_colored(day, -1, fb_region, x, 20, 0xFFFF);
 
   auto &bold_font = Font::bold_font();
@@ -30,7 +29,7 @@ void ClockScene::render(Surface &fb_region) {
   hr = hr % 12;
   std::snprintf(day, sizeof day, "%02" PRIu32 " %s", hr == 0 ? 12 : hr, ampm);
   width = bold_font.text_width(day, -1);
-  x = (sign_WIDTH - width) / 2;
+  x = (sign.get_width() - width) / 2;
   bold_font.render_colored(day, -1, fb_region, x, 36, 0xFFFF);
 }
 
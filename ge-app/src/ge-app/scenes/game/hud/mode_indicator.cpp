@@ -1,6 +1,6 @@
 #include "ge-app/scenes/game/hud/mode_indicator.hpp"
 
-#include "assets/out/textures/sign.h"
+#include "assets/out/textures/sprites.h"
 #include "ge-app/scenes/game/hud/main.hpp"
 
 namespace ge {
@@ -21,15 +21,15 @@ GameMode ModeIndicatorScene::switch_mode() {
 void ModeIndicatorScene::render(Surface &fbr) {
   // auto mode_indicator_region = fb_region.subsurface(10, 30, 120, 16);
   // indicator.render(mode_indicator_region);
-  static TextureARGB8888 sign_texture{sign, sign_WIDTH, sign_HEIGHT,
-                                      sign_FORMAT_CPP};
-  auto fb_region = fbr.subsurface(sign_WIDTH, 0, sign_WIDTH, sign_HEIGHT);
-  sign_texture.blit(fb_region);
+  const auto &sign = atlas::sprites::sign;
+  auto fb_region = fbr.subsurface(sign.get_width(), 0, sign.get_width(),
+                                  sign.get_height());
+  sign.blit(fb_region, 0, 0);
 
   auto &clock = parent.get_clock();
   auto &font = Font::regular_font();
   auto width = font.text_width("Mode", -1);
-  auto x = (sign_WIDTH - width) / 2;
+  auto x = (sign.get_width() - width) / 2;
   font.render_colored("Mode", -1, fb_region, x, 20, 0xFFFF);
 
   auto bold_font = Font::bold_font();
@@ -49,7 +49,7 @@ void ModeIndicatorScene::render(Surface &fbr) {
     }
   }();
   width = font.text_width(mode_str, -1);
-  x = (sign_WIDTH - width) / 2 - 1;
+  x = (sign.get_width() - width) / 2 - 1;
   font.render_colored(mode_str, -1, fb_region, x, 36, 0xFFFF);
 }
 } // namespace hud
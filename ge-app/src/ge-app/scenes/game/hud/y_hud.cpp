@@ -1,6 +1,6 @@
 #include "ge-app/scenes/game/hud/y_hud.hpp"
 
-#include "assets/out/textures/sign.h"
+#include "assets/out/textures/sprites.h"
 #include "ge-app/scenes/game/hud/main.hpp"
 #include "ge-app/scenes/game/world/main.hpp"
 
@@ -26,15 +26,15 @@ static void format_distance(u32 meters, char *out, size_t out_size) {
 void YHUDScene::render(Surface &fbr) {
   // auto mode_indicator_region = fb_region.subsurface(10, 30, 120, 16);
   // indicator.render(mode_indicator_region);
-  static TextureARGB8888 sign_texture{sign, sign_WIDTH, sign_HEIGHT,
-                                      sign_FORMAT_CPP};
-  auto fb_region = fbr.subsurface(sign_WIDTH * 2, 0, sign_WIDTH, sign_HEIGHT);
-  sign_texture.blit(fb_region);
+  const auto &sign = atlas::sprites::sign;
+  auto fb_region = fbr.subsurface(sign.get_width() * 2, 0, sign.get_width(),
+                                  sign.get_height());
+  sign.blit(fb_region, 0, 0);
 
   auto &clock = parent.get_clock();
   auto &font = Font::regular_font();
   auto width = font.text_width("Current Y", -1);
-  auto x = (sign_WIDTH - width) / 2;
+  auto x = (sign.get_width() - width) / 2;
   font.render_colored("Current Y", -1, fb_region, x, 20, 0xFFFF);
 
   auto bota_y = parent.get_world_scene().get_boat().get_y();
@@ -43,7 +43,7 @@ void YHUDScene::render(Surface &fbr) {
 
   auto bold_font = Font::bold_font();
   width = bold_font.text_width(y_str, -1);
-  x = (sign_WIDTH - width) / 2 - 1;
+  x = (sign.get_width() - width) / 2 - 1;
   bold_font.render_colored(y_str, -1, fb_region, x, 36, 0xFFFF);
 }
 } // namespace hud
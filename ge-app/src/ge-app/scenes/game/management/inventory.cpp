@@ -6,9 +6,13 @@ namespace scenes {
 namespace game {
 namespace mgmt {
 
+namespace {
+GE_LAYER_STORAGE u16 layer_pixels[App::WIDTH * App::HEIGHT];
+} // namespace
+
 InventoryScene::InventoryScene(ManagementUIScene &parent)
     : Scene{parent.get_app()}, parent{parent}, scroll_offset(0),
-      selected_index(0) {}
+      selected_index(0), layer{layer_pixels, App::WIDTH, App::HEIGHT} {}
 
 void InventoryScene::on_back_action() { parent.back_to_menu(); }
 
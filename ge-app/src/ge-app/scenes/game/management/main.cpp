@@ -11,7 +11,8 @@ ManagementUIScene::ManagementUIScene(GameScene &parent)
     : ContainerScene(parent.get_app()), parent{parent}, management_menu{*this},
       status_scene{*this}, inventory_scene{*this}, map_scene{*this},
       bg_texture{bg_management, bg_management_WIDTH, bg_management_HEIGHT,
-                 bg_management_FORMAT_CPP} {
+                 bg_management_FORMAT_CPP, bg_management_palette,
+                 bg_management_PALETTE_SIZE} {
   set_scenes(management_sub_scenes);
 }
 
@@ -54,12 +55,15 @@ bool ManagementUIScene::is_active() const {
   return parent.get_current_mode() == GameMode::Management;
 }
 
+Surface ManagementUIScene::bg_region(Surface &fb) {
+  return fb.subsurface((fb.get_width() - bg_texture.get_width()) / 2,
+                       (fb.get_height() - bg_texture.get_height()) / 2,
+                       bg_texture.get_width(), bg_texture.get_height());
+}
+
 Surface ManagementUIScene::render_bg(Surface &fb) {
-  auto bg_surface =
-      fb.subsurface((fb.get_width() - bg_texture.get_width()) / 2,
-                    (fb.get_height() - bg_texture.get_height()) / 2,
-                    bg_texture.get_width(), bg_texture.get_height());
-  bg_texture.blit(bg_surface);
+  auto bg_surface = bg_region(fb);
+  bg_texture.blit_blend(bg_surface);
   return bg_surface;
 }
 } // namespace game
@@ -1,4 +1,5 @@
 #include "ge-app/scenes/game/management/menu.hpp"
+#include "assets/out/textures/management-bg.h"
 #include "ge-app/scenes/game/management/main.hpp"
 
 namespace ge {
@@ -6,8 +7,15 @@ namespace scenes {
 namespace game {
 namespace mgmt {
 
+namespace {
+GE_LAYER_STORAGE u32
+    layer_pixels[bg_management_WIDTH * bg_management_HEIGHT];
+} // namespace
+
 MenuScene::MenuScene(ManagementUIScene &parent)
-    : Scene{parent.get_app()}, parent{parent} {
+    : Scene{parent.get_app()}, parent{parent},
+      layer{layer_pixels, bg_management_WIDTH, bg_management_HEIGHT,
+            PixelFormat::ARGB8888} {
   menu_items[0] =
       ui::MenuItem{"View Status", static_cast<int>(Action::ViewStatus)};
   menu_items[1] =
@@ -36,7 +44,15 @@ bool MenuScene::is_active() const {
   return parent.is_screen_active(ManagementUIScreen::Menu);
 }
 void MenuScene::render(Surface &fb_region) {
-  auto fb = parent.render_bg(fb_region);
+  auto region = parent.bg_region(fb_region);
+  layer.render(region, menu.get_selected_index(),
+               [&](Surface &s) { draw(s); });
+}
+
+void MenuScene::draw(Surface &layer_surface) {
+  // the corners of the background are transparent
+  hal::gpu::fill(layer_surface, 0);
+  auto fb = parent.render_bg(layer_surface);
 
   // Title
   Font::regular_font().render_colored("Management", -1, fb, 10, 10, 0x0000);
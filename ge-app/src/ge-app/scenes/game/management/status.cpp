@@ -17,10 +17,32 @@ namespace scenes {
 namespace game {
 namespace mgmt {
 
+namespace {
+GE_LAYER_STORAGE u16 layer_pixels[App::WIDTH * App::HEIGHT];
+} // namespace
+
 StatusScene::StatusScene(ManagementUIScene &parent)
-    : Scene(parent.get_app()), parent(parent) {}
+    : Scene(parent.get_app()), parent(parent),
+      layer{layer_pixels, App::WIDTH, App::HEIGHT} {}
+
+u64 StatusScene::layer_key() const {
+  auto &player_stats = parent.get_player_stats();
+  return CachedLayer::Key{}
+      .add(parent.get_clock().get_display_string(app))
+      .add(static_cast<u64>(parent.get_current_mode()))
+      .add(parent.get_inventory().get_version())
+      .add(player_stats.get_ship_hp())
+      // the screen shows whole percents
+      .add(static_cast<int>(player_stats.get_food_percent()))
+      .add(static_cast<int>(player_stats.get_stamina_percent()))
+      .get();
+}
 
 void StatusScene::render(Surface &fb_region) {
+  layer.render(fb_region, layer_key(), [&](Surface &s) { draw(s); });
+}
+
+void StatusScene::draw(Surface &fb_region) {
   // Clear screen with dark background
   hal::gpu::fill(fb_region, 0x0000);
 
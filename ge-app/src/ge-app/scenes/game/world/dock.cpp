@@ -12,7 +12,15 @@ DockScene::DockScene(WorldScene &parent)
 void DockScene::render(Surface &fb_region) {
   auto &boat = parent.get_boat();
   auto &clock = parent.get_clock();
-  dock.render(app, fb_region, clock, boat.get_x(), boat.get_y());
+  if (PERSPECTIVE_WATER) {
+    // the projection is of the water region
+    auto water_region = parent.water_region(fb_region);
+    dock.render(app, water_region, clock, boat.get_render_x(),
+                boat.get_render_y(), parent.get_perspective());
+  } else {
+    dock.render(app, fb_region, clock, boat.get_render_x(),
+                boat.get_render_y());
+  }
 }
 
 } // namespace world
@@ -33,7 +33,7 @@ void ObstacleScene::tick(float tick_dt) {
       float wx = x + dist * std::cos(angle);
       float wy = y + dist * std::sin(angle);
 
-      whirlpools.emplace_back(app, wx, wy);
+      spawn_whirlpool(wx, wy);
       app.log("Spawned whirlpool at (%.1f, %.1f)", wx, wy);
     }
   }
@@ -55,11 +55,19 @@ void ObstacleScene::tick(float tick_dt) {
                                          total_damage);
 }
 
+bool ObstacleScene::spawn_whirlpool(float x, float y) {
+  if (whirlpools.full())
+    return false;
+  whirlpools.emplace_back(app, x, y);
+  return true;
+}
+
 void ObstacleScene::render(Surface &fb_region) {
   auto &boat = parent.get_boat();
   auto water_region = parent.water_region(fb_region);
+  auto perspective = parent.get_perspective();
   for (auto &whirlpool : whirlpools) {
-    whirlpool.render(app, boat, water_region);
+    whirlpool.render(app, boat, water_region, perspective);
   }
 }
 
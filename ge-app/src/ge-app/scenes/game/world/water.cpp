@@ -12,8 +12,14 @@ WaterScene::WaterScene(WorldScene &parent)
 void WaterScene::render(Surface &fb_region) {
   auto &clock = parent.get_clock();
   auto &boat = parent.get_boat();
-  water.render(&app, parent.water_region(fb_region), clock.time_in_day(app),
-               boat.get_x(), boat.get_y());
+  auto water_region = parent.water_region(fb_region);
+  if (PERSPECTIVE_WATER)
+    water.render_perspective(&app, water_region, clock.time_in_day(app),
+                             *parent.get_perspective(), boat.get_render_x(),
+                             boat.get_render_y());
+  else
+    water.render(&app, water_region, clock.time_in_day(app),
+                 boat.get_render_x(), boat.get_render_y());
 }
 
 } // namespace world
@@ -11,14 +11,23 @@ namespace ge {
 namespace scenes {
 namespace menu {
 
+namespace {
+GE_LAYER_STORAGE u16 layer_pixels[App::WIDTH * App::HEIGHT];
+} // namespace
+
 CreditsScene::CreditsScene(MenuScene &parent)
     : Scene{parent.get_app()}, parent{parent},
       menu_bg_texture{menu_bg, menu_bg_WIDTH, menu_bg_HEIGHT,
-                      menu_bg_FORMAT_CPP} {}
+                      menu_bg_FORMAT_CPP},
+      layer{layer_pixels, App::WIDTH, App::HEIGHT} {}
 
 void CreditsScene::tick(float /*dt*/) {}
 
 void CreditsScene::render(Surface &fb_region) {
+  layer.render(fb_region, 0, [&](Surface &s) { draw(s); });
+}
+
+void CreditsScene::draw(Surface &fb_region) {
   hal::gpu::blit(fb_region, menu_bg_texture);
 
   // Render title
@@ -38,6 +38,17 @@ void MenuSelectScene::render(Surface &fb_region) {
   menu.render(menu_region, Font::regular_font());
 }
 
+void MenuSelectScene::on_rendered() {
+  rendered_selection = menu.get_selected_index();
+  drawn = true;
+}
+
+bool MenuSelectScene::needs_redraw() const {
+  return !drawn || menu.get_selected_index() != rendered_selection;
+}
+
+void MenuSelectScene::invalidate() { drawn = false; }
+
 bool MenuSelectScene::on_button_clicked(Button btn) {
   if (btn == Button::Button1) {
     int selected = menu.get_selected_id();
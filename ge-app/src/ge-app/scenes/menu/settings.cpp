@@ -12,8 +12,9 @@ namespace menu {
 
 SettingsScene::SettingsScene(MenuScene &parent)
     : Scene{parent.get_app()}, parent{parent}, selected_item{MUSIC_SLIDER},
-      joy_moved_y{false}, menu_bg_texture{menu_bg, menu_bg_WIDTH,
-                                          menu_bg_HEIGHT, PixelFormat::RGB565} {
+      joy_moved_y{false},
+      menu_bg_texture{menu_bg, menu_bg_WIDTH, menu_bg_HEIGHT,
+                      menu_bg_FORMAT_CPP} {
   // Initialize sliders
   music_slider.set_label("Music Volume");
   music_slider.set_range(0.0f, 100.0f);
@@ -46,46 +47,107 @@ void SettingsScene::tick(float /*dt*/) {
   }
 }
 
-void SettingsScene::render(Surface &fb_region) {
-  hal::gpu::blit(fb_region, menu_bg_texture);
+SettingsScene::ItemState SettingsScene::item_state() const {
+  return {selected_item, music_slider.get_value(), sfx_slider.get_value(),
+          button_flip_selector.get_selected_index()};
+}
 
-  Font::bold_font().render_colored("Options", -1, fb_region, 100, 20, 0x0000);
+bool SettingsScene::item_changed(const ItemState &a, const ItemState &b,
+                                 u32 item) {
+  if ((a.selected_item == item) != (b.selected_item == item))
+    return true;
+  switch (item) {
+  case MUSIC_SLIDER:
+    return a.music_volume != b.music_volume;
+  case SFX_SLIDER:
+    return a.sfx_volume != b.sfx_volume;
+  case BUTTON_FLIP:
+    return a.button_flip != b.button_flip;
+  default:
+    return false;
+  }
+}
 
-  u32 y_offset = 102;
+hal::damage::Rect SettingsScene::item_rect(const Surface &fb_region,
+                                           u32 item) {
+  constexpr u32 y_offset = 102;
   constexpr u32 item_height = 40;
 
-  auto music_region =
-      fb_region.subsurface(0, y_offset, fb_region.get_width(), item_height);
-  music_slider.render(music_region, Font::regular_font(),
-                      selected_item == MUSIC_SLIDER);
-  y_offset += item_height;
-
-  auto sfx_region =
-      fb_region.subsurface(0, y_offset, fb_region.get_width(), item_height);
-  sfx_slider.render(sfx_region, Font::regular_font(),
-                    selected_item == SFX_SLIDER);
-  y_offset += item_height;
-
-  auto flip_region =
-      fb_region.subsurface(0, y_offset, fb_region.get_width(), item_height);
-  button_flip_selector.render(flip_region, Font::regular_font(),
-                              selected_item == BUTTON_FLIP);
-
-  // Back button
-  {
-    u16 back_color = (selected_item == BACK_BUTTON) ? 0x0000 : 0x39E7;
-    auto back_btn_region = fb_region.subsurface(20, fb_region.get_height() - 60,
-                                                fb_region.get_width() - 40, 20);
-
-    if (selected_item == BACK_BUTTON) {
-      draw_rect(back_btn_region, back_color);
+  if (item == BACK_BUTTON)
+    return {20, fb_region.get_height() - 60, fb_region.get_width() - 40, 20};
+  return {0, y_offset + item * item_height, fb_region.get_width(),
+          item_height};
+}
+
+void SettingsScene::render_item(Surface &fb_region, u32 item) {
+  auto r = item_rect(fb_region, item);
+  auto region = fb_region.subsurface(r.x, r.y, r.w, r.h);
+  bool selected = selected_item == item;
+
+  switch (item) {
+  case MUSIC_SLIDER:
+    music_slider.render(region, Font::regular_font(), selected);
+    break;
+  case SFX_SLIDER:
+    sfx_slider.render(region, Font::regular_font(), selected);
+    break;
+  case BUTTON_FLIP:
+    button_flip_selector.render(region, Font::regular_font(), selected);
+    break;
+  case BACK_BUTTON: {
+    u16 back_color = selected ? 0x0000 : 0x39E7;
+    if (selected) {
+      draw_rect(region, back_color);
+    }
+    Font::regular_font().render_colored("Back to menu", -1, region, 24, 4,
+                                        back_color);
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+void SettingsScene::render(Surface &fb_region) {
+  auto state = item_state();
+
+  if (!drawn) {
+    hal::gpu::blit(fb_region, menu_bg_texture);
+    Font::bold_font().render_colored("Options", -1, fb_region, 100, 20,
+                                     0x0000);
+    for (u32 i = 0; i < NUM_SETTINGS_ITEMS; ++i)
+      render_item(fb_region, i);
+  } else {
+    // Only redraw the items that changed, over their part of the background
+    for (u32 i = 0; i < NUM_SETTINGS_ITEMS; ++i) {
+      if (!item_changed(rendered, state, i))
+        continue;
+      auto r = item_rect(fb_region, i);
+      hal::gpu::blit(fb_region.subsurface(r.x, r.y, r.w, r.h),
+                     menu_bg_texture.subsurface(r.x, r.y, r.w, r.h));
+      render_item(fb_region, i);
     }
+  }
+}
 
-    Font::regular_font().render_colored("Back to menu", -1, back_btn_region, 24,
-                                        4, back_color);
+void SettingsScene::on_rendered() {
+  rendered = item_state();
+  drawn = true;
+}
+
+bool SettingsScene::needs_redraw() const {
+  if (!drawn)
+    return true;
+  auto state = item_state();
+  for (u32 i = 0; i < NUM_SETTINGS_ITEMS; ++i) {
+    if (item_changed(rendered, state, i))
+      return true;
   }
+  return false;
 }
 
+void SettingsScene::invalidate() { drawn = false; }
+
 bool SettingsScene::on_button_clicked(Button btn) {
   if (btn == Button::Button1 && selected_item == BACK_BUTTON) {
     parent.show_select();
@@ -0,0 +1,125 @@
+#include "ge-app/text_layout.hpp"
+#include <cstring>
+
+namespace ge {
+
+namespace {
+
+// A few texts are on screen at once, e.g. the title and the body of a dialog
+constexpr u32 CACHE_SIZE = 4;
+// Longer texts are not cached
+constexpr u32 MAX_TEXT_LENGTH = 255;
+
+struct CacheEntry {
+  TextLayout layout;
+  const Font *font = nullptr;
+  // Texts are often formatted into a reused buffer, so the pointer alone
+  // says nothing: a hit also compares the contents with a copy
+  const char *text = nullptr;
+  char contents[MAX_TEXT_LENGTH + 1];
+  int width = 0, height = 0;
+  u32 last_used = 0;
+  bool valid = false;
+};
+
+CacheEntry cache[CACHE_SIZE];
+u32 cache_clock = 0;
+
+} // namespace
+
+bool TextLayout::compute(const Font &font, const char *text, int width,
+                         int height) {
+  this->font = &font;
+  glyphs.clear();
+  extent_w = extent_h = 0;
+
+  const int line_height = font.line_height();
+  const int space_advance = font.default_advance();
+  auto advance_of = [&](char ch, bool &has_glyph) {
+    u8 const *glyph_data;
+    u8 glyph_w, glyph_h, advance;
+    has_glyph = font.get_glyph(ch, glyph_data, glyph_w, glyph_h, advance);
+    return has_glyph ? int(advance) : space_advance;
+  };
+  auto measure_word = [&](const char *p) {
+    int w = 0;
+    bool has_glyph;
+    for (; *p && *p != ' ' && *p != '\n'; ++p)
+      w += advance_of(*p, has_glyph);
+    return w;
+  };
+
+  // the wrapping of Font::render_typed(), with the box at (0, 0)
+  int x = 0, y = 0;
+  u32 i = 0;
+  for (; text[i]; ++i) {
+    const char ch = text[i];
+    if (y + line_height > height)
+      break;
+
+    if (ch == '\n') {
+      x = 0;
+      y += line_height;
+      continue;
+    }
+
+    if (ch == ' ' && x + space_advance + measure_word(text + i + 1) > width) {
+      x = 0;
+      y += line_height;
+      continue;
+    }
+
+    bool has_glyph;
+    const int advance = advance_of(ch, has_glyph);
+    if (x + advance > width) {
+      x = 0;
+      y += line_height;
+    }
+
+    if (has_glyph) {
+      if (glyphs.full())
+        return false;
+      glyphs.push_back(
+          Glyph{static_cast<i16>(x), static_cast<i16>(y), static_cast<u16>(i),
+                ch});
+      extent_w = std::max(extent_w, x + font.glyph_width);
+      extent_h = std::max(extent_h, y + font.glyph_height);
+    }
+    x += advance;
+  }
+
+  while (text[i])
+    ++i;
+  text_length = i;
+  return true;
+}
+
+const TextLayout *TextLayout::cached(const Font &font, const char *text,
+                                     int width, int height) {
+  CacheEntry *victim = &cache[0];
+  for (auto &entry : cache) {
+    if (entry.valid && entry.text == text && entry.font == &font &&
+        entry.width == width && entry.height == height &&
+        std::strcmp(entry.contents, text) == 0) {
+      entry.last_used = ++cache_clock;
+      return &entry.layout;
+    }
+    if (victim->valid && (!entry.valid || entry.last_used < victim->last_used))
+      victim = &entry;
+  }
+
+  // memchr() stops at the terminator, shorter strings are not read past it
+  victim->valid = std::memchr(text, '\0', MAX_TEXT_LENGTH + 1) &&
+                  victim->layout.compute(font, text, width, height);
+  if (!victim->valid)
+    return nullptr;
+  std::memcpy(victim->contents, text, victim->layout.length() + 1);
+  victim->font = &font;
+  victim->text = text;
+  victim->width = width;
+  victim->height = height;
+  victim->last_used = ++cache_clock;
+  return &victim->layout;
+}
+
+} // namespace ge
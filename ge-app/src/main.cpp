@@ -1,6 +1,8 @@
 #include "ge-app/scenes/main.hpp"
 #include "ge-app/rng.hpp"
+#include "ge-app/ui/profiler_overlay.hpp"
 #include "ge-hal/app.hpp"
+#include "ge-hal/profiler.hpp"
 #include "ge-hal/surface.hpp"
 
 namespace ge {
@@ -10,7 +12,10 @@ public:
 
   void tick(float dt) override {
     App::tick(dt);
-    root_scene.tick(dt);
+    {
+      GE_PROFILE_SCOPE("RootScene", hal::profiler::Category::Tick);
+      root_scene.tick(dt);
+    }
 
     auto joystick = get_joystick_state();
     root_scene.on_joystick_moved(dt, joystick.x, joystick.y);
@@ -18,9 +23,30 @@ public:
 
   void render(Surface &fb) override {
     App::render(fb);
-    auto start = now();
-    root_scene.render(fb);
-    auto end = now();
+    // nothing on screen would change, present the previous frame again
+    if (root_scene.needs_redraw()) {
+      GE_PROFILE_SCOPE("RootScene", hal::profiler::Category::Render);
+      root_scene.render(fb);
+    }
+    if (show_profiler)
+      profiler_overlay.render(fb);
+  }
+
+  void on_rendered() override { root_scene.on_rendered(); }
+
+  bool is_opaque() const override {
+    return root_scene.needs_redraw() && root_scene.is_opaque();
+  }
+
+  void on_debug_command(DebugCommand cmd) override {
+    if (cmd != DebugCommand::ToggleProfiler)
+      return App::on_debug_command(cmd);
+
+    show_profiler = !show_profiler;
+    hal::profiler::set_enabled(show_profiler);
+    // the scenes have to draw over the overlay again
+    if (!show_profiler)
+      root_scene.invalidate();
   }
 
   void on_button_clicked(Button btn) override {
@@ -41,6 +67,8 @@ public:
 
 private:
   scenes::RootScene root_scene;
+  ui::ProfilerOverlay profiler_overlay;
+  bool show_profiler = false;
 };
 
 } // namespace ge
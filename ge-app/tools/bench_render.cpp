@@ -0,0 +1,436 @@
+// Golden-frame render benchmark on the headless backend. Puts the game into a
+// number of fixed states (the game is driven by the virtual clock, so every
+// run gets the same frames), renders each state from scratch a number of
+// times and compares the time per frame and a hash of the frame against a
+// baseline file.
+//
+//   ge-bench-render [--frames N] [--filter TEXT] [--baseline FILE]
+//                   [--update-baseline] [--tolerance PERCENT] [--strict]
+//                   [--dump DIR] [--strips ROWS] [--deferred]
+//
+// A frame that hashes differently from the baseline fails the run (exit code
+// 1). A case that got slower than the baseline by more than the tolerance
+// (10% by default) is reported as a regression, and only fails the run with
+// --strict, as timings depend on the machine. The hashes depend on the assets
+// and the compiler, so the baseline has to be made with --update-baseline on
+// the build it is checked against: CI makes it from the parent commit. A
+// --baseline file that cannot be read fails the run. --dump writes each frame
+// to DIR/<case>.rgb565 (raw RGB565, 240x320), to look at what changed.
+// --strips renders in bands of ROWS rows (see ge-hal/strips.hpp), then
+// renders each case once more as a whole frame: a case whose frames differ
+// fails the run as well. --deferred records the hal::gpu calls into the
+// command list (see hal::gpu::set_deferred) and checks the frames against
+// the immediate path the same way.
+
+#include "ge-app/rng.hpp"
+#include "ge-app/scenes/main.hpp"
+#include "ge-hal/app.hpp"
+#include "ge-hal/gpu.hpp"
+#include "ge-hal/strips.hpp"
+#include "ge-hal/timestep.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace ge;
+
+namespace {
+
+constexpr u32 WARMUP_FRAMES = 5;
+
+// The game without the main loop: the benchmark steps it frame by frame
+class BenchApp : public App {
+public:
+  BenchApp() : root_scene(*this) { hal::timestep::advance(0); }
+
+  void tick(float dt) override {
+    App::tick(dt);
+    root_scene.tick(dt);
+    root_scene.on_joystick_moved(dt, joystick_x, joystick_y);
+  }
+
+  void render(Surface &fb) override {
+    App::render(fb);
+    root_scene.render(fb);
+  }
+
+  void on_rendered() override { root_scene.on_rendered(); }
+
+  bool is_opaque() const override { return root_scene.is_opaque(); }
+
+  void click(Button btn) { root_scene.on_button_clicked(btn); }
+
+  void set_joystick(float x, float y) {
+    joystick_x = x;
+    joystick_y = y;
+  }
+
+  // Play num_frames frames of one tick each, like App::loop() does
+  void step(u32 num_frames) {
+    for (u32 i = 0; i < num_frames; ++i) {
+      ++frames;
+      hal::timestep::advance(
+          static_cast<i64>(frames * 1000 / hal::timestep::TICK_RATE));
+      while (hal::timestep::next_tick())
+        tick(hal::timestep::TICK_DT);
+      draw();
+    }
+  }
+
+  // Render the current state from scratch, without moving the clock
+  void draw() {
+    Surface fb{framebuffer, WIDTH, WIDTH, HEIGHT, PixelFormat::RGB565, 0};
+    root_scene.invalidate();
+    hal::strips::render_frame(*this, fb);
+    hal::gpu::flush();
+  }
+
+  bool dump(const char *path) const {
+    FILE *f = std::fopen(path, "wb");
+    if (!f)
+      return false;
+    std::fwrite(framebuffer, sizeof(framebuffer), 1, f);
+    std::fclose(f);
+    return true;
+  }
+
+  // FNV-1a, like the headless backend reports
+  u64 frame_hash() const {
+    u64 hash = 0xcbf29ce484222325ull;
+    auto bytes = reinterpret_cast<const u8 *>(framebuffer);
+    for (std::size_t i = 0; i < sizeof(framebuffer); ++i)
+      hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    return hash;
+  }
+
+  scenes::RootScene root_scene;
+
+private:
+  float joystick_x = 0.0f, joystick_y = 0.0f;
+  u64 frames = 0;
+  u16 framebuffer[WIDTH * HEIGHT];
+};
+
+void start_game(BenchApp &app, u32 hour) {
+  app.root_scene.start_game();
+  app.root_scene.get_game_scene().get_clock().reset(
+      app, Clock::DAY_LENGTH * hour / 24);
+  app.step(30);
+}
+
+void setup_menu(BenchApp &app) { app.step(30); }
+
+void setup_dawn(BenchApp &app) { start_game(app, 6); }
+void setup_noon(BenchApp &app) { start_game(app, 12); }
+void setup_dusk(BenchApp &app) { start_game(app, 18); }
+void setup_night(BenchApp &app) { start_game(app, 23); }
+
+void setup_fishing(BenchApp &app) {
+  start_game(app, 12);
+  // Steering -> Fishing, then flick the joystick to cast
+  app.click(Button::Button2);
+  app.step(2);
+  app.set_joystick(0.0f, -1.0f);
+  app.step(1);
+  app.set_joystick(0.0f, 0.0f);
+  // the cast takes 0.25s, a bite can only come after 2s
+  app.step(60);
+}
+
+void setup_management(BenchApp &app) {
+  start_game(app, 12);
+  // Steering -> Fishing -> Management
+  app.click(Button::Button2);
+  app.step(1);
+  app.click(Button::Button2);
+  app.step(1);
+}
+
+void setup_map(BenchApp &app) {
+  setup_management(app);
+  app.root_scene.get_game_scene().get_management_ui_scene().show_map_screen();
+  app.step(30);
+}
+
+void setup_inventory(BenchApp &app) {
+  setup_management(app);
+  app.root_scene.get_game_scene()
+      .get_management_ui_scene()
+      .show_inventory_screen();
+  app.step(30);
+}
+
+void setup_status(BenchApp &app) {
+  setup_management(app);
+  app.root_scene.get_game_scene()
+      .get_management_ui_scene()
+      .show_status_screen();
+  app.step(30);
+}
+
+void setup_dialog(BenchApp &app) {
+  start_game(app, 12);
+  auto &dialog = app.root_scene.get_dialog_scene();
+  dialog.show_message("Benchmark",
+                      "A dialog over the world, with the whole message "
+                      "shown at once so that every glyph is drawn.\n");
+  dialog.set_start_time();
+  app.step(1);
+}
+
+void setup_whirlpools(BenchApp &app) {
+  start_game(app, 12);
+  auto &world = app.root_scene.get_game_scene().get_world_scene();
+  auto &boat = world.get_boat();
+  // a 16x8 grid over the water, all on screen
+  for (u32 i = 0; i < 128; ++i) {
+    float x = boat.get_x() - 112.0f + 15.0f * (i % 16);
+    float y = boat.get_y() - 105.0f + 30.0f * (i / 16);
+    world.get_obstacle_scene().spawn_whirlpool(x, y);
+  }
+  // halfway through their life they are fully visible; whirlpools move on
+  // tick, so only the simulation time moves
+  hal::timestep::reset(app.now() + 15000);
+  app.draw();
+}
+
+struct Case {
+  const char *name;
+  void (*setup)(BenchApp &app);
+};
+
+const Case CASES[] = {
+    {"menu", setup_menu},
+    {"world-dawn", setup_dawn},
+    {"world-noon", setup_noon},
+    {"world-dusk", setup_dusk},
+    {"world-night", setup_night},
+    {"fishing-cast", setup_fishing},
+    {"management-menu", setup_management},
+    {"management-map", setup_map},
+    {"management-inventory", setup_inventory},
+    {"management-status", setup_status},
+    {"dialog", setup_dialog},
+    {"whirlpools-128", setup_whirlpools},
+};
+
+struct Result {
+  std::string name;
+  u64 hash;
+  double ms; // median time per frame
+  bool matches_immediate; // same frame drawn whole, without deferred mode
+};
+
+Result run_case(const Case &c, u32 num_frames, const char *dump_dir) {
+  // every case starts from a new game and the same random numbers
+  PCG32::instance() = PCG32{};
+  auto app = std::unique_ptr<BenchApp>(new BenchApp());
+  c.setup(*app);
+
+  using clock = std::chrono::steady_clock;
+  std::vector<double> times;
+  for (u32 i = 0; i < WARMUP_FRAMES + num_frames; ++i) {
+    auto start = clock::now();
+    app->draw();
+    std::chrono::duration<double, std::milli> elapsed = clock::now() - start;
+    if (i >= WARMUP_FRAMES)
+      times.push_back(elapsed.count());
+  }
+
+  if (dump_dir) {
+    std::string path = std::string(dump_dir) + "/" + c.name + ".rgb565";
+    if (!app->dump(path.c_str()))
+      std::fprintf(stderr, "bench: cannot write %s\n", path.c_str());
+  }
+
+  // the same state drawn whole and right away, when the frames above were
+  // drawn in strips or through the command list
+  u64 hash = app->frame_hash();
+  bool matches_immediate = true;
+  const u32 rows = hal::strips::height();
+  const bool deferred = hal::gpu::is_deferred();
+  if (rows || deferred) {
+    hal::strips::set_height(0);
+    hal::gpu::set_deferred(false);
+    app->draw();
+    matches_immediate = app->frame_hash() == hash;
+    hal::strips::set_height(rows);
+    hal::gpu::set_deferred(deferred);
+  }
+
+  std::sort(times.begin(), times.end());
+  return {c.name, hash, times[times.size() / 2], matches_immediate};
+}
+
+bool load_baseline(const char *path, std::vector<Result> &baseline) {
+  FILE *f = std::fopen(path, "r");
+  if (!f)
+    return false;
+  char line[256], name[128];
+  unsigned long long hash;
+  double ms;
+  while (std::fgets(line, sizeof(line), f)) {
+    if (line[0] == '#' || line[0] == '\n')
+      continue;
+    if (std::sscanf(line, "%127s %llx %lf", name, &hash, &ms) == 3)
+      baseline.push_back({name, static_cast<u64>(hash), ms, true});
+  }
+  std::fclose(f);
+  return true;
+}
+
+bool save_baseline(const char *path, const std::vector<Result> &baseline) {
+  FILE *f = std::fopen(path, "w");
+  if (!f)
+    return false;
+  std::fprintf(f, "# ge-bench-render baseline: case, frame hash, ms/frame\n");
+  for (const auto &r : baseline)
+    std::fprintf(f, "%s %016llx %.4f\n", r.name.c_str(),
+                 static_cast<unsigned long long>(r.hash), r.ms);
+  std::fclose(f);
+  return true;
+}
+
+Result *find(std::vector<Result> &results, const std::string &name) {
+  for (auto &r : results) {
+    if (r.name == name)
+      return &r;
+  }
+  return nullptr;
+}
+
+void usage() {
+  std::fprintf(stderr,
+               "usage: ge-bench-render [--frames N] [--filter TEXT] "
+               "[--baseline FILE]\n"
+               "                       [--update-baseline] "
+               "[--tolerance PERCENT] [--strict]\n"
+               "                       [--dump DIR] [--strips ROWS] "
+               "[--deferred]\n");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  u32 num_frames = 60;
+  const char *filter = nullptr, *dump_dir = nullptr;
+  const char *baseline_path = GE_BENCH_BASELINE;
+  bool update = false, strict = false, explicit_baseline = false;
+  double tolerance = 10.0;
+
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (!std::strcmp(argv[i], "--frames") && has_value)
+      num_frames = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+    else if (!std::strcmp(argv[i], "--filter") && has_value)
+      filter = argv[++i];
+    else if (!std::strcmp(argv[i], "--baseline") && has_value) {
+      baseline_path = argv[++i];
+      explicit_baseline = true;
+    } else if (!std::strcmp(argv[i], "--dump") && has_value)
+      dump_dir = argv[++i];
+    else if (!std::strcmp(argv[i], "--strips") && has_value)
+      hal::strips::set_height(std::strtoul(argv[++i], nullptr, 10));
+    else if (!std::strcmp(argv[i], "--tolerance") && has_value)
+      tolerance = std::strtod(argv[++i], nullptr);
+    else if (!std::strcmp(argv[i], "--deferred"))
+      hal::gpu::set_deferred(true);
+    else if (!std::strcmp(argv[i], "--update-baseline"))
+      update = true;
+    else if (!std::strcmp(argv[i], "--strict"))
+      strict = true;
+    else {
+      usage();
+      return 2;
+    }
+  }
+
+  std::vector<Result> baseline;
+  bool has_baseline = load_baseline(baseline_path, baseline);
+  // nothing to compare against would pass every run
+  if (!has_baseline && explicit_baseline && !update) {
+    std::fprintf(stderr, "bench: cannot read %s\n", baseline_path);
+    return 1;
+  }
+
+  std::printf("%-22s %9s %9s %8s  %-16s %s\n", "case", "ms/frame", "baseline",
+              "change", "frame hash", "");
+  u32 num_changed = 0, num_regressed = 0, num_mismatched = 0;
+  hal::gpu::reset_command_stats();
+  for (const auto &c : CASES) {
+    if (filter && !std::strstr(c.name, filter))
+      continue;
+    auto result = run_case(c, num_frames, dump_dir);
+    auto *base = find(baseline, result.name);
+
+    const char *status = "new";
+    double change = base ? (result.ms / base->ms - 1.0) * 100.0 : 0.0;
+    if (!result.matches_immediate) {
+      status = hal::strips::height() ? "STRIPS" : "DEFERRED";
+      ++num_mismatched;
+    } else if (base) {
+      if (result.hash != base->hash) {
+        status = "CHANGED";
+        ++num_changed;
+      } else if (change > tolerance) {
+        status = "REGRESSED";
+        ++num_regressed;
+      } else {
+        status = "ok";
+      }
+    }
+
+    if (base)
+      std::printf("%-22s %9.3f %9.3f %+7.1f%%  %016llx %s\n",
+                  result.name.c_str(), result.ms, base->ms, change,
+                  static_cast<unsigned long long>(result.hash), status);
+    else
+      std::printf("%-22s %9.3f %9s %8s  %016llx %s\n", result.name.c_str(),
+                  result.ms, "-", "-",
+                  static_cast<unsigned long long>(result.hash), status);
+
+    if (update && result.matches_immediate) {
+      if (base)
+        *base = result;
+      else
+        baseline.push_back(result);
+    }
+  }
+
+  if (num_mismatched)
+    std::printf("bench: %u case(s) render differently in %s\n",
+                num_mismatched,
+                hal::strips::height() ? "strips" : "deferred mode");
+  if (hal::gpu::is_deferred()) {
+    const auto &stats = hal::gpu::command_stats();
+    std::printf("bench: %u command(s) recorded, %u merged, %u dropped, %u "
+                "executed\n",
+                stats.recorded, stats.merged, stats.dropped, stats.executed);
+  }
+
+  if (update) {
+    if (!save_baseline(baseline_path, baseline)) {
+      std::fprintf(stderr, "bench: cannot write %s\n", baseline_path);
+      return 1;
+    }
+    std::printf("bench: baseline written to %s\n", baseline_path);
+    return num_mismatched ? 1 : 0;
+  }
+
+  if (!has_baseline)
+    std::printf("bench: no baseline at %s, run with --update-baseline\n",
+                baseline_path);
+  if (num_changed)
+    std::printf("bench: %u case(s) render differently from the baseline\n",
+                num_changed);
+  if (num_regressed)
+    std::printf("bench: %u case(s) slower than the baseline by more than "
+                "%.0f%%\n",
+                num_regressed, tolerance);
+  return num_changed || num_mismatched || (strict && num_regressed) ? 1 : 0;
+}
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "ge-hal/core.hpp"
+#include "ge-hal/profiler.hpp"
 #include "ge-hal/surface.hpp"
 
 namespace ge {
@@ -11,6 +12,10 @@ struct JoystickState {
 
 enum class Button { Button1, Button2, NumButtons };
 
+// Developer input that is not part of the game: F3/F4 or the gamepad Back
+// button on PC, 'p'/'d' over the debug UART on STM
+enum class DebugCommand { ToggleProfiler, DumpProfile };
+
 class App {
 public:
   App();
@@ -21,9 +26,9 @@ public:
 #endif
 
   static constexpr int WIDTH = 240, HEIGHT = 320, AUDIO_FREQ = 8000;
-#ifdef GE_HAL_PC
+#if defined(GE_HAL_PC) || defined(GE_HAL_HEADLESS)
   // On PC, double buffering is automatically handled by SDL,
-  // so we only need one buffer.
+  // so we only need one buffer. Headless never presents anything.
   static constexpr int NUM_BUFFERS = 1;
 #else
   // On STM32, we use double buffering to avoid tearing.
@@ -39,10 +44,21 @@ public:
 
   // Event handlers & Rendering
   virtual void tick(float dt);
+  // With strip rendering (hal::strips) render() is called once per band,
+  // then on_rendered() once the whole frame is drawn
   virtual void render(Surface &fb) {}
+  virtual void on_rendered() {}
+  // Whether the next render() covers the whole frame with opaque pixels.
+  // Only such frames are drawn in strips, the others redraw a few parts of
+  // the framebuffer in place.
+  virtual bool is_opaque() const { return false; }
   virtual void on_button_clicked(Button btn) {}
   virtual void on_button_held(Button btn) {}
   virtual void on_button_finished_hold(Button btn) {}
+  virtual void on_debug_command(DebugCommand cmd) {
+    if (cmd == DebugCommand::DumpProfile)
+      hal::profiler::dump();
+  }
 
   void loop();
 
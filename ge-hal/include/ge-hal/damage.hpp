@@ -0,0 +1,54 @@
+#pragma once
+
+#include "ge-hal/core.hpp"
+#include "ge-hal/surface.hpp"
+
+namespace ge {
+namespace hal {
+
+// Framebuffer damage: the parts of the framebuffer that changed during the
+// current frame. hal::gpu marks everything it draws into the framebuffer,
+// code that writes pixels with the CPU marks the region it writes to.
+// App::loop only presents the damaged rectangles, and nothing at all for a
+// frame without damage.
+namespace damage {
+
+struct Rect {
+  u32 x = 0, y = 0, w = 0, h = 0;
+
+  bool empty() const { return w == 0 || h == 0; }
+  u32 right() const { return x + w; }
+  u32 bottom() const { return y + h; }
+};
+
+// Rectangles are merged once there are more than this
+constexpr u32 MAX_RECTS = 8;
+
+struct Region {
+  Rect rects[MAX_RECTS];
+  u32 count = 0;
+
+  bool empty() const { return count == 0; }
+  Rect bounds() const;
+  u32 area() const;
+
+  void add(Rect rect);
+  void clear() { count = 0; }
+};
+
+// Called by App::loop before render(), with the surface it renders to
+void begin_frame(const Surface &fb);
+// With strip rendering, called before rendering each band with its surface
+// (see hal::strips). The damage of the frame so far is kept.
+void begin_band(const Surface &band);
+
+void mark(Rect rect);
+// Marks the surface if it is part of this frame's framebuffer
+void mark(const Surface &surface);
+void mark_all();
+
+const Region &current();
+
+} // namespace damage
+} // namespace hal
+} // namespace ge
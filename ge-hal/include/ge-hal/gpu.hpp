@@ -12,11 +12,66 @@ namespace gpu {
 void fill(Surface dst, u32 color);
 void blit(Surface dst, ConstSurface src);
 void blit_blend(Surface dst, ConstSurface src, u8 global_alpha);
+// Same for an ARGB8888 src whose colors are premultiplied by their alpha
+// (bin2c_image.py --premultiplied): one multiply per channel, no division.
+// Other source formats assert and draw nothing, on every backend. The DMA2D
+// has no such mode, the STM32 backend blends these with the CPU.
+void blit_blend_premultiplied(Surface dst, ConstSurface src, u8 global_alpha);
+// Blends the RGB888 color through the coverage of an A8/A4 src (DMA2D
+// M2M_BLEND with FGCOLR), e.g. anti-aliased glyphs. A4 rows must start on a
+// byte: even x and an even stride.
+void blit_blend_alpha(Surface dst, ConstSurface src, u32 color,
+                      u8 global_alpha);
 
-void load_palette(u32 const *colors, int count);
+// Sets the ARGB8888 CLUT used by L8/L4 sources (up to 256 colors). colors
+// must stay valid and unchanged while it is loaded: loading the palette that
+// is already loaded does nothing.
+void load_palette(u32 const *colors, usize num_colors);
+// Copy through the CLUT, alpha ignored. blit_blend() also takes L8/L4
+// sources, blended with the palette alpha.
 void blit_indexed(Surface dst, ConstSurface src);
+
+// Must be called before the CPU reads or writes pixels that were touched by
+// the operations above. In deferred mode this also executes the recorded
+// commands.
 void wait_idle();
 
+// A fence marks everything submitted so far. wait_fence() returns once that
+// work is done, without waiting for anything submitted after the fence.
+// Fences are cheap; on PC every operation finishes before it returns.
+using Fence = u32;
+Fence insert_fence();
+void wait_fence(Fence fence);
+
+// Deferred (recorded) mode: the operations above are appended to a command
+// list instead of running right away. The list is executed by flush(), which
+// App::loop calls after App::render, or earlier by wait_idle() or when the
+// list is full.
+//
+// While recording, same-color fills that touch each other are merged, and
+// commands whose output is completely overwritten by a later opaque command
+// are dropped. Sources must therefore stay alive until the next flush.
+//
+// Off by default. The scenes draw little that is merged or hidden (a few
+// commands a frame), so recording costs more than it saves, and on the
+// STM32 it holds every DMA2D transfer back until the flush instead of
+// overlapping them with the CPU. Worth turning on for draw code that
+// overdraws heavily, measured with command_stats().
+void set_deferred(bool deferred);
+bool is_deferred();
+void flush();
+
+struct CommandStats {
+  u32 recorded = 0; // calls made while in deferred mode
+  u32 merged = 0;   // fills merged into an earlier fill
+  u32 dropped = 0;  // commands removed because their output was not visible
+  u32 executed = 0; // commands sent to the backend
+};
+
+// Counters since the last call to reset_command_stats()
+const CommandStats &command_stats();
+void reset_command_stats();
+
 } // namespace gpu
 
 } // namespace hal
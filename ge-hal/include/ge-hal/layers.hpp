@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ge-hal/core.hpp"
+#include "ge-hal/surface.hpp"
+
+namespace ge {
+namespace hal {
+
+// Display layers: the display controller (the LTDC on STM32) reads two layers
+// while it scans the screen out and blends them itself, so parts of the
+// screen that change independently can live in their own buffers and be
+// redrawn on their own.
+//
+// The background layer shows the App framebuffer, or a buffer of its own,
+// larger than the screen, that is scrolled by moving the layer's start
+// address instead of redrawing it. The foreground layer is hidden until it
+// is given a buffer, and is blended over the background with its pixel alpha
+// (ARGB4444 and ARGB1555 keep it at 16 bpp) times a constant alpha. Each
+// layer shows the WIDTH x HEIGHT window of its buffer at its scroll offset,
+// buffers smaller than the screen are shown at its top-left corner.
+//
+// Buffers are read by the display as they are, with no damage tracking and
+// no double buffering: draw into them with hal::gpu::wait_idle() in mind,
+// or swap between two with set_buffer(). Changes are applied at the next
+// vertical blank, on PC the next frame is composed by the CPU like the LTDC
+// would.
+namespace layers {
+
+enum class Layer : u8 { Background, Foreground };
+constexpr u32 NUM_LAYERS = 2;
+
+struct State {
+  // nullptr: the framebuffer (background) or hidden (foreground)
+  ConstSurface buffer;
+  u32 scroll_x = 0, scroll_y = 0;
+  u8 alpha = 0xFF;
+};
+
+// Buffers must be fully backed and in a format the LTDC reads that has
+// pixel::Traits: RGB565, ARGB1555, ARGB4444 or ARGB8888. Others are refused.
+void set_buffer(Layer layer, const ConstSurface &buffer);
+// Clamped so that the window stays inside the buffer
+void set_scroll(Layer layer, u32 x, u32 y);
+void set_alpha(Layer layer, u8 alpha);
+// Back to the framebuffer alone
+void reset();
+
+const State &state(Layer layer);
+// Whether the screen is anything other than the framebuffer alone
+bool active();
+// Incremented by every change, for the backends to notice them
+u32 revision();
+
+// The part of the layer's buffer on screen, fb for the background without
+// a buffer of its own. Null for a hidden layer.
+ConstSurface window(Layer layer, const ConstSurface &fb);
+
+#ifndef GE_HAL_STM32
+// The screen as the LTDC would show it, composed by the CPU into dst
+void compose(const Surface &dst, const ConstSurface &fb);
+#endif
+
+} // namespace layers
+} // namespace hal
+} // namespace ge
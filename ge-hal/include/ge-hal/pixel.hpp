@@ -0,0 +1,158 @@
+#pragma once
+
+#include "ge-hal/surface.hpp"
+
+namespace ge {
+
+// Compile-time description of the direct-color pixel formats, for code that
+// touches pixels with the CPU. Conversions follow the DMA2D rules (narrow
+// channels are widened by replicating their MSBs), like hal::sw, so pixels
+// drawn by the CPU match the ones drawn by the GPU.
+namespace pixel {
+
+// 8-bit channels, straight (not premultiplied) alpha
+struct Rgba {
+  u32 r, g, b, a;
+};
+
+// round(x / 255) for x in [0, 255 * 255]
+inline constexpr u32 div255(u32 x) {
+  return (x + 128 + ((x + 128) >> 8)) >> 8;
+}
+
+inline constexpr u32 expand4(u32 v) { return (v << 4) | v; }
+inline constexpr u32 expand5(u32 v) { return (v << 3) | (v >> 2); }
+inline constexpr u32 expand6(u32 v) { return (v << 2) | (v >> 4); }
+
+template <PixelFormat format> struct Traits;
+
+template <> struct Traits<PixelFormat::RGB565> {
+  using type = u16;
+  static constexpr usize bpp = 16;
+  static constexpr bool has_alpha = false;
+
+  static constexpr Rgba unpack(u16 c) {
+    return {expand5(c >> 11), expand6((c >> 5) & 0x3F), expand5(c & 0x1F),
+            0xFF};
+  }
+  static constexpr u16 pack(Rgba c) {
+    return ((c.r & 0xF8) << 8) | ((c.g & 0xFC) << 3) | (c.b >> 3);
+  }
+};
+
+template <> struct Traits<PixelFormat::ARGB1555> {
+  using type = u16;
+  static constexpr usize bpp = 16;
+  static constexpr bool has_alpha = true;
+
+  static constexpr Rgba unpack(u16 c) {
+    return {expand5((c >> 10) & 0x1F), expand5((c >> 5) & 0x1F),
+            expand5(c & 0x1F), (c & 0x8000) ? 0xFFu : 0u};
+  }
+  static constexpr u16 pack(Rgba c) {
+    return ((c.a & 0x80) << 8) | ((c.r & 0xF8) << 7) | ((c.g & 0xF8) << 2) |
+           (c.b >> 3);
+  }
+};
+
+template <> struct Traits<PixelFormat::ARGB4444> {
+  using type = u16;
+  static constexpr usize bpp = 16;
+  static constexpr bool has_alpha = true;
+
+  static constexpr Rgba unpack(u16 c) {
+    return {expand4((c >> 8) & 0xF), expand4((c >> 4) & 0xF), expand4(c & 0xF),
+            expand4(c >> 12)};
+  }
+  static constexpr u16 pack(Rgba c) {
+    return ((c.a & 0xF0) << 8) | ((c.r & 0xF0) << 4) | (c.g & 0xF0) |
+           (c.b >> 4);
+  }
+};
+
+template <> struct Traits<PixelFormat::ARGB8888> {
+  using type = u32;
+  static constexpr usize bpp = 32;
+  static constexpr bool has_alpha = true;
+
+  static constexpr Rgba unpack(u32 c) {
+    return {(c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF, c >> 24};
+  }
+  static constexpr u32 pack(Rgba c) {
+    return c.a << 24 | c.r << 16 | c.g << 8 | c.b;
+  }
+};
+
+template <PixelFormat format> using type_t = typename Traits<format>::type;
+
+// --- Per-pixel operations ---
+
+template <PixelFormat dst, PixelFormat src> struct Convert {
+  static type_t<dst> apply(type_t<src> c) {
+    return Traits<dst>::pack(Traits<src>::unpack(c));
+  }
+};
+
+template <PixelFormat format> struct Convert<format, format> {
+  static type_t<format> apply(type_t<format> c) { return c; }
+};
+
+// c in the dst format, alpha included
+template <PixelFormat dst, PixelFormat src>
+inline type_t<dst> convert(type_t<src> c) {
+  return Convert<dst, src>::apply(c);
+}
+
+// Blends c over d, its alpha multiplied by alpha (DMA2D M2M_BLEND)
+template <PixelFormat format>
+inline void blend_pixel(type_t<format> &d, Rgba c, u32 alpha = 0xFF) {
+  using T = Traits<format>;
+  u32 a = alpha == 0xFF ? c.a : div255(c.a * alpha);
+  if (a == 0)
+    return;
+  if (a == 0xFF) {
+    d = T::pack({c.r, c.g, c.b, 0xFF});
+    return;
+  }
+  u32 ia = 255 - a;
+  Rgba b = T::unpack(d);
+  d = T::pack({div255(c.r * a + b.r * ia), div255(c.g * a + b.g * ia),
+               div255(c.b * a + b.b * ia), a + div255(b.a * ia)});
+}
+
+// Blends the premultiplied c (its colors already multiplied by its alpha)
+// over d. One multiply per channel instead of two: within one LSB of
+// blend_pixel() on the straight colors.
+template <PixelFormat format>
+inline void blend_premultiplied_pixel(type_t<format> &d, Rgba c) {
+  using T = Traits<format>;
+  if (c.a == 0xFF) {
+    d = T::pack(c);
+    return;
+  }
+  if ((c.r | c.g | c.b | c.a) == 0)
+    return;
+  u32 ia = 255 - c.a;
+  Rgba b = T::unpack(d);
+  d = T::pack({c.r + div255(b.r * ia), c.g + div255(b.g * ia),
+               c.b + div255(b.b * ia), c.a + div255(b.a * ia)});
+}
+
+template <PixelFormat format>
+inline void blend_premultiplied_pixel(type_t<format> &d, Rgba c, u32 alpha) {
+  blend_premultiplied_pixel<format>(
+      d, {div255(c.r * alpha), div255(c.g * alpha), div255(c.b * alpha),
+          div255(c.a * alpha)});
+}
+
+// Writes a src pixel onto d: blended if src has alpha, converted otherwise
+template <PixelFormat src, PixelFormat dst>
+inline void put(type_t<dst> &d, type_t<src> c) {
+  if (Traits<src>::has_alpha)
+    blend_pixel<dst>(d, Traits<src>::unpack(c));
+  else
+    d = convert<dst, src>(c);
+}
+
+} // namespace pixel
+} // namespace ge
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "ge-hal/core.hpp"
+#include <cstdio>
+
+namespace ge {
+namespace hal {
+
+// CPU time spent in scenes and hal::gpu calls, per frame. Scopes only cost a
+// branch while the profiler is disabled. Each zone keeps the totals of its
+// last HISTORY frames, and every scope is also kept in a ring of trace
+// events that can be exported.
+namespace profiler {
+
+enum class Category : u8 { Frame, Tick, Render, Gpu };
+
+constexpr u32 MAX_ZONES = 64;
+constexpr u32 HISTORY = 128;
+#ifdef GE_HAL_STM32
+constexpr u32 MAX_EVENTS = 1024;
+#else
+constexpr u32 MAX_EVENTS = 16384;
+#endif
+
+using ZoneId = u32;
+
+void set_enabled(bool enabled);
+bool is_enabled();
+
+// Called by App::loop around each frame
+void begin_frame();
+void end_frame();
+
+// Zones are identified by name and category, names must outlive the profiler.
+// Past MAX_ZONES - 1 zones, new ones are all counted in a last "(other)" zone.
+ZoneId zone(const char *name, Category category);
+
+// A call site with a fixed name, which looks its zone up only once: see
+// GE_PROFILE_SCOPE
+class Site {
+public:
+  constexpr Site(const char *name, Category category)
+      : name{name}, category{category} {}
+
+  ZoneId get() {
+    if (!resolved) {
+      id = zone(name, category);
+      resolved = true;
+    }
+    return id;
+  }
+
+private:
+  const char *name;
+  Category category;
+  ZoneId id = 0;
+  bool resolved = false;
+};
+
+class Scope {
+public:
+  // For names only known at run time, e.g. Scene::name()
+  Scope(const char *name, Category category);
+  explicit Scope(Site &site);
+  ~Scope();
+
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+
+private:
+  void begin(ZoneId zone_id);
+
+  ZoneId id;
+  u32 start;
+  bool active;
+};
+
+struct ZoneStats {
+  const char *name;
+  Category category;
+  u32 depth;   // nesting depth the zone was first seen at
+  u32 samples; // frames in the history
+  float calls; // per frame
+  u32 min_us, avg_us, max_us, p99_us;
+};
+
+u32 zone_count();
+ZoneStats zone_stats(ZoneId id);
+
+void write_csv(std::FILE *out);
+void write_chrome_trace(std::FILE *out);
+// CSV over UART on STM, <GE_PROFILE_OUT or ge-profile>.{csv,json} on host
+void dump();
+
+// Implemented by each backend: a free-running counter
+u32 clock_ticks();
+u32 ticks_per_us();
+
+} // namespace profiler
+} // namespace hal
+} // namespace ge
+
+#define GE_PROFILE_CONCAT_(a, b) a##b
+#define GE_PROFILE_CONCAT(a, b) GE_PROFILE_CONCAT_(a, b)
+#define GE_PROFILE_SITE GE_PROFILE_CONCAT(ge_profile_site_, __LINE__)
+
+// Profiles the rest of the enclosing block as a zone named by a string
+// literal. The zone is cached in a static Site, so the scope does not search
+// the zones by name every time.
+#define GE_PROFILE_SCOPE(name, category)                                       \
+  static ::ge::hal::profiler::Site GE_PROFILE_SITE{name, category};            \
+  ::ge::hal::profiler::Scope GE_PROFILE_CONCAT(ge_profile_scope_,              \
+                                               __LINE__) {                     \
+    GE_PROFILE_SITE                                                            \
+  }
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ge-hal/app.hpp"
+#include "ge-hal/core.hpp"
+
+namespace ge {
+namespace hal {
+
+// Input recording and replay. With GE_RECORD=path, the backend logs the time
+// and joystick sample of every frame, the button events and the RNG seed.
+// With GE_REPLAY=path it plays them back instead of reading any input: the
+// SDL backend in real time, the headless backend as fast as possible. Both
+// give the same frames as the recorded session, as long as all of the game's
+// time, input and randomness goes through App and ge::rng.
+//
+// The frame times decide the ticks (ge-hal/timestep.hpp). While recording
+// or replaying, joystick samples are quantized to 16 bits, so that the
+// recorded session sees exactly what the replay will.
+//
+// Not available on STM32 (no file system), mode() is always Off there.
+namespace replay {
+
+enum class Mode : u8 { Off, Record, Replay };
+
+enum class ButtonEvent : u8 { Clicked, Held, FinishedHold };
+
+// Opens the file named by GE_RECORD or GE_REPLAY on first use
+Mode mode();
+
+// The RNG seed, recorded once at startup
+void record_seed(u64 seed);
+bool replayed_seed(u64 &seed);
+
+// Recording: record_frame() once per frame before anything else, then
+// record_joystick() with the frame's sample, which returns what the game has
+// to see
+void record_frame(i64 time);
+JoystickState record_joystick(JoystickState joystick);
+
+// Replay: the next frame, false once the recording ends. The frame's button
+// events are then returned by next_button(), in order.
+bool next_frame(i64 &time, JoystickState &joystick);
+bool next_button(ButtonEvent &event, Button &btn);
+
+// Sends a button event to the app, and records it if recording
+void button_event(App &app, ButtonEvent event, Button btn);
+
+// Flushes the recording, reports the end of a replay
+void finish();
+
+} // namespace replay
+} // namespace hal
+} // namespace ge
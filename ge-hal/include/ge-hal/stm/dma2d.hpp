@@ -1,7 +1,11 @@
 #pragma once
 #include "ge-hal/core.hpp"
 #include "ge-hal/surface.hpp"
+#ifdef GE_HAL_DMA2D_MODEL
+#include "ge-hal/stm/dma2d_model.hpp"
+#else
 #include "stm32f429xx.h"
+#endif
 
 namespace ge {
 namespace hal {
@@ -9,6 +13,18 @@ namespace stm {
 
 void init_dma2d();
 
+// Transfers are queued and chained from the transfer-complete interrupt, so
+// hal::gpu calls return before the DMA2D is done with them.
+struct Dma2dStats {
+  u32 submitted = 0;   // transfers and CLUT loads
+  u32 max_depth = 0;   // most transfers waiting behind the running one
+  u32 full_stalls = 0; // submissions that waited for a free queue slot
+  u32 errors = 0;      // transfer or configuration errors
+};
+
+const Dma2dStats &dma2d_stats();
+void reset_dma2d_stats();
+
 } // namespace stm
 } // namespace hal
 } // namespace ge
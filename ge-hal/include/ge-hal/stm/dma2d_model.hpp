@@ -0,0 +1,142 @@
+#pragma once
+
+// Host-side stand-in for the parts of stm32f429xx.h used by the DMA2D driver.
+//
+// Building src/stm/dma2d.cpp with GE_HAL_DMA2D_MODEL defined points DMA2D at
+// a plain register file instead of the peripheral. The model samples the
+// registers whenever simulated time advances (delay_spin() or
+// model::advance()), runs the transfer through ge-hal/sw/blit.hpp when it
+// completes, and raises DMA2D_IRQHandler() like the NVIC would.
+//
+// Address registers are pointer-sized, so that the driver can run on a 64-bit
+// host. Everything else uses the field widths of RM0090.
+
+#include "ge-hal/core.hpp"
+
+struct DMA2D_TypeDef {
+  volatile ge::u32 CR;
+  volatile ge::u32 ISR;
+  volatile ge::u32 IFCR;
+  volatile ge::usize FGMAR;
+  volatile ge::u32 FGOR;
+  volatile ge::usize BGMAR;
+  volatile ge::u32 BGOR;
+  volatile ge::u32 FGPFCCR;
+  volatile ge::u32 FGCOLR;
+  volatile ge::u32 BGPFCCR;
+  volatile ge::u32 BGCOLR;
+  volatile ge::usize FGCMAR;
+  volatile ge::usize BGCMAR;
+  volatile ge::u32 OPFCCR;
+  volatile ge::u32 OCOLR;
+  volatile ge::usize OMAR;
+  volatile ge::u32 OOR;
+  volatile ge::u32 NLR;
+  volatile ge::u32 LWR;
+  volatile ge::u32 AMTCR;
+};
+
+struct RCC_TypeDef {
+  volatile ge::u32 AHB1ENR;
+};
+
+enum IRQn_Type { DMA2D_IRQn = 90 };
+
+extern "C" void DMA2D_IRQHandler();
+
+namespace ge {
+namespace hal {
+namespace stm {
+namespace model {
+
+extern DMA2D_TypeDef dma2d_regs;
+extern RCC_TypeDef rcc_regs;
+
+struct Stats {
+  u64 cycles = 0;       // simulated time
+  u64 busy_cycles = 0;  // cycles with a transfer in flight
+  u64 wait_cycles = 0;  // cycles the CPU spent in delay_spin()
+  u64 idle_waits = 0;   // of those, cycles with nothing in flight
+  u32 transfers = 0;    // completed transfers, including CLUT loads
+  u32 irqs = 0;         // DMA2D_IRQHandler() calls
+  u32 config_errors = 0;
+};
+
+// Run the model for the given number of CPU cycles. cpu_waiting tells the
+// model whether the CPU is blocked on the DMA2D during that time.
+void advance(u64 cycles, bool cpu_waiting = false);
+
+const Stats &stats();
+void reset();
+
+// NVIC, as seen by the model
+void set_irq_enabled(bool enabled);
+
+} // namespace model
+} // namespace stm
+} // namespace hal
+} // namespace ge
+
+#define DMA2D (&ge::hal::stm::model::dma2d_regs)
+#define RCC (&ge::hal::stm::model::rcc_regs)
+
+inline void NVIC_SetPriority(IRQn_Type, ge::u32) {}
+inline void NVIC_EnableIRQ(IRQn_Type) {
+  ge::hal::stm::model::set_irq_enabled(true);
+}
+inline void NVIC_DisableIRQ(IRQn_Type) {
+  ge::hal::stm::model::set_irq_enabled(false);
+}
+
+#define RCC_AHB1ENR_DMA2DEN (1UL << 23)
+
+#define DMA2D_CR_START_Pos (0U)
+#define DMA2D_CR_START (1UL << DMA2D_CR_START_Pos)
+#define DMA2D_CR_SUSP (1UL << 1)
+#define DMA2D_CR_ABORT (1UL << 2)
+#define DMA2D_CR_TEIE (1UL << 8)
+#define DMA2D_CR_TCIE (1UL << 9)
+#define DMA2D_CR_TWIE (1UL << 10)
+#define DMA2D_CR_CAEIE (1UL << 11)
+#define DMA2D_CR_CTCIE (1UL << 12)
+#define DMA2D_CR_CEIE (1UL << 13)
+#define DMA2D_CR_MODE_Pos (16U)
+#define DMA2D_CR_MODE_Msk (0x3UL << DMA2D_CR_MODE_Pos)
+#define DMA2D_CR_MODE DMA2D_CR_MODE_Msk
+
+#define DMA2D_ISR_TEIF (1UL << 0)
+#define DMA2D_ISR_TCIF (1UL << 1)
+#define DMA2D_ISR_TWIF (1UL << 2)
+#define DMA2D_ISR_CAEIF (1UL << 3)
+#define DMA2D_ISR_CTCIF (1UL << 4)
+#define DMA2D_ISR_CEIF (1UL << 5)
+
+#define DMA2D_IFCR_CTEIF (1UL << 0)
+#define DMA2D_IFCR_CTCIF (1UL << 1)
+#define DMA2D_IFCR_CTWIF (1UL << 2)
+#define DMA2D_IFCR_CAECIF (1UL << 3)
+#define DMA2D_IFCR_CCTCIF (1UL << 4)
+#define DMA2D_IFCR_CCEIF (1UL << 5)
+
+#define DMA2D_FGPFCCR_CM_Pos (0U)
+#define DMA2D_FGPFCCR_CM_Msk (0xFUL << DMA2D_FGPFCCR_CM_Pos)
+#define DMA2D_FGPFCCR_CCM_Pos (4U)
+#define DMA2D_FGPFCCR_CCM (1UL << DMA2D_FGPFCCR_CCM_Pos)
+#define DMA2D_FGPFCCR_START (1UL << 5)
+#define DMA2D_FGPFCCR_CS_Pos (8U)
+#define DMA2D_FGPFCCR_CS_Msk (0xFFUL << DMA2D_FGPFCCR_CS_Pos)
+#define DMA2D_FGPFCCR_CS DMA2D_FGPFCCR_CS_Msk
+#define DMA2D_FGPFCCR_AM_Pos (16U)
+#define DMA2D_FGPFCCR_AM_Msk (0x3UL << DMA2D_FGPFCCR_AM_Pos)
+#define DMA2D_FGPFCCR_ALPHA_Pos (24U)
+#define DMA2D_FGPFCCR_ALPHA_Msk (0xFFUL << DMA2D_FGPFCCR_ALPHA_Pos)
+
+#define DMA2D_OPFCCR_CM_Msk (0x7UL)
+#define DMA2D_OOR_LO_Msk (0x3FFFUL)
+#define DMA2D_FGOR_LO_Msk (0x3FFFUL)
+#define DMA2D_BGOR_LO_Msk (0x3FFFUL)
+
+#define DMA2D_NLR_NL_Pos (0U)
+#define DMA2D_NLR_NL_Msk (0xFFFFUL << DMA2D_NLR_NL_Pos)
+#define DMA2D_NLR_PL_Pos (16U)
+#define DMA2D_NLR_PL_Msk (0x3FFFUL << DMA2D_NLR_PL_Pos)
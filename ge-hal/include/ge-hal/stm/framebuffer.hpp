@@ -10,8 +10,11 @@ void init_ltdc();
 
 u16 *pixel_buffer(int buffer_index);
 
-// Begin a new frame - returns true if vblank occurred and we should render
-bool begin_frame(u32 &buffer_index);
+// Begin a new frame - returns true if vblank occurred and we should render.
+// With present set, the previous frame is swapped in once render_fence has
+// been reached. Otherwise the screen keeps showing the current buffer and
+// buffer_index stays the same.
+bool begin_frame(u32 &buffer_index, u32 render_fence, bool present);
 
 } // namespace stm
 } // namespace hal
@@ -0,0 +1,22 @@
+#pragma once
+#include "ge-hal/core.hpp"
+#ifdef GE_HAL_LTDC_MODEL
+#include "ge-hal/stm/ltdc_model.hpp"
+#else
+#include "stm32f429xx.h"
+#endif
+
+namespace ge {
+namespace hal {
+namespace stm {
+
+// Programs LTDC_Layer1 and LTDC_Layer2 for the current hal::layers state,
+// with framebuffer on the background layer unless it has a buffer of its
+// own. The registers are shadowed: they take effect at the next reload
+// (LTDC->SRCR). The layer windows are placed from BPCR, so the timings must
+// be set up first.
+void write_layer_registers(const u16 *framebuffer);
+
+} // namespace stm
+} // namespace hal
+} // namespace ge
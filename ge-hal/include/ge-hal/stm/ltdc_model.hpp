@@ -0,0 +1,122 @@
+#pragma once
+
+// Host-side stand-in for the parts of stm32f429xx.h used to program the LTDC
+// layers.
+//
+// Building src/stm/ltdc.cpp with GE_HAL_LTDC_MODEL defined points LTDC,
+// LTDC_Layer1 and LTDC_Layer2 at plain register files. Like on the board,
+// the layer registers written by the driver are shadow registers: the model
+// only sees them after a reload requested through SRCR, which happens at
+// model::vertical_blank(). model::scan_out() then reads the layers from
+// memory and blends them the way RM0090 describes, independently of
+// ge-hal/sw/compose.hpp.
+//
+// CFBAR is pointer-sized, so that the driver can run on a 64-bit host.
+// Everything else uses the field widths of RM0090.
+
+#include "ge-hal/core.hpp"
+
+struct LTDC_TypeDef {
+  volatile ge::u32 SSCR;
+  volatile ge::u32 BPCR;
+  volatile ge::u32 AWCR;
+  volatile ge::u32 TWCR;
+  volatile ge::u32 GCR;
+  volatile ge::u32 SRCR;
+  volatile ge::u32 BCCR;
+  volatile ge::u32 IER;
+  volatile ge::u32 ISR;
+  volatile ge::u32 ICR;
+  volatile ge::u32 LIPCR;
+  volatile ge::u32 CPSR;
+  volatile ge::u32 CDSR;
+};
+
+struct LTDC_Layer_TypeDef {
+  volatile ge::u32 CR;
+  volatile ge::u32 WHPCR;
+  volatile ge::u32 WVPCR;
+  volatile ge::u32 CKCR;
+  volatile ge::u32 PFCR;
+  volatile ge::u32 CACR;
+  volatile ge::u32 DCCR;
+  volatile ge::u32 BFCR;
+  volatile ge::usize CFBAR;
+  volatile ge::u32 CFBLR;
+  volatile ge::u32 CFBLNR;
+  volatile ge::u32 CLUTWR;
+};
+
+namespace ge {
+namespace hal {
+namespace stm {
+namespace model {
+
+extern LTDC_TypeDef ltdc_regs;
+// the shadow registers of LTDC_Layer1 and LTDC_Layer2
+extern LTDC_Layer_TypeDef layer_regs[2];
+
+// Performs the reload requested in SRCR, immediate or at vertical blanking
+// (both happen here), and clears the request
+void vertical_blank();
+
+// One frame of the active area, as 0x00RRGGBB, row by row
+void scan_out(u32 *pixels);
+
+// Number of layer configurations that the model could not scan out
+u32 config_errors();
+void reset();
+
+} // namespace model
+} // namespace stm
+} // namespace hal
+} // namespace ge
+
+#define LTDC (&ge::hal::stm::model::ltdc_regs)
+#define LTDC_Layer1 (&ge::hal::stm::model::layer_regs[0])
+#define LTDC_Layer2 (&ge::hal::stm::model::layer_regs[1])
+
+#define LTDC_SSCR_VSH_Pos (0U)
+#define LTDC_SSCR_HSW_Pos (16U)
+#define LTDC_BPCR_AVBP_Pos (0U)
+#define LTDC_BPCR_AVBP_Msk (0x7FFUL << LTDC_BPCR_AVBP_Pos)
+#define LTDC_BPCR_AHBP_Pos (16U)
+#define LTDC_BPCR_AHBP_Msk (0xFFFUL << LTDC_BPCR_AHBP_Pos)
+#define LTDC_AWCR_AAH_Pos (0U)
+#define LTDC_AWCR_AAH_Msk (0x7FFUL << LTDC_AWCR_AAH_Pos)
+#define LTDC_AWCR_AAW_Pos (16U)
+#define LTDC_AWCR_AAW_Msk (0xFFFUL << LTDC_AWCR_AAW_Pos)
+#define LTDC_TWCR_TOTALH_Pos (0U)
+#define LTDC_TWCR_TOTALW_Pos (16U)
+
+#define LTDC_SRCR_IMR (1UL << 0)
+#define LTDC_SRCR_VBR (1UL << 1)
+
+#define LTDC_LxCR_LEN (1UL << 0)
+#define LTDC_LxCR_COLKEN (1UL << 1)
+#define LTDC_LxCR_CLUTEN (1UL << 4)
+
+#define LTDC_LxWHPCR_WHSTPOS_Pos (0U)
+#define LTDC_LxWHPCR_WHSTPOS_Msk (0xFFFUL << LTDC_LxWHPCR_WHSTPOS_Pos)
+#define LTDC_LxWHPCR_WHSPPOS_Pos (16U)
+#define LTDC_LxWHPCR_WHSPPOS_Msk (0xFFFUL << LTDC_LxWHPCR_WHSPPOS_Pos)
+#define LTDC_LxWVPCR_WVSTPOS_Pos (0U)
+#define LTDC_LxWVPCR_WVSTPOS_Msk (0xFFFUL << LTDC_LxWVPCR_WVSTPOS_Pos)
+#define LTDC_LxWVPCR_WVSPPOS_Pos (16U)
+#define LTDC_LxWVPCR_WVSPPOS_Msk (0xFFFUL << LTDC_LxWVPCR_WVSPPOS_Pos)
+
+#define LTDC_LxPFCR_PF_Pos (0U)
+#define LTDC_LxPFCR_PF_Msk (0x7UL << LTDC_LxPFCR_PF_Pos)
+#define LTDC_LxCACR_CONSTA_Pos (0U)
+#define LTDC_LxCACR_CONSTA_Msk (0xFFUL << LTDC_LxCACR_CONSTA_Pos)
+#define LTDC_LxBFCR_BF2_Pos (0U)
+#define LTDC_LxBFCR_BF2_Msk (0x7UL << LTDC_LxBFCR_BF2_Pos)
+#define LTDC_LxBFCR_BF1_Pos (8U)
+#define LTDC_LxBFCR_BF1_Msk (0x7UL << LTDC_LxBFCR_BF1_Pos)
+
+#define LTDC_LxCFBLR_CFBLL_Pos (0U)
+#define LTDC_LxCFBLR_CFBLL_Msk (0x1FFFUL << LTDC_LxCFBLR_CFBLL_Pos)
+#define LTDC_LxCFBLR_CFBP_Pos (16U)
+#define LTDC_LxCFBLR_CFBP_Msk (0x1FFFUL << LTDC_LxCFBLR_CFBP_Pos)
+#define LTDC_LxCFBLNR_CFBLNBR_Pos (0U)
+#define LTDC_LxCFBLNR_CFBLNBR_Msk (0x7FFUL << LTDC_LxCFBLNR_CFBLNBR_Pos)
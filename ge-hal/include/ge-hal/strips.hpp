@@ -0,0 +1,35 @@
+#pragma once
+
+#include "ge-hal/core.hpp"
+#include "ge-hal/surface.hpp"
+
+namespace ge {
+class App;
+
+namespace hal {
+
+// Strip rendering: App::loop renders the frame as horizontal bands of a few
+// rows into a small scratch buffer (in the internal SRAM on STM32, instead
+// of the framebuffer in SDRAM) and copies each band to the framebuffer.
+// App::render is called once per band, with a band surface of the whole
+// frame (see BaseSurface::band()), so that scenes keep drawing in frame
+// coordinates. Only frames that App::is_opaque() are drawn in bands, as a
+// band starts out with none of the framebuffer's pixels.
+namespace strips {
+
+// The size of the scratch buffer, 240x40 RGB565 is 19 KB
+constexpr u32 MAX_HEIGHT = 40;
+
+// Rows per band, clamped to MAX_HEIGHT, 0 renders whole frames. Defaults to
+// GE_STRIP_HEIGHT, from CMake, and the GE_STRIP_HEIGHT environment variable
+// on PC.
+void set_height(u32 rows);
+u32 height();
+
+// Renders a frame of app into fb, whole or band by band, then calls
+// App::on_rendered(). The frame's damage is left in damage::current().
+void render_frame(App &app, const Surface &fb);
+
+} // namespace strips
+} // namespace hal
+} // namespace ge
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ge-hal/core.hpp"
+#include <algorithm>
 #include <cassert>
 #include <type_traits>
 
@@ -59,6 +60,10 @@ inline bool has_alpha_channel(PixelFormat fmt) {
   }
 }
 
+// A rectangle of pixels in memory. With strip rendering (see hal::strips) a
+// surface can cover the whole frame while only some of its rows, a band, are
+// backed by memory: hal::gpu clips what it draws to those rows, and CPU
+// drawing has to clip its rows to [get_row_begin(), get_row_end()) too.
 template <class ElemT> class BaseSurface {
 public:
   BaseSurface(std::nullptr_t = nullptr) {}
@@ -66,29 +71,50 @@ public:
               PixelFormat fmt = PixelFormat::RGB565,
               u32 buffer_index = BUFFER_INDEX_NONE)
       : fb_ptr(fb_ptr), stride(stride), width(width), height(height),
-        buffer_index{buffer_index}, fmt{fmt} {}
+        buffer_index{buffer_index}, row_end{height}, fmt{fmt} {}
+
+  // A width x height surface of which only the rows [y, y + h) are backed,
+  // by the h rows at rows. Its pixels keep their coordinates in the whole
+  // surface, and the data() of it and its subsurfaces are where row 0 would
+  // be: those are only for address arithmetic, never dereferenced.
+  static BaseSurface band(ElemT *rows, u32 stride, u32 width, u32 height,
+                          u32 y, u32 h, PixelFormat fmt = PixelFormat::RGB565,
+                          u32 buffer_index = BUFFER_INDEX_NONE) {
+    BaseSurface result(offset(rows, -isize(y) * stride, fmt), stride, width,
+                       height, fmt, buffer_index);
+    result.row_begin = std::min(y, height);
+    result.row_end = std::min(y + h, height);
+    return result;
+  }
 
   BaseSurface<ElemT> subsurface(u32 x, u32 y, u32 w, u32 h) const {
+    if (x >= width || y >= height)
+      return BaseSurface(nullptr, stride, 0, 0, fmt, buffer_index);
     if (x + w > width)
       w = width - x;
     if (y + h > height)
       h = height - y;
-    return BaseSurface(pixel_at(x, y), stride, w, h, fmt, buffer_index);
+    BaseSurface result(offset(fb_ptr, isize(y) * stride + x, fmt), stride, w,
+                       h, fmt, buffer_index);
+    result.row_begin = std::min(row_begin - std::min(row_begin, y), h);
+    result.row_end = std::min(row_end - std::min(row_end, y), h);
+    return result;
   }
 
   u32 get_width() const { return width; }
   u32 get_height() const { return height; }
   u32 get_stride() const { return stride; }
   u32 get_buffer_index() const { return buffer_index; }
+  u32 get_row_begin() const { return row_begin; }
+  u32 get_row_end() const { return row_end; }
+  // Whether all of the surface is in memory, i.e. it is not part of a band
+  bool is_backed() const { return row_begin == 0 && row_end == height; }
   PixelFormat get_pixel_format() const { return fmt; }
 
   ElemT *pixel_at(u32 x, u32 y) const {
-    if (x >= width || y >= height)
+    if (x >= width || y < row_begin || y >= row_end)
       return nullptr;
-    using ByteT = std::conditional_t<std::is_const<ElemT>::value, const u8, u8>;
-    auto ptr = static_cast<ByteT *>(fb_ptr);
-    return reinterpret_cast<ElemT *>(
-        &ptr[(y * stride + x) * pixel_format_bpp(fmt) / 8]);
+    return offset(fb_ptr, isize(y) * stride + x, fmt);
   }
 
   template <class ColorT, class E = ElemT,
@@ -146,14 +172,29 @@ public:
   ElemT *data() const { return fb_ptr; }
 
   BaseSurface<const ElemT> as_const() const {
-    return BaseSurface<const ElemT>(fb_ptr, stride, width, height, fmt,
+    BaseSurface<const ElemT> result(fb_ptr, stride, width, height, fmt,
                                     buffer_index);
+    result.row_begin = row_begin;
+    result.row_end = row_end;
+    return result;
   }
 
 private:
   static constexpr u32 BUFFER_INDEX_NONE = -1;
+
+  // ptr moved by the given number of pixels
+  static ElemT *offset(ElemT *ptr, isize pixels, PixelFormat fmt) {
+    auto address = reinterpret_cast<usize>(ptr);
+    address += pixels * isize(pixel_format_bpp(fmt)) / 8;
+    return reinterpret_cast<ElemT *>(address);
+  }
+
+  template <class> friend class BaseSurface;
+
   ElemT *fb_ptr = nullptr;
   u32 stride = 0, width = 0, height = 0, buffer_index = BUFFER_INDEX_NONE;
+  // the rows in memory
+  u32 row_begin = 0, row_end = 0;
   PixelFormat fmt = PixelFormat::RGB565;
 };
 
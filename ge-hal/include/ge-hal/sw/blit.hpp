@@ -0,0 +1,30 @@
+#pragma once
+
+#include "ge-hal/surface.hpp"
+
+namespace ge {
+namespace hal {
+
+// Software implementation of the hal::gpu operations.
+//
+// This is what the PC backend runs. It follows the DMA2D pixel format
+// conversion and blending rules (RM0090, DMA2D chapter), so that a frame
+// rendered on PC looks the same as one rendered on the board.
+//
+// Hot format pairs have dedicated SSE2/AVX2 kernels, everything else goes
+// through a generic ARGB8888 intermediate row.
+namespace sw {
+
+void fill(Surface dst, u32 color);
+void blit(Surface dst, ConstSurface src);
+void blit_blend(Surface dst, ConstSurface src, u8 global_alpha);
+void blit_blend_premultiplied(Surface dst, ConstSurface src, u8 global_alpha);
+void blit_blend_alpha(Surface dst, ConstSurface src, u32 color,
+                      u8 global_alpha);
+
+void load_palette(u32 const *colors, usize num_colors);
+void blit_indexed(Surface dst, ConstSurface src);
+
+} // namespace sw
+} // namespace hal
+} // namespace ge
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "ge-hal/surface.hpp"
+
+namespace ge {
+namespace hal {
+namespace sw {
+
+// Software implementation of the LTDC layer blending (RM0090, LTDC chapter),
+// for the PC backend to show what hal::layers would look like on the board.
+//
+// Starting from the black background color, each layer is blended over the
+// ones below it with the blending factors pixel alpha x constant alpha and
+// 1 - pixel alpha x constant alpha, in 8 bits per channel. Layers are drawn
+// at the origin of dst and clipped to it.
+struct ComposeLayer {
+  ConstSurface pixels;
+  u8 alpha;
+};
+
+// layers[0] is the bottom layer. Supports the formats with pixel::Traits.
+void compose(Surface dst, const ComposeLayer *layers, u32 num_layers);
+
+} // namespace sw
+} // namespace hal
+} // namespace ge
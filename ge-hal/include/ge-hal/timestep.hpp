@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ge-hal/core.hpp"
+
+namespace ge {
+namespace hal {
+
+// Fixed-step simulation. App::loop() ticks the game at TICK_RATE, however
+// often it renders: each frame, advance() to the backend's clock, then one
+// App::tick(TICK_DT) per next_tick(), then render() once. When the clock ran
+// away (a slow frame, a breakpoint), at most MAX_CATCH_UP ticks are run and
+// the rest of the time is dropped, the game slows down instead of spiralling.
+//
+// App::now() is the simulation time, which only moves with the ticks: the
+// game gives the same results for the same frame times and input, whether
+// it rendered every frame or not. The simulation runs at most one tick ahead
+// of the clock, and alpha() tells render() where the clock is between the
+// last two ticks, to draw what moves in between.
+namespace timestep {
+
+constexpr u32 TICK_RATE = 60;
+constexpr float TICK_DT = 1.0f / TICK_RATE;
+constexpr u32 MAX_CATCH_UP = 4;
+
+// Restarts the simulation at simulation time `time`, lined up with the clock
+// of the next advance()
+void reset(i64 time = 0);
+
+// Schedules the ticks due at clock time `clock` (in ms), at most max_ticks
+void advance(i64 clock, u32 max_ticks = MAX_CATCH_UP);
+
+// Moves the simulation time to the next scheduled tick, false when there is
+// none left
+bool next_tick();
+
+// Simulation time in ms: the time of the current, or the last tick
+i64 now();
+
+// Ticks since reset()
+u64 tick_count();
+
+// 0..1, from the previous tick to the last one
+float alpha();
+
+// Position of something that moved from `prev` to `cur` during tick
+// `moved_at`, at the current alpha(). What did not move during the last tick
+// is simply where it is.
+inline float interpolate(float prev, float cur, u64 moved_at) {
+  if (moved_at != tick_count())
+    return cur;
+  return cur - (cur - prev) * (1.0f - alpha());
+}
+
+} // namespace timestep
+} // namespace hal
+} // namespace ge
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "ge-hal/pixel.hpp"
+#include "ge-hal/surface.hpp"
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+namespace ge {
+
+// A surface whose pixel format is known at compile time. Pixels are reached
+// through typed row pointers without bounds checks: clip once, then loop.
+// Like the CPU drawing it is meant for, it does not synchronize with
+// hal::gpu nor mark damage, callers do. Only the rows [get_row_begin(),
+// get_row_end()) may be touched, see BaseSurface::band().
+template <PixelFormat pixel_format, class ElemT> class BaseTypedSurface {
+public:
+  static constexpr PixelFormat format = pixel_format;
+  using traits = pixel::Traits<format>;
+  using value_type =
+      std::conditional_t<std::is_const<ElemT>::value,
+                         const typename traits::type, typename traits::type>;
+
+  static_assert(traits::bpp == pixel_format_bpp(format), "bpp mismatch");
+
+  class Row {
+  public:
+    Row(value_type *ptr, u32 width) : ptr(ptr), width(width) {}
+    value_type *begin() const { return ptr; }
+    value_type *end() const { return ptr + width; }
+    u32 size() const { return width; }
+    value_type &operator[](u32 x) const { return ptr[x]; }
+
+  private:
+    value_type *ptr;
+    u32 width;
+  };
+
+  explicit BaseTypedSurface(const BaseSurface<ElemT> &surface)
+      : surface(surface) {
+    assert(surface.get_pixel_format() == format);
+  }
+
+  u32 get_width() const { return surface.get_width(); }
+  u32 get_height() const { return surface.get_height(); }
+  u32 get_stride() const { return surface.get_stride(); }
+  u32 get_row_begin() const { return surface.get_row_begin(); }
+  u32 get_row_end() const { return surface.get_row_end(); }
+
+  // The untyped surface, for hal::gpu and hal::damage
+  const BaseSurface<ElemT> &untyped() const { return surface; }
+
+  BaseTypedSurface subsurface(u32 x, u32 y, u32 w, u32 h) const {
+    return BaseTypedSurface{surface.subsurface(x, y, w, h)};
+  }
+
+  value_type *data() const { return static_cast<value_type *>(surface.data()); }
+  Row row(u32 y) const {
+    return Row{data() + usize(y) * get_stride(), get_width()};
+  }
+  value_type &at(u32 x, u32 y) const {
+    return data()[usize(y) * get_stride() + x];
+  }
+
+private:
+  BaseSurface<ElemT> surface;
+};
+
+template <PixelFormat format>
+using TypedSurface = BaseTypedSurface<format, void>;
+template <PixelFormat format>
+using ConstTypedSurface = BaseTypedSurface<format, const void>;
+
+// Calls fn once with surface as the BaseTypedSurface of its format, so that
+// the loops in fn are compiled per format. Returns false for the formats
+// without pixel::Traits.
+template <class ElemT, class Fn>
+bool visit(const BaseSurface<ElemT> &surface, Fn &&fn) {
+  switch (surface.get_pixel_format()) {
+  case PixelFormat::RGB565:
+    fn(BaseTypedSurface<PixelFormat::RGB565, ElemT>{surface});
+    return true;
+  case PixelFormat::ARGB1555:
+    fn(BaseTypedSurface<PixelFormat::ARGB1555, ElemT>{surface});
+    return true;
+  case PixelFormat::ARGB4444:
+    fn(BaseTypedSurface<PixelFormat::ARGB4444, ElemT>{surface});
+    return true;
+  case PixelFormat::ARGB8888:
+    fn(BaseTypedSurface<PixelFormat::ARGB8888, ElemT>{surface});
+    return true;
+  default:
+    return false;
+  }
+}
+
+namespace pixel {
+
+// --- Spans ---
+
+template <PixelFormat format>
+inline void fill_span(type_t<format> *d, u32 n, type_t<format> color) {
+  std::fill_n(d, n, color);
+}
+
+template <PixelFormat dst, PixelFormat src>
+inline void convert_span(type_t<dst> *d, const type_t<src> *s, u32 n) {
+  if (dst == src) {
+    std::memcpy(d, s, n * sizeof(*d));
+    return;
+  }
+  for (u32 i = 0; i < n; ++i)
+    d[i] = convert<dst, src>(s[i]);
+}
+
+template <PixelFormat dst, PixelFormat src>
+inline void blend_span(type_t<dst> *d, const type_t<src> *s, u32 n,
+                       u8 alpha = 0xFF) {
+  if (!Traits<src>::has_alpha && alpha == 0xFF) {
+    convert_span<dst, src>(d, s, n);
+    return;
+  }
+  for (u32 i = 0; i < n; ++i)
+    blend_pixel<dst>(d[i], Traits<src>::unpack(s[i]), alpha);
+}
+
+template <PixelFormat dst, PixelFormat src>
+inline void blend_premultiplied_span(type_t<dst> *d, const type_t<src> *s,
+                                     u32 n, u8 alpha = 0xFF) {
+  if (alpha == 0xFF) {
+    for (u32 i = 0; i < n; ++i)
+      blend_premultiplied_pixel<dst>(d[i], Traits<src>::unpack(s[i]));
+    return;
+  }
+  for (u32 i = 0; i < n; ++i)
+    blend_premultiplied_pixel<dst>(d[i], Traits<src>::unpack(s[i]), alpha);
+}
+
+// --- Rectangles, src and dst clipped to the smaller of the two ---
+// (and to the rows of dst in memory)
+
+template <PixelFormat format>
+inline void fill(TypedSurface<format> dst, type_t<format> color) {
+  for (u32 y = dst.get_row_begin(); y < dst.get_row_end(); ++y)
+    fill_span<format>(dst.row(y).begin(), dst.get_width(), color);
+}
+
+template <PixelFormat dst_format, PixelFormat src_format>
+inline void copy(TypedSurface<dst_format> dst,
+                 ConstTypedSurface<src_format> src) {
+  u32 w = std::min(dst.get_width(), src.get_width());
+  u32 h = std::min(dst.get_row_end(), src.get_height());
+  for (u32 y = dst.get_row_begin(); y < h; ++y)
+    convert_span<dst_format, src_format>(dst.row(y).begin(),
+                                         src.row(y).begin(), w);
+}
+
+template <PixelFormat dst_format, PixelFormat src_format>
+inline void blend(TypedSurface<dst_format> dst,
+                  ConstTypedSurface<src_format> src, u8 alpha = 0xFF) {
+  u32 w = std::min(dst.get_width(), src.get_width());
+  u32 h = std::min(dst.get_row_end(), src.get_height());
+  for (u32 y = dst.get_row_begin(); y < h; ++y)
+    blend_span<dst_format, src_format>(dst.row(y).begin(), src.row(y).begin(),
+                                       w, alpha);
+}
+
+template <PixelFormat dst_format, PixelFormat src_format>
+inline void blend_premultiplied(TypedSurface<dst_format> dst,
+                                ConstTypedSurface<src_format> src,
+                                u8 alpha = 0xFF) {
+  u32 w = std::min(dst.get_width(), src.get_width());
+  u32 h = std::min(dst.get_row_end(), src.get_height());
+  for (u32 y = dst.get_row_begin(); y < h; ++y)
+    blend_premultiplied_span<dst_format, src_format>(
+        dst.row(y).begin(), src.row(y).begin(), w, alpha);
+}
+
+} // namespace pixel
+} // namespace ge
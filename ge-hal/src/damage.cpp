@@ -0,0 +1,134 @@
+#include "ge-hal/damage.hpp"
+#include <algorithm>
+
+namespace ge {
+namespace hal {
+namespace damage {
+
+namespace {
+
+Surface framebuffer;
+Region region;
+
+u32 area_of(const Rect &r) { return r.w * r.h; }
+
+Rect union_of(const Rect &a, const Rect &b) {
+  u32 x = std::min(a.x, b.x), y = std::min(a.y, b.y);
+  return {x, y, std::max(a.right(), b.right()) - x,
+          std::max(a.bottom(), b.bottom()) - y};
+}
+
+bool contains(const Rect &outer, const Rect &inner) {
+  return inner.x >= outer.x && inner.y >= outer.y &&
+         inner.right() <= outer.right() && inner.bottom() <= outer.bottom();
+}
+
+// Overlapping or sharing an edge
+bool touches(const Rect &a, const Rect &b) {
+  return a.x <= b.right() && b.x <= a.right() && a.y <= b.bottom() &&
+         b.y <= a.bottom();
+}
+
+} // namespace
+
+Rect Region::bounds() const {
+  if (count == 0)
+    return {};
+  Rect result = rects[0];
+  for (u32 i = 1; i < count; ++i)
+    result = union_of(result, rects[i]);
+  return result;
+}
+
+u32 Region::area() const {
+  u32 total = 0;
+  for (u32 i = 0; i < count; ++i)
+    total += area_of(rects[i]);
+  return total;
+}
+
+void Region::add(Rect rect) {
+  if (rect.empty())
+    return;
+
+  // Grow rect until it neither touches nor contains any of the others
+  for (u32 i = 0; i < count;) {
+    if (contains(rects[i], rect))
+      return;
+    if (touches(rects[i], rect)) {
+      rect = union_of(rects[i], rect);
+      rects[i] = rects[--count];
+      i = 0;
+      continue;
+    }
+    ++i;
+  }
+
+  if (count < MAX_RECTS) {
+    rects[count++] = rect;
+    return;
+  }
+
+  // Full: merge with whichever rect grows the least
+  u32 best = 0, best_growth = ~0u;
+  for (u32 i = 0; i < count; ++i) {
+    u32 growth = area_of(union_of(rects[i], rect)) - area_of(rects[i]);
+    if (growth < best_growth) {
+      best = i;
+      best_growth = growth;
+    }
+  }
+  Rect merged = union_of(rects[best], rect);
+  rects[best] = rects[--count];
+  add(merged);
+}
+
+void begin_frame(const Surface &fb) {
+  framebuffer = fb;
+  region.clear();
+}
+
+void begin_band(const Surface &band) { framebuffer = band; }
+
+void mark(Rect rect) {
+  // clip to the framebuffer
+  u32 w = framebuffer.get_width(), h = framebuffer.get_height();
+  if (rect.x >= w || rect.y >= h)
+    return;
+  rect.w = std::min(rect.w, w - rect.x);
+  rect.h = std::min(rect.h, h - rect.y);
+  region.add(rect);
+}
+
+void mark(const Surface &surface) {
+  if (!framebuffer.data() ||
+      surface.get_buffer_index() != framebuffer.get_buffer_index() ||
+      surface.get_stride() != framebuffer.get_stride() ||
+      surface.get_pixel_format() != framebuffer.get_pixel_format())
+    return;
+
+  auto base = static_cast<const u8 *>(framebuffer.data());
+  auto ptr = static_cast<const u8 *>(surface.data());
+  usize pitch = framebuffer.get_stride() *
+                pixel_format_bpp(framebuffer.get_pixel_format()) / 8;
+  if (pitch == 0 || ptr < base)
+    return;
+  usize offset = ptr - base;
+  u32 y = offset / pitch;
+  u32 x = (offset % pitch) * 8 /
+          pixel_format_bpp(framebuffer.get_pixel_format());
+  // only the rows in memory can have been drawn to
+  u32 row_begin = surface.get_row_begin();
+  mark(Rect{x, y + row_begin, surface.get_width(),
+            surface.get_row_end() - row_begin});
+}
+
+void mark_all() {
+  mark(Rect{0, 0, framebuffer.get_width(), framebuffer.get_height()});
+}
+
+const Region &current() { return region; }
+
+} // namespace damage
+} // namespace hal
+} // namespace ge
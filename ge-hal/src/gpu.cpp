@@ -0,0 +1,425 @@
+#include "ge-hal/gpu.hpp"
+#include "ge-hal/damage.hpp"
+#include "ge-hal/profiler.hpp"
+#include "gpu_backend.hpp"
+#include <algorithm>
+#include <cassert>
+
+namespace ge {
+namespace hal {
+namespace gpu {
+
+namespace {
+
+struct Command {
+  enum class Op : u8 {
+    None,
+    Fill,
+    Blit,
+    BlitBlend,
+    BlitBlendPremultiplied,
+    BlitBlendAlpha,
+    BlitIndexed
+  };
+
+  Op op = Op::None;
+  u8 global_alpha = 0xFF;
+  u32 color = 0; // Fill, BlitBlendAlpha
+  Surface dst;
+  ConstSurface src;
+};
+
+// The list is flushed early when full. A busy frame is well over this, so it
+// is a batching window rather than a whole frame.
+constexpr usize MAX_COMMANDS = 256;
+// How far back we look for fills to merge and outputs to drop. Bounded so
+// that recording stays O(1) per command.
+constexpr usize LOOKBACK = 32;
+
+Command commands[MAX_COMMANDS];
+usize num_commands = 0;
+bool deferred = false;
+CommandStats stats;
+
+// The palette the backend has. Palettes are constant tables, so drawing
+// several textures with the same one loads it only once.
+const u32 *loaded_palette = nullptr;
+usize loaded_palette_size = 0;
+
+// --- Memory regions ---
+// Surfaces are compared as byte rectangles, so that subsurfaces of the same
+// buffer can be checked for overlap without knowing where the buffer starts.
+
+struct Region {
+  usize start = 0;
+  usize pitch = 0; // bytes from one row to the next
+  usize width = 0; // bytes per row
+  u32 height = 0;
+
+  bool empty() const { return width == 0 || height == 0; }
+  usize end() const { return start + (height - 1) * pitch + width; }
+};
+
+template <class T> Region region_of(const BaseSurface<T> &s) {
+  usize bpp = pixel_format_bpp(s.get_pixel_format());
+  return {reinterpret_cast<usize>(s.data()), s.get_stride() * bpp / 8,
+          (s.get_width() * bpp + 7) / 8, s.get_height()};
+}
+
+// Position of b inside the row grid of a. Returns false when the two
+// regions can't be laid on a common grid.
+bool locate(const Region &a, const Region &b, isize &row, isize &col) {
+  if (a.pitch == 0 || (a.pitch != b.pitch && b.height > 1))
+    return false;
+  isize pitch = a.pitch;
+  isize offset = static_cast<isize>(b.start - a.start);
+  row = offset / pitch;
+  col = offset % pitch;
+  if (col < 0) {
+    col += pitch;
+    --row;
+  }
+  // b would wrap around a's rows
+  return col + static_cast<isize>(b.width) <= pitch;
+}
+
+bool contains(const Region &outer, const Region &inner) {
+  if (inner.empty())
+    return true;
+  isize row, col;
+  if (!locate(outer, inner, row, col))
+    return false;
+  return row >= 0 && row + inner.height <= outer.height &&
+         col + inner.width <= outer.width;
+}
+
+bool overlaps(const Region &a, const Region &b) {
+  if (a.empty() || b.empty())
+    return false;
+  isize row, col;
+  if (!locate(a, b, row, col))
+    return a.start < b.end() && b.start < a.end();
+  return row < static_cast<isize>(a.height) && row + b.height > 0 &&
+         col < static_cast<isize>(a.width);
+}
+
+bool has_src(const Command &cmd) {
+  return cmd.op != Command::Op::None && cmd.op != Command::Op::Fill;
+}
+
+// Whether cmd reads or writes anything inside r
+bool touches(const Command &cmd, const Region &r) {
+  if (cmd.op == Command::Op::None)
+    return false;
+  return overlaps(region_of(cmd.dst), r) ||
+         (has_src(cmd) && overlaps(region_of(cmd.src), r));
+}
+
+// Whether cmd reads anything inside r
+bool reads(const Command &cmd, const Region &r) {
+  switch (cmd.op) {
+  case Command::Op::None:
+  case Command::Op::Fill:
+    return false;
+  case Command::Op::BlitBlend:
+  case Command::Op::BlitBlendPremultiplied:
+  case Command::Op::BlitBlendAlpha:
+    // the destination is the blending background
+    if (overlaps(region_of(cmd.dst), r))
+      return true;
+    break;
+  default:
+    break;
+  }
+  return overlaps(region_of(cmd.src), r);
+}
+
+// Whether cmd overwrites every pixel of its destination, regardless of what
+// was there before
+bool is_opaque(const Command &cmd) {
+  switch (cmd.op) {
+  case Command::Op::Fill:
+  case Command::Op::Blit:
+  case Command::Op::BlitIndexed:
+    return true;
+  case Command::Op::BlitBlend: {
+    auto fmt = cmd.src.get_pixel_format();
+    return cmd.global_alpha == 0xFF &&
+           (fmt == PixelFormat::RGB565 || fmt == PixelFormat::RGB888);
+  }
+  default:
+    return false;
+  }
+}
+
+// Grow fill a so that it also covers b, if the result is still a rectangle
+bool try_merge(Surface &a, const Surface &b) {
+  if (a.get_pixel_format() != b.get_pixel_format() ||
+      pixel_format_bpp(a.get_pixel_format()) < 8)
+    return false;
+
+  auto ra = region_of(a), rb = region_of(b);
+  auto fmt = a.get_pixel_format();
+  auto index = a.get_buffer_index();
+
+  // stacked rows of the same columns
+  if (ra.pitch == rb.pitch && ra.width == rb.width) {
+    u32 h = a.get_height() + b.get_height();
+    if (rb.start == ra.start + ra.height * ra.pitch) {
+      a = Surface{a.data(), a.get_stride(), a.get_width(), h, fmt, index};
+      return true;
+    }
+    if (ra.start == rb.start + rb.height * rb.pitch) {
+      a = Surface{b.data(), a.get_stride(), a.get_width(), h, fmt, index};
+      return true;
+    }
+  }
+
+  // single-row spans that touch end to end. Taller regions can't be merged
+  // this way since we don't know where their rows wrap.
+  if (ra.height == 1 && rb.height == 1) {
+    u32 w = a.get_width() + b.get_width();
+    if (rb.start == ra.start + ra.width) {
+      a = Surface{a.data(), a.get_stride(), w, 1, fmt, index};
+      return true;
+    }
+    if (ra.start == rb.start + rb.width) {
+      a = Surface{b.data(), a.get_stride(), w, 1, fmt, index};
+      return true;
+    }
+  }
+
+  return false;
+}
+
+usize lookback_begin() {
+  return num_commands > LOOKBACK ? num_commands - LOOKBACK : 0;
+}
+
+// Fold a fill into a recent fill of the same color. Commands in between
+// must not touch the new fill's region, since it effectively moves earlier.
+bool coalesce_fill(const Command &cmd) {
+  auto r = region_of(cmd.dst);
+  for (usize i = num_commands; i-- > lookback_begin();) {
+    auto &prev = commands[i];
+    if (prev.op == Command::Op::Fill && prev.color == cmd.color &&
+        prev.dst.get_pixel_format() == cmd.dst.get_pixel_format()) {
+      if (contains(region_of(prev.dst), r)) {
+        // already filled with this color
+        ++stats.dropped;
+        return true;
+      }
+      if (try_merge(prev.dst, cmd.dst)) {
+        ++stats.merged;
+        return true;
+      }
+    }
+    if (touches(prev, r))
+      return false;
+  }
+  return false;
+}
+
+// Drop recent commands whose output is completely covered by cmd
+void drop_overwritten(const Command &cmd) {
+  auto r = region_of(cmd.dst);
+  for (usize i = num_commands; i-- > lookback_begin();) {
+    auto &prev = commands[i];
+    if (prev.op == Command::Op::None)
+      continue;
+    auto prev_dst = region_of(prev.dst);
+    // cmd itself reads what prev wrote
+    if (has_src(cmd) && overlaps(prev_dst, region_of(cmd.src)))
+      return;
+    if (contains(r, prev_dst)) {
+      prev.op = Command::Op::None;
+      ++stats.dropped;
+      continue;
+    }
+    // prev needs the older content of r, so nothing before it is dead
+    if (reads(prev, r))
+      return;
+  }
+}
+
+void execute(const Command &cmd) {
+  switch (cmd.op) {
+  case Command::Op::None:
+    return;
+  case Command::Op::Fill:
+    backend::fill(cmd.dst, cmd.color);
+    break;
+  case Command::Op::Blit:
+    backend::blit(cmd.dst, cmd.src);
+    break;
+  case Command::Op::BlitBlend:
+    backend::blit_blend(cmd.dst, cmd.src, cmd.global_alpha);
+    break;
+  case Command::Op::BlitBlendPremultiplied:
+    backend::blit_blend_premultiplied(cmd.dst, cmd.src, cmd.global_alpha);
+    break;
+  case Command::Op::BlitBlendAlpha:
+    backend::blit_blend_alpha(cmd.dst, cmd.src, cmd.color, cmd.global_alpha);
+    break;
+  case Command::Op::BlitIndexed:
+    backend::blit_indexed(cmd.dst, cmd.src);
+    break;
+  }
+  ++stats.executed;
+}
+
+void record(const Command &cmd) {
+  if (cmd.dst.get_width() == 0 || cmd.dst.get_height() == 0)
+    return;
+  damage::mark(cmd.dst);
+
+  if (!deferred) {
+    execute(cmd);
+    return;
+  }
+
+  ++stats.recorded;
+
+  if (cmd.op == Command::Op::Fill && coalesce_fill(cmd))
+    return;
+  if (is_opaque(cmd))
+    drop_overwritten(cmd);
+  if (num_commands == MAX_COMMANDS)
+    flush();
+  commands[num_commands++] = cmd;
+}
+
+// Identical logic to the backends, so that recorded regions are exact
+void normalize_regions(Surface &dst, ConstSurface &src) {
+  u32 width = std::min(src.get_width(), dst.get_width());
+  u32 height = std::min(src.get_height(), dst.get_height());
+  src = src.subsurface(0, 0, width, height);
+  dst = dst.subsurface(0, 0, width, height);
+}
+
+// Only the rows of a band that are in memory are drawn (see
+// BaseSurface::band()). src, if any, moves along with dst.
+void clip_to_band(Surface &dst, ConstSurface *src = nullptr) {
+  if (dst.is_backed())
+    return;
+  u32 y = dst.get_row_begin(), h = dst.get_row_end() - y;
+  dst = dst.subsurface(0, y, dst.get_width(), h);
+  if (src)
+    *src = src->subsurface(0, y, src->get_width(), h);
+}
+
+Command blit_command(Command::Op op, Surface dst, ConstSurface src,
+                     u8 global_alpha = 0xFF) {
+  normalize_regions(dst, src);
+  clip_to_band(dst, &src);
+  Command cmd;
+  cmd.op = op;
+  cmd.global_alpha = global_alpha;
+  cmd.dst = dst;
+  cmd.src = src;
+  return cmd;
+}
+
+using profiler::Category;
+
+} // namespace
+
+void fill(Surface dst, u32 color) {
+  GE_PROFILE_SCOPE("gpu::fill", Category::Gpu);
+  Command cmd;
+  cmd.op = Command::Op::Fill;
+  cmd.color = color;
+  clip_to_band(dst);
+  cmd.dst = dst;
+  record(cmd);
+}
+
+void blit(Surface dst, ConstSurface src) {
+  GE_PROFILE_SCOPE("gpu::blit", Category::Gpu);
+  record(blit_command(Command::Op::Blit, dst, src));
+}
+
+void blit_blend(Surface dst, ConstSurface src, u8 global_alpha) {
+  if (global_alpha == 0)
+    return;
+  GE_PROFILE_SCOPE("gpu::blit_blend", Category::Gpu);
+  record(blit_command(Command::Op::BlitBlend, dst, src, global_alpha));
+}
+
+void blit_blend_premultiplied(Surface dst, ConstSurface src, u8 global_alpha) {
+  // rejected here rather than by each backend, so that they all agree
+  const bool argb8888 = src.get_pixel_format() == PixelFormat::ARGB8888;
+  assert(argb8888 && "premultiplied blends take ARGB8888 sources");
+  if (global_alpha == 0 || !argb8888)
+    return;
+  GE_PROFILE_SCOPE("gpu::blit_blend_premultiplied", Category::Gpu);
+  record(blit_command(Command::Op::BlitBlendPremultiplied, dst, src,
+                      global_alpha));
+}
+
+void blit_blend_alpha(Surface dst, ConstSurface src, u32 color,
+                      u8 global_alpha) {
+  if (global_alpha == 0)
+    return;
+  GE_PROFILE_SCOPE("gpu::blit_blend_alpha", Category::Gpu);
+  auto cmd = blit_command(Command::Op::BlitBlendAlpha, dst, src, global_alpha);
+  cmd.color = color;
+  record(cmd);
+}
+
+void load_palette(const u32 *colors, usize num_colors) {
+  if (colors == loaded_palette && num_colors == loaded_palette_size)
+    return;
+  GE_PROFILE_SCOPE("gpu::load_palette", Category::Gpu);
+  // recorded indexed blits still need the previous palette
+  flush();
+  backend::load_palette(colors, num_colors);
+  loaded_palette = colors;
+  loaded_palette_size = num_colors;
+}
+
+void blit_indexed(Surface dst, ConstSurface src) {
+  GE_PROFILE_SCOPE("gpu::blit_indexed", Category::Gpu);
+  record(blit_command(Command::Op::BlitIndexed, dst, src));
+}
+
+void wait_idle() {
+  GE_PROFILE_SCOPE("gpu::wait_idle", Category::Gpu);
+  flush();
+  backend::wait_idle();
+}
+
+Fence insert_fence() {
+  GE_PROFILE_SCOPE("gpu::insert_fence", Category::Gpu);
+  flush();
+  return backend::insert_fence();
+}
+
+void wait_fence(Fence fence) {
+  GE_PROFILE_SCOPE("gpu::wait_fence", Category::Gpu);
+  backend::wait_fence(fence);
+}
+
+void set_deferred(bool value) {
+  flush();
+  deferred = value;
+}
+
+bool is_deferred() { return deferred; }
+
+void flush() {
+  if (num_commands == 0)
+    return;
+  GE_PROFILE_SCOPE("gpu::flush", Category::Gpu);
+  for (usize i = 0; i < num_commands; ++i)
+    execute(commands[i]);
+  num_commands = 0;
+}
+
+const CommandStats &command_stats() { return stats; }
+
+void reset_command_stats() { stats = {}; }
+
+} // namespace gpu
+} // namespace hal
+} // namespace ge
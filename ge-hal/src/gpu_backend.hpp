@@ -0,0 +1,30 @@
+#pragma once
+
+#include "ge-hal/surface.hpp"
+
+namespace ge {
+namespace hal {
+namespace gpu {
+
+// Implemented by each backend. hal::gpu either calls these right away or
+// records the operation and calls them from flush().
+namespace backend {
+
+void fill(Surface dst, u32 color);
+void blit(Surface dst, ConstSurface src);
+void blit_blend(Surface dst, ConstSurface src, u8 global_alpha);
+void blit_blend_premultiplied(Surface dst, ConstSurface src, u8 global_alpha);
+void blit_blend_alpha(Surface dst, ConstSurface src, u32 color,
+                      u8 global_alpha);
+
+void load_palette(u32 const *colors, usize num_colors);
+void blit_indexed(Surface dst, ConstSurface src);
+void wait_idle();
+
+u32 insert_fence();
+void wait_fence(u32 fence);
+
+} // namespace backend
+} // namespace gpu
+} // namespace hal
+} // namespace ge
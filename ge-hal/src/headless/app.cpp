@@ -0,0 +1,452 @@
+#include "ge-hal/app.hpp"
+#include "ge-hal/gpu.hpp"
+#include "ge-hal/layers.hpp"
+#include "ge-hal/replay.hpp"
+#include "ge-hal/strips.hpp"
+#include "ge-hal/surface.hpp"
+#include "ge-hal/timestep.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// Headless backend: renders into a framebuffer in memory, mixes audio into a
+// buffer that is thrown away and reads input from a script. Time is virtual
+// (a fixed 60 Hz frame), so a run is reproducible and goes as fast as the
+// CPU allows. Configured through the environment:
+//
+//   GE_HEADLESS_FRAMES  number of frames to run (default 600, or the whole
+//                       recording with GE_REPLAY)
+//   GE_HEADLESS_SCRIPT  input script, one event per line:
+//                         <frame> x|y <-1..1>    joystick axis
+//                         <frame> down|up 1|2    button
+//                       blank lines and lines starting with # are ignored
+//   GE_HEADLESS_RENDER_EVERY
+//                       only render every so many frames (and the last one),
+//                       to simulate long stretches of game time quickly. The
+//                       frames that only tick are reported on their own.
+//   GE_HEADLESS_DUMP    write the last frame there (raw RGB565)
+//   GE_PROFILE_OUT      profile the run, and write the profile to
+//                       GE_PROFILE_OUT.{csv,json}
+//   GE_RECORD/GE_REPLAY record the input, or replay a recording made by any
+//                       host backend instead of the script (ge-hal/replay.hpp)
+
+namespace ge {
+
+namespace {
+
+constexpr int FRAME_RATE = 60;
+constexpr int DEFAULT_FRAMES = 600;
+
+struct InputEvent {
+  u32 frame;
+  enum class Kind { AxisX, AxisY, ButtonDown, ButtonUp } kind;
+  float value;
+};
+
+bool parse_script(const char *path, std::vector<InputEvent> &events) {
+  FILE *f = std::fopen(path, "r");
+  if (!f) {
+    std::fprintf(stderr, "headless: cannot open script %s\n", path);
+    return false;
+  }
+
+  char line[128];
+  int line_no = 0;
+  while (std::fgets(line, sizeof(line), f)) {
+    ++line_no;
+    unsigned frame;
+    char key[8];
+    float value;
+    if (line[0] == '#' || line[0] == '\n' || line[0] == '\0')
+      continue;
+    if (std::sscanf(line, "%u %7s %f", &frame, key, &value) != 3) {
+      std::fprintf(stderr, "headless: %s:%d: bad event\n", path, line_no);
+      continue;
+    }
+
+    InputEvent event{frame, InputEvent::Kind::AxisX, value};
+    if (!std::strcmp(key, "x"))
+      event.kind = InputEvent::Kind::AxisX;
+    else if (!std::strcmp(key, "y"))
+      event.kind = InputEvent::Kind::AxisY;
+    else if (!std::strcmp(key, "down"))
+      event.kind = InputEvent::Kind::ButtonDown;
+    else if (!std::strcmp(key, "up"))
+      event.kind = InputEvent::Kind::ButtonUp;
+    else {
+      std::fprintf(stderr, "headless: %s:%d: unknown event %s\n", path,
+                   line_no, key);
+      continue;
+    }
+    events.push_back(event);
+  }
+  std::fclose(f);
+
+  std::stable_sort(events.begin(), events.end(),
+                   [](const InputEvent &a, const InputEvent &b) {
+                     return a.frame < b.frame;
+                   });
+  return true;
+}
+
+} // namespace
+
+class AppImpl {
+public:
+  AppImpl() {
+    if (const char *frames_env = std::getenv("GE_HEADLESS_FRAMES"))
+      num_frames = std::strtoul(frames_env, nullptr, 10);
+    else if (hal::replay::mode() == hal::replay::Mode::Replay)
+      num_frames = UINT32_MAX;
+    if (const char *script = std::getenv("GE_HEADLESS_SCRIPT")) {
+      if (!parse_script(script, events))
+        std::exit(1);
+    }
+    if (const char *every = std::getenv("GE_HEADLESS_RENDER_EVERY"))
+      render_every = std::max<u32>(std::strtoul(every, nullptr, 10), 1);
+    dump_path = std::getenv("GE_HEADLESS_DUMP");
+    frame_times.reserve(std::min<u32>(num_frames, 1 << 16));
+  }
+
+  void mix_audio(std::size_t num_samples);
+  void report() const;
+
+  // move the virtual clock, and the audio with it
+  void advance(i64 next) {
+    mix_audio((next - time) * App::AUDIO_FREQ / 1000);
+    time = next;
+  }
+
+  u32 num_frames = DEFAULT_FRAMES;
+  u32 render_every = 1;
+  u32 frame = 0;
+  // virtual time, in ms
+  i64 time = 0;
+  bool quit = false;
+
+  std::vector<InputEvent> events;
+  std::size_t next_event = 0;
+  JoystickState joystick{};
+  // what the game sees: the script's joystick, quantized while recording
+  JoystickState frame_joystick{};
+
+  const char *dump_path = nullptr;
+  // wall time of each rendered frame, in ms
+  std::vector<double> frame_times;
+  // frames that only ticked, with GE_HEADLESS_RENDER_EVERY
+  u32 tick_frames = 0;
+  double tick_time = 0.0;
+
+  struct AudioStream {
+    const std::uint8_t *data;
+    std::size_t length;
+    std::size_t pos;
+    bool loop;
+    bool active;
+  };
+
+  static constexpr int MAX_SFX = 4;
+
+  AudioStream bgm{};
+  AudioStream sfx[MAX_SFX]{};
+  std::uint8_t master_volume = 255;
+  u8 audio_out[App::AUDIO_FREQ / FRAME_RATE + 1];
+  u16 framebuffer[App::WIDTH * App::HEIGHT];
+  // the framebuffer and the other hal::layers, composed like the LTDC would
+  u16 screen[App::WIDTH * App::HEIGHT];
+  // what the last frame looked like on the display
+  const u16 *shown = framebuffer;
+
+  friend class App;
+};
+
+// Same mixing as the SDL backend, the output just isn't played
+void AppImpl::mix_audio(std::size_t num_samples) {
+  num_samples = std::min(num_samples, sizeof(audio_out));
+  for (std::size_t i = 0; i < num_samples; ++i) {
+    int mixed = 0;
+
+    if (bgm.active && bgm.pos >= bgm.length) {
+      if (bgm.loop)
+        bgm.pos = 0;
+      else
+        bgm.active = false;
+    }
+    if (bgm.active)
+      mixed += int(bgm.data[bgm.pos++]) - 128;
+
+    for (int c = 0; c < MAX_SFX; ++c) {
+      auto &s = sfx[c];
+      if (!s.active)
+        continue;
+      if (s.pos >= s.length) {
+        s.active = false;
+        continue;
+      }
+      mixed += int(s.data[s.pos++]) - 128;
+    }
+
+    mixed = (mixed * master_volume) / 255;
+    mixed = std::max(std::min(mixed, 127), -128);
+    audio_out[i] = std::uint8_t(mixed + 128);
+  }
+}
+
+void AppImpl::report() const {
+  if (frame_times.empty())
+    return;
+
+  auto sorted = frame_times;
+  std::sort(sorted.begin(), sorted.end());
+  double total = 0.0;
+  for (double t : sorted)
+    total += t;
+  auto percentile = [&](double p) {
+    return sorted[std::min(sorted.size() - 1,
+                           static_cast<std::size_t>(p * sorted.size()))];
+  };
+
+  // FNV-1a of the last frame, to compare runs
+  u64 hash = 0xcbf29ce484222325ull;
+  auto bytes = reinterpret_cast<const u8 *>(shown);
+  for (std::size_t i = 0; i < sizeof(framebuffer); ++i)
+    hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+
+  std::printf("headless: %u frames rendered, %.3f ms/frame (min %.3f, "
+              "p50 %.3f, p99 %.3f, max %.3f), frame hash %016llx\n",
+              static_cast<unsigned>(sorted.size()), total / sorted.size(),
+              sorted.front(), percentile(0.5), percentile(0.99), sorted.back(),
+              static_cast<unsigned long long>(hash));
+  if (tick_frames)
+    std::printf("headless: %u more frames only ticked, %.3f ms/frame\n",
+                tick_frames, tick_time / tick_frames);
+}
+
+std::unique_ptr<AppImpl> app_impl_instance = nullptr;
+
+static constexpr i64 BUTTON_HOLD_THRESHOLD_MS = 1000;
+struct ButtonState {
+  i64 last_up = -1, last_down = -1;
+  bool handled_hold = false;
+} button_states[2];
+
+App::App() {
+  app_impl_instance = std::make_unique<AppImpl>();
+  hal::timestep::reset();
+}
+App::~App() {
+  hal::replay::finish();
+  app_impl_instance.reset();
+}
+
+App::operator bool() { return app_impl_instance && !app_impl_instance->quit; }
+
+// Feed this frame's script events, like handle_event() in the SDL backend
+static void handle_events(App &app) {
+  auto *impl = app_impl_instance.get();
+  while (impl->next_event < impl->events.size() &&
+         impl->events[impl->next_event].frame <= impl->frame) {
+    const auto &event = impl->events[impl->next_event++];
+    int btn = static_cast<int>(event.value) - 1;
+
+    switch (event.kind) {
+    case InputEvent::Kind::AxisX:
+      impl->joystick.x = std::max(std::min(event.value, 1.0f), -1.0f);
+      break;
+    case InputEvent::Kind::AxisY:
+      impl->joystick.y = std::max(std::min(event.value, 1.0f), -1.0f);
+      break;
+    case InputEvent::Kind::ButtonDown:
+      if (btn < 0 || btn > 1)
+        break;
+      button_states[btn].last_down = app.now();
+      button_states[btn].handled_hold = false;
+      break;
+    case InputEvent::Kind::ButtonUp: {
+      if (btn < 0 || btn > 1)
+        break;
+      button_states[btn].last_up = app.now();
+      if (button_states[btn].last_down < 0)
+        break;
+      i64 held_time =
+          button_states[btn].last_up - button_states[btn].last_down;
+      if (held_time < BUTTON_HOLD_THRESHOLD_MS) {
+        hal::replay::button_event(app, hal::replay::ButtonEvent::Clicked,
+                                  static_cast<Button>(btn));
+      } else {
+        hal::replay::button_event(app, hal::replay::ButtonEvent::FinishedHold,
+                                  static_cast<Button>(btn));
+      }
+      button_states[btn].handled_hold = false;
+      break;
+    }
+    }
+  }
+}
+
+void App::tick(float /*dt*/) {
+  for (auto btn : {Button::Button1, Button::Button2}) {
+    auto &bs = button_states[static_cast<int>(btn)];
+    if (bs.last_down < 0 || bs.last_up > bs.last_down || bs.handled_hold)
+      continue;
+    i64 held_time = now() - bs.last_down;
+    if (held_time >= BUTTON_HOLD_THRESHOLD_MS) {
+      hal::replay::button_event(*this, hal::replay::ButtonEvent::Held, btn);
+    }
+  }
+}
+
+// This frame's input: the script, or the recording when replaying. Returns
+// false once the replay is over.
+static bool begin_input_frame(App &app) {
+  auto *impl = app_impl_instance.get();
+  if (hal::replay::mode() == hal::replay::Mode::Replay) {
+    i64 time;
+    if (!hal::replay::next_frame(time, impl->frame_joystick))
+      return false;
+    impl->advance(time);
+
+    hal::replay::ButtonEvent event;
+    Button btn;
+    while (hal::replay::next_button(event, btn))
+      hal::replay::button_event(app, event, btn);
+    return true;
+  }
+
+  hal::replay::record_frame(impl->time);
+  handle_events(app);
+  impl->frame_joystick = impl->joystick;
+  if (hal::replay::mode() == hal::replay::Mode::Record)
+    impl->frame_joystick = hal::replay::record_joystick(impl->joystick);
+  return true;
+}
+
+void App::loop() {
+  using clock = std::chrono::steady_clock;
+  auto *impl = app_impl_instance.get();
+
+  bool profile = std::getenv("GE_PROFILE_OUT") != nullptr;
+  hal::profiler::set_enabled(profile);
+
+  while (*this && impl->frame < impl->num_frames) {
+    auto start = clock::now();
+    hal::profiler::begin_frame();
+
+    if (!begin_input_frame(*this))
+      break;
+    hal::timestep::advance(impl->time);
+    while (hal::timestep::next_tick())
+      tick(hal::timestep::TICK_DT);
+
+    const bool render = (impl->frame + 1) % impl->render_every == 0 ||
+                        impl->frame + 1 == impl->num_frames;
+    if (render) {
+      Surface fb_region{impl->framebuffer,   WIDTH, WIDTH, HEIGHT,
+                        PixelFormat::RGB565, 0};
+      hal::strips::render_frame(*this, fb_region);
+      hal::gpu::flush();
+      impl->shown = impl->framebuffer;
+      if (hal::layers::active()) {
+        hal::layers::compose(Surface{impl->screen, WIDTH, WIDTH, HEIGHT},
+                             fb_region.as_const());
+        impl->shown = impl->screen;
+      }
+    }
+    hal::profiler::end_frame();
+
+    // advance the virtual clock by one frame, a replay has its own times
+    ++impl->frame;
+    if (hal::replay::mode() != hal::replay::Mode::Replay)
+      impl->advance(static_cast<i64>(impl->frame) * 1000 / FRAME_RATE);
+
+    // frames that only ticked would make rendering look faster than it is
+    std::chrono::duration<double, std::milli> elapsed = clock::now() - start;
+    if (render) {
+      impl->frame_times.push_back(elapsed.count());
+    } else {
+      ++impl->tick_frames;
+      impl->tick_time += elapsed.count();
+    }
+  }
+
+  impl->report();
+  if (profile)
+    hal::profiler::dump();
+  if (impl->dump_path) {
+    if (FILE *f = std::fopen(impl->dump_path, "wb")) {
+      std::fwrite(impl->shown, sizeof(impl->framebuffer), 1, f);
+      std::fclose(f);
+    } else {
+      std::fprintf(stderr, "headless: cannot write %s\n", impl->dump_path);
+    }
+  }
+}
+
+void App::request_quit() { app_impl_instance->quit = true; }
+
+std::int64_t App::now() { return hal::timestep::now(); }
+
+// The profiler measures real time, not the virtual clock
+u32 hal::profiler::clock_ticks() {
+  using namespace std::chrono;
+  return static_cast<u32>(
+      duration_cast<nanoseconds>(steady_clock::now().time_since_epoch())
+          .count());
+}
+
+u32 hal::profiler::ticks_per_us() { return 1000; }
+
+JoystickState App::get_joystick_state() {
+  return app_impl_instance->frame_joystick;
+}
+
+void App::log(const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  std::vfprintf(stderr, fmt, args);
+  va_end(args);
+  std::fputc('\n', stderr);
+}
+
+// Nothing to wait for, only the virtual clock moves
+void App::sleep(std::int64_t ms) { app_impl_instance->time += ms; }
+
+void App::audio_bgm_play(const std::uint8_t *data, std::size_t len, bool loop) {
+  app_impl_instance->bgm = {data, len, 0, loop, true};
+}
+
+void App::audio_bgm_stop() { app_impl_instance->bgm.active = false; }
+
+bool App::audio_bgm_is_playing() { return app_impl_instance->bgm.active; }
+
+void App::audio_sfx_play(const std::uint8_t *data, std::size_t len,
+                         std::size_t /*rate*/) {
+  auto &sfx = app_impl_instance->sfx;
+  for (int i = 0; i < AppImpl::MAX_SFX; ++i) {
+    if (!sfx[i].active) {
+      sfx[i] = {data, len, 0, false, true};
+      return;
+    }
+  }
+
+  // voice steal (overwrite oldest)
+  sfx[0] = {data, len, 0, false, true};
+}
+
+void App::audio_sfx_stop_all() {
+  for (int i = 0; i < AppImpl::MAX_SFX; ++i) {
+    app_impl_instance->sfx[i].active = false;
+  }
+}
+
+void App::audio_set_master_volume(std::uint8_t vol) {
+  app_impl_instance->master_volume = vol;
+}
+
+} // namespace ge
@@ -0,0 +1,105 @@
+#include "ge-hal/layers.hpp"
+#include "ge-hal/app.hpp"
+#include <algorithm>
+#include <cstdio>
+
+#ifndef GE_HAL_STM32
+#include "ge-hal/sw/compose.hpp"
+#endif
+
+namespace ge {
+namespace hal {
+namespace layers {
+
+namespace {
+
+State states[NUM_LAYERS];
+u32 current_revision = 0;
+
+State &state_of(Layer layer) { return states[static_cast<u32>(layer)]; }
+
+bool supported(PixelFormat fmt) {
+  switch (fmt) {
+  case PixelFormat::RGB565:
+  case PixelFormat::ARGB1555:
+  case PixelFormat::ARGB4444:
+  case PixelFormat::ARGB8888:
+    return true;
+  default:
+    return false;
+  }
+}
+
+void clamp_scroll(State &s) {
+  u32 w = s.buffer.get_width(), h = s.buffer.get_height();
+  s.scroll_x = std::min(s.scroll_x, w > App::WIDTH ? w - App::WIDTH : 0);
+  s.scroll_y = std::min(s.scroll_y, h > App::HEIGHT ? h - App::HEIGHT : 0);
+}
+
+} // namespace
+
+void set_buffer(Layer layer, const ConstSurface &buffer) {
+  if (buffer.data() &&
+      (!supported(buffer.get_pixel_format()) || !buffer.is_backed())) {
+    std::printf("Unsupported layer buffer\r\n");
+    return;
+  }
+  auto &s = state_of(layer);
+  s.buffer = buffer;
+  clamp_scroll(s);
+  ++current_revision;
+}
+
+void set_scroll(Layer layer, u32 x, u32 y) {
+  auto &s = state_of(layer);
+  s.scroll_x = x;
+  s.scroll_y = y;
+  clamp_scroll(s);
+  ++current_revision;
+}
+
+void set_alpha(Layer layer, u8 alpha) {
+  state_of(layer).alpha = alpha;
+  ++current_revision;
+}
+
+void reset() {
+  for (auto &s : states)
+    s = State{};
+  ++current_revision;
+}
+
+const State &state(Layer layer) { return state_of(layer); }
+
+bool active() {
+  const auto &bg = state(Layer::Background);
+  return bg.buffer.data() || bg.alpha != 0xFF ||
+         state(Layer::Foreground).buffer.data();
+}
+
+u32 revision() { return current_revision; }
+
+ConstSurface window(Layer layer, const ConstSurface &fb) {
+  const auto &s = state(layer);
+  if (!s.buffer.data())
+    return layer == Layer::Background ? fb : ConstSurface{};
+  return s.buffer.subsurface(s.scroll_x, s.scroll_y, App::WIDTH, App::HEIGHT);
+}
+
+#ifndef GE_HAL_STM32
+void compose(const Surface &dst, const ConstSurface &fb) {
+  sw::ComposeLayer shown[NUM_LAYERS];
+  u32 count = 0;
+  for (u32 i = 0; i < NUM_LAYERS; ++i) {
+    auto layer = static_cast<Layer>(i);
+    auto pixels = window(layer, fb);
+    if (pixels.data())
+      shown[count++] = {pixels, state(layer).alpha};
+  }
+  sw::compose(dst, shown, count);
+}
+#endif
+
+} // namespace layers
+} // namespace hal
+} // namespace ge
@@ -1,11 +1,18 @@
 #include "ge-hal/app.hpp"
+#include "ge-hal/damage.hpp"
+#include "ge-hal/gpu.hpp"
+#include "ge-hal/layers.hpp"
+#include "ge-hal/replay.hpp"
+#include "ge-hal/strips.hpp"
 #include "ge-hal/surface.hpp"
+#include "ge-hal/timestep.hpp"
 
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_audio.h>
 #include <SDL3/SDL_events.h>
 #include <SDL3/SDL_gamepad.h>
 #include <SDL3/SDL_init.h>
+#include <SDL3/SDL_keyboard.h>
 #include <SDL3/SDL_log.h>
 #include <SDL3/SDL_pixels.h>
 #include <SDL3/SDL_render.h>
@@ -76,6 +83,13 @@ public:
   SDL_Gamepad *pad = nullptr;
   bool quit = false;
 
+  // the clock of the current frame, and while recording or replaying (see
+  // ge-hal/replay.hpp) its joystick
+  i64 frame_time = 0;
+  JoystickState frame_joystick{};
+  // wall time and frame time the replay started at
+  i64 replay_start = -1, replay_start_time = 0;
+
   struct AudioStream {
     const std::uint8_t *data;
     std::size_t length;
@@ -90,6 +104,9 @@ public:
   AudioStream sfx[MAX_SFX];
   std::uint8_t master_volume = 255;
   u16 framebuffer[App::WIDTH * App::HEIGHT];
+  // the framebuffer and the other hal::layers, composed like the LTDC would
+  u16 screen[App::WIDTH * App::HEIGHT];
+  bool composed = false;
 
   friend class App;
 };
@@ -148,8 +165,14 @@ struct ButtonState {
   bool handled_hold = false;
 } button_states[2];
 
-App::App() { app_impl_instance = std::make_unique<AppImpl>(this); }
-App::~App() { app_impl_instance.reset(); }
+App::App() {
+  app_impl_instance = std::make_unique<AppImpl>(this);
+  hal::timestep::reset();
+}
+App::~App() {
+  hal::replay::finish();
+  app_impl_instance.reset();
+}
 
 App::operator bool() { return app_impl_instance && !app_impl_instance->quit; }
 
@@ -190,8 +213,22 @@ static void handle_event(App &app) {
         app.log("Gamepad disconnected");
       }
       break;
+    case SDL_EVENT_KEY_DOWN:
+      if (event.key.repeat)
+        break;
+      if (event.key.key == SDLK_F3)
+        app.on_debug_command(DebugCommand::ToggleProfiler);
+      else if (event.key.key == SDLK_F4)
+        app.on_debug_command(DebugCommand::DumpProfile);
+      break;
     case SDL_EVENT_GAMEPAD_BUTTON_DOWN: {
+      if (event.gbutton.button == SDL_GAMEPAD_BUTTON_BACK) {
+        app.on_debug_command(DebugCommand::ToggleProfiler);
+        break;
+      }
       int btn = gamepad_button_to_button(event.gbutton.button);
+      if (hal::replay::mode() == hal::replay::Mode::Replay)
+        break;
       if (btn >= 0) {
         button_states[btn].last_down = app.now();
         button_states[btn].handled_hold = false;
@@ -200,6 +237,8 @@ static void handle_event(App &app) {
     }
     case SDL_EVENT_GAMEPAD_BUTTON_UP: {
       int btn = gamepad_button_to_button(event.gbutton.button);
+      if (hal::replay::mode() == hal::replay::Mode::Replay)
+        break;
       if (btn >= 0) {
         button_states[btn].last_up = app.now();
         if (button_states[btn].last_down < 0)
@@ -207,9 +246,12 @@ static void handle_event(App &app) {
         i64 held_time =
             button_states[btn].last_up - button_states[btn].last_down;
         if (held_time < BUTTON_HOLD_THRESHOLD_MS) {
-          app.on_button_clicked(static_cast<Button>(btn));
+          hal::replay::button_event(app, hal::replay::ButtonEvent::Clicked,
+                                    static_cast<Button>(btn));
         } else {
-          app.on_button_finished_hold(static_cast<Button>(btn));
+          hal::replay::button_event(app,
+                                    hal::replay::ButtonEvent::FinishedHold,
+                                    static_cast<Button>(btn));
         }
         button_states[btn].handled_hold = false;
       }
@@ -226,19 +268,63 @@ void App::tick(float /*dt*/) {
       continue;
     i64 held_time = now() - bs.last_down;
     if (held_time >= BUTTON_HOLD_THRESHOLD_MS) {
-      on_button_held(btn);
+      hal::replay::button_event(*this, hal::replay::ButtonEvent::Held, btn);
     }
   }
 }
 
+static JoystickState read_joystick();
+
+// The clock of the frame, and the recorded input when replaying. Returns
+// false once the replay is over.
+static bool begin_input_frame(App &app) {
+  auto *impl = app_impl_instance.get();
+  switch (hal::replay::mode()) {
+  case hal::replay::Mode::Off:
+    impl->frame_time = SDL_GetTicks();
+    return true;
+  case hal::replay::Mode::Record:
+    impl->frame_time = SDL_GetTicks();
+    hal::replay::record_frame(impl->frame_time);
+    return true;
+  case hal::replay::Mode::Replay:
+    break;
+  }
+
+  if (!hal::replay::next_frame(impl->frame_time, impl->frame_joystick))
+    return false;
+
+  // in real time, as recorded
+  i64 wall = SDL_GetTicks();
+  if (impl->replay_start < 0) {
+    impl->replay_start = wall;
+    impl->replay_start_time = impl->frame_time;
+  }
+  i64 wait = (impl->frame_time - impl->replay_start_time) -
+             (wall - impl->replay_start);
+  if (wait > 0)
+    SDL_Delay(static_cast<u32>(wait));
+
+  hal::replay::ButtonEvent event;
+  Button btn;
+  while (hal::replay::next_button(event, btn))
+    hal::replay::button_event(app, event, btn);
+  return true;
+}
+
 void App::loop() {
-  i64 last_tick = now();
   while (*this) {
+    if (!begin_input_frame(*this))
+      break;
     handle_event(*this);
-    i64 current = now();
-    float dt = (current - last_tick) * 1e-3f;
-    tick(dt);
-    last_tick = current;
+    // the joystick is sampled once per frame, after the events
+    if (hal::replay::mode() == hal::replay::Mode::Record)
+      app_impl_instance->frame_joystick =
+          hal::replay::record_joystick(read_joystick());
+    hal::profiler::begin_frame();
+    hal::timestep::advance(app_impl_instance->frame_time);
+    while (hal::timestep::next_tick())
+      tick(hal::timestep::TICK_DT);
 
     // Render to framebuffer
     Surface fb_region{app_impl_instance->framebuffer,
@@ -247,7 +333,10 @@ void App::loop() {
                       HEIGHT,
                       PixelFormat::RGB565,
                       0};
-    render(fb_region);
+    hal::strips::render_frame(*this, fb_region);
+    // run whatever render() recorded before the frame is uploaded
+    hal::gpu::flush();
+    hal::profiler::end_frame();
 
     // Upload framebuffer to screen
     int win_w, win_h;
@@ -264,10 +353,30 @@ void App::loop() {
 
     auto *impl = app_impl_instance.get();
 
-    // upload framebuffer → texture
-    SDL_UpdateTexture(impl->frame_texture, nullptr,
-                      app_impl_instance->framebuffer,
-                      WIDTH * sizeof(app_impl_instance->framebuffer[0]));
+    if (hal::layers::active()) {
+      // any layer may have changed, the whole screen is uploaded
+      hal::layers::compose(Surface{impl->screen, WIDTH, WIDTH, HEIGHT},
+                           fb_region.as_const());
+      SDL_UpdateTexture(impl->frame_texture, nullptr, impl->screen,
+                        WIDTH * sizeof(impl->screen[0]));
+      impl->composed = true;
+    } else if (impl->composed) {
+      // back to the framebuffer alone
+      SDL_UpdateTexture(impl->frame_texture, nullptr, impl->framebuffer,
+                        WIDTH * sizeof(impl->framebuffer[0]));
+      impl->composed = false;
+    } else {
+      // upload the damaged parts of the framebuffer → texture, the texture
+      // keeps the rest from earlier frames
+      const auto &damage = hal::damage::current();
+      for (u32 i = 0; i < damage.count; ++i) {
+        const auto &r = damage.rects[i];
+        SDL_Rect rect{(int)r.x, (int)r.y, (int)r.w, (int)r.h};
+        SDL_UpdateTexture(impl->frame_texture, &rect,
+                          &impl->framebuffer[r.y * WIDTH + r.x],
+                          WIDTH * sizeof(impl->framebuffer[0]));
+      }
+    }
 
     // letterbox clear
     SDL_SetRenderDrawColor(impl->renderer, 0, 0, 0, 255);
@@ -284,9 +393,21 @@ void App::loop() {
 
 void App::request_quit() { app_impl_instance->quit = true; }
 
-std::int64_t App::now() { return SDL_GetTicks(); }
+std::int64_t App::now() { return hal::timestep::now(); }
+
+u32 hal::profiler::clock_ticks() {
+  return static_cast<u32>(SDL_GetTicksNS());
+}
+
+u32 hal::profiler::ticks_per_us() { return 1000; }
 
 JoystickState App::get_joystick_state() {
+  if (hal::replay::mode() != hal::replay::Mode::Off)
+    return app_impl_instance->frame_joystick;
+  return read_joystick();
+}
+
+static JoystickState read_joystick() {
   if (!app_impl_instance->pad)
     return JoystickState{};
 
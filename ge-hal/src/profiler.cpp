@@ -0,0 +1,302 @@
+#include "ge-hal/profiler.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace ge {
+namespace hal {
+namespace profiler {
+
+namespace {
+
+#ifdef GE_HAL_STM32
+constexpr const char *NEWLINE = "\r\n";
+#else
+constexpr const char *NEWLINE = "\n";
+#endif
+
+struct Zone {
+  const char *name;
+  Category category;
+  u32 depth;
+
+  // this frame
+  u32 frame_ticks, frame_calls;
+
+  // last HISTORY frames the zone ran in
+  u32 history[HISTORY];
+  u32 history_size, history_next;
+  u32 total_calls, total_frames;
+};
+
+struct Event {
+  u32 start_us; // since the profiler was enabled
+  u32 duration_us;
+  u16 zone;
+  u16 depth;
+};
+
+bool enabled = false;
+Zone zones[MAX_ZONES];
+u32 num_zones = 0;
+constexpr ZoneId OTHER_ZONE = MAX_ZONES - 1;
+
+// zone() by name pointer and category, open addressing
+struct LookupEntry {
+  const char *name; // nullptr: free
+  Category category;
+  u8 zone;
+};
+constexpr u32 LOOKUP_SIZE = 2 * MAX_ZONES;
+static_assert((LOOKUP_SIZE & (LOOKUP_SIZE - 1)) == 0,
+              "the lookup table is indexed with a mask");
+static_assert(MAX_ZONES <= 256, "zones are u8 in the lookup table");
+LookupEntry lookup[LOOKUP_SIZE];
+u32 depth = 0;
+
+Event events[MAX_EVENTS];
+u32 events_next = 0, events_size = 0;
+
+// timestamps: the raw counter wraps, so keep a running total per frame
+u32 frame_start = 0;
+u64 frame_start_us = 0;
+bool in_frame = false;
+
+const char *category_name(Category category) {
+  switch (category) {
+  case Category::Frame:
+    return "frame";
+  case Category::Tick:
+    return "tick";
+  case Category::Render:
+    return "render";
+  case Category::Gpu:
+    return "gpu";
+  }
+  return "";
+}
+
+u32 to_us(u32 ticks) { return ticks / ticks_per_us(); }
+
+void record(ZoneId id, u32 start, u32 end, u32 event_depth) {
+  auto &z = zones[id];
+  z.frame_ticks += end - start;
+  ++z.frame_calls;
+
+  auto &e = events[events_next];
+  // scopes can also start before begin_frame()
+  i32 since_frame = static_cast<i32>(start - frame_start);
+  i32 tpu = static_cast<i32>(ticks_per_us());
+  e.start_us = static_cast<u32>(frame_start_us + since_frame / tpu);
+  e.duration_us = to_us(end - start);
+  e.zone = static_cast<u16>(id);
+  e.depth = static_cast<u16>(event_depth);
+  events_next = (events_next + 1) % MAX_EVENTS;
+  events_size = std::min(events_size + 1, MAX_EVENTS);
+}
+
+ZoneId find_or_add_zone(const char *name, Category category) {
+  for (u32 i = 0; i < num_zones; ++i) {
+    if (i != OTHER_ZONE && zones[i].category == category &&
+        (zones[i].name == name || !std::strcmp(zones[i].name, name)))
+      return i;
+  }
+
+  // out of zones: everything else is lumped into the last one, which no
+  // named zone ever gets
+  if (num_zones >= OTHER_ZONE) {
+    if (num_zones == OTHER_ZONE) {
+      zones[OTHER_ZONE] = {};
+      zones[OTHER_ZONE].name = "(other)";
+      zones[OTHER_ZONE].category = category;
+      zones[OTHER_ZONE].depth = depth;
+      num_zones = MAX_ZONES;
+    }
+    return OTHER_ZONE;
+  }
+
+  auto &z = zones[num_zones];
+  z = {};
+  z.name = name;
+  z.category = category;
+  z.depth = depth;
+  return num_zones++;
+}
+
+} // namespace
+
+void set_enabled(bool value) {
+  if (value && !enabled) {
+    frame_start = clock_ticks();
+    in_frame = false;
+  }
+  enabled = value;
+}
+
+bool is_enabled() { return enabled; }
+
+void begin_frame() {
+  if (!enabled)
+    return;
+  u32 now = clock_ticks();
+  frame_start_us += to_us(now - frame_start);
+  frame_start = now;
+  depth = 0;
+  in_frame = true;
+}
+
+void end_frame() {
+  if (!enabled || !in_frame)
+    return;
+  in_frame = false;
+  static Site frame_site{"frame", Category::Frame};
+  record(frame_site.get(), frame_start, clock_ticks(), 0);
+
+  for (u32 i = 0; i < num_zones; ++i) {
+    auto &z = zones[i];
+    if (z.frame_calls == 0)
+      continue;
+    z.history[z.history_next] = to_us(z.frame_ticks);
+    z.history_next = (z.history_next + 1) % HISTORY;
+    z.history_size = std::min(z.history_size + 1, HISTORY);
+    z.total_calls += z.frame_calls;
+    ++z.total_frames;
+    z.frame_ticks = z.frame_calls = 0;
+  }
+}
+
+ZoneId zone(const char *name, Category category) {
+  // names are mostly string literals: a pointer seen before is found without
+  // comparing strings
+  const u32 mask = LOOKUP_SIZE - 1;
+  u32 slot = (static_cast<u32>(reinterpret_cast<uintptr_t>(name) >> 2) ^
+              static_cast<u32>(category) * 0x9E3779B9u) &
+             mask;
+  u32 probes = 0;
+  for (; probes < LOOKUP_SIZE && lookup[slot].name; ++probes) {
+    const auto &entry = lookup[slot];
+    if (entry.name == name && entry.category == category)
+      return entry.zone;
+    slot = (slot + 1) & mask;
+  }
+
+  ZoneId id = find_or_add_zone(name, category);
+  // a full table only makes the lookups slower
+  if (probes < LOOKUP_SIZE)
+    lookup[slot] = {name, category, static_cast<u8>(id)};
+  return id;
+}
+
+Scope::Scope(const char *name, Category category) : active{enabled} {
+  if (active)
+    begin(zone(name, category));
+}
+
+Scope::Scope(Site &site) : active{enabled} {
+  if (active)
+    begin(site.get());
+}
+
+void Scope::begin(ZoneId zone_id) {
+  id = zone_id;
+  ++depth;
+  start = clock_ticks();
+}
+
+Scope::~Scope() {
+  if (!active)
+    return;
+  u32 end = clock_ticks();
+  --depth;
+  record(id, start, end, depth);
+}
+
+u32 zone_count() { return num_zones; }
+
+ZoneStats zone_stats(ZoneId id) {
+  const auto &z = zones[id];
+  ZoneStats stats{z.name, z.category, z.depth, z.history_size, 0.0f,
+                  0,      0,          0,       0};
+  if (z.history_size == 0)
+    return stats;
+
+  u32 samples[HISTORY];
+  u64 total = 0;
+  std::copy(z.history, z.history + z.history_size, samples);
+  stats.min_us = samples[0];
+  for (u32 i = 0; i < z.history_size; ++i) {
+    stats.min_us = std::min(stats.min_us, samples[i]);
+    stats.max_us = std::max(stats.max_us, samples[i]);
+    total += samples[i];
+  }
+  stats.avg_us = static_cast<u32>(total / z.history_size);
+
+  u32 p99 = z.history_size * 99 / 100;
+  std::nth_element(samples, samples + p99, samples + z.history_size);
+  stats.p99_us = samples[p99];
+  stats.calls = static_cast<float>(z.total_calls) / z.total_frames;
+  return stats;
+}
+
+void write_csv(std::FILE *out) {
+  std::fprintf(out, "zone,category,depth,frames,calls,min_us,avg_us,max_us,"
+                    "p99_us%s",
+               NEWLINE);
+  for (u32 i = 0; i < num_zones; ++i) {
+    auto s = zone_stats(i);
+    std::fprintf(out, "%s,%s,%u,%u,%.1f,%u,%u,%u,%u%s", s.name,
+                 category_name(s.category), static_cast<unsigned>(s.depth),
+                 static_cast<unsigned>(s.samples), s.calls,
+                 static_cast<unsigned>(s.min_us),
+                 static_cast<unsigned>(s.avg_us),
+                 static_cast<unsigned>(s.max_us),
+                 static_cast<unsigned>(s.p99_us), NEWLINE);
+  }
+}
+
+// Complete ("X") events, oldest first: chrome://tracing or ui.perfetto.dev
+void write_chrome_trace(std::FILE *out) {
+  std::fprintf(out, "{\"traceEvents\":[%s", NEWLINE);
+  u32 first = (events_next + MAX_EVENTS - events_size) % MAX_EVENTS;
+  for (u32 i = 0; i < events_size; ++i) {
+    const auto &e = events[(first + i) % MAX_EVENTS];
+    const auto &z = zones[e.zone];
+    std::fprintf(out,
+                 "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%u,"
+                 "\"dur\":%u,\"pid\":0,\"tid\":0}%s%s",
+                 z.name, category_name(z.category),
+                 static_cast<unsigned>(e.start_us),
+                 static_cast<unsigned>(e.duration_us),
+                 i + 1 < events_size ? "," : "", NEWLINE);
+  }
+  std::fprintf(out, "]}%s", NEWLINE);
+}
+
+void dump() {
+#ifdef GE_HAL_STM32
+  write_csv(stdout);
+  std::fflush(stdout);
+#else
+  const char *base = std::getenv("GE_PROFILE_OUT");
+  if (!base)
+    base = "ge-profile";
+
+  char path[256];
+  std::snprintf(path, sizeof(path), "%s.csv", base);
+  if (FILE *f = std::fopen(path, "w")) {
+    write_csv(f);
+    std::fclose(f);
+  }
+  std::snprintf(path, sizeof(path), "%s.json", base);
+  if (FILE *f = std::fopen(path, "w")) {
+    write_chrome_trace(f);
+    std::fclose(f);
+  }
+  std::printf("profiler: wrote %s.csv and %s.json\n", base, base);
+#endif
+}
+
+} // namespace profiler
+} // namespace hal
+} // namespace ge
@@ -0,0 +1,283 @@
+#include "ge-hal/replay.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace ge {
+namespace hal {
+namespace replay {
+
+namespace {
+
+// File format: the magic and a version byte, then a stream of records, each
+// starting with a tag byte:
+//   SEED      u64 (little endian)
+//   FRAME     time since the previous frame in ms (LEB128)
+//   JOYSTICK  x, y as i16 (little endian), only when the sample changed
+//   BUTTON    the tag itself: BUTTON | event << 1 | button
+constexpr char MAGIC[4] = {'G', 'E', 'I', 'N'};
+constexpr u8 VERSION = 1;
+
+enum Tag : u8 {
+  TAG_SEED = 0x01,
+  TAG_FRAME = 0x02,
+  TAG_JOYSTICK = 0x03,
+  TAG_BUTTON = 0x10, // up to 0x17
+};
+
+bool initialized = false;
+Mode current_mode = Mode::Off;
+const char *path = nullptr;
+
+// recording
+std::FILE *out = nullptr;
+
+// replay
+std::vector<u8> data;
+std::size_t pos = 0;
+u32 num_frames = 0;
+// button tags of the current frame
+std::vector<u8> buttons;
+std::size_t next_button_index = 0;
+
+// both
+i64 last_time = 0;
+i16 last_x = 0, last_y = 0;
+
+i16 quantize(float v) {
+  v = v < -1.0f ? -1.0f : v > 1.0f ? 1.0f : v;
+  return static_cast<i16>(v * 32767.0f);
+}
+
+float dequantize(i16 v) { return v / 32767.0f; }
+
+void put(u8 byte) { std::fputc(byte, out); }
+
+void put_u16(u16 v) {
+  put(v & 0xFF);
+  put(v >> 8);
+}
+
+void put_varint(u64 v) {
+  do {
+    u8 byte = v & 0x7F;
+    v >>= 7;
+    put(v ? byte | 0x80 : byte);
+  } while (v);
+}
+
+bool get(u8 &byte) {
+  if (pos >= data.size())
+    return false;
+  byte = data[pos++];
+  return true;
+}
+
+bool get_u16(u16 &v) {
+  u8 lo, hi;
+  if (!get(lo) || !get(hi))
+    return false;
+  v = lo | (hi << 8);
+  return true;
+}
+
+bool get_varint(u64 &v) {
+  v = 0;
+  for (u32 shift = 0; shift < 64; shift += 7) {
+    u8 byte;
+    if (!get(byte))
+      return false;
+    v |= static_cast<u64>(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+bool open_recording(const char *record_path) {
+  out = std::fopen(record_path, "wb");
+  if (!out) {
+    std::fprintf(stderr, "replay: cannot write %s\n", record_path);
+    return false;
+  }
+  std::fwrite(MAGIC, sizeof(MAGIC), 1, out);
+  put(VERSION);
+  return true;
+}
+
+bool open_replay(const char *replay_path) {
+  std::FILE *f = std::fopen(replay_path, "rb");
+  if (!f) {
+    std::fprintf(stderr, "replay: cannot open %s\n", replay_path);
+    return false;
+  }
+  u8 buf[4096];
+  std::size_t n;
+  while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0)
+    data.insert(data.end(), buf, buf + n);
+  std::fclose(f);
+
+  if (data.size() < sizeof(MAGIC) + 1 ||
+      std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0 ||
+      data[sizeof(MAGIC)] != VERSION) {
+    std::fprintf(stderr, "replay: %s is not an input recording\n",
+                 replay_path);
+    return false;
+  }
+  pos = sizeof(MAGIC) + 1;
+  return true;
+}
+
+void init() {
+  initialized = true;
+#ifndef GE_HAL_STM32
+  if ((path = std::getenv("GE_REPLAY"))) {
+    // replaying something else than the recording would make no sense
+    if (!open_replay(path))
+      std::exit(1);
+    current_mode = Mode::Replay;
+  } else if ((path = std::getenv("GE_RECORD"))) {
+    if (open_recording(path))
+      current_mode = Mode::Record;
+  }
+#endif
+}
+
+} // namespace
+
+Mode mode() {
+  if (!initialized)
+    init();
+  return current_mode;
+}
+
+void record_seed(u64 seed) {
+  if (mode() != Mode::Record)
+    return;
+  put(TAG_SEED);
+  for (int i = 0; i < 8; ++i)
+    put(static_cast<u8>(seed >> (i * 8)));
+}
+
+bool replayed_seed(u64 &seed) {
+  // the seed is recorded before the first frame
+  if (mode() != Mode::Replay || pos >= data.size() || data[pos] != TAG_SEED)
+    return false;
+  ++pos;
+  seed = 0;
+  for (int i = 0; i < 8; ++i) {
+    u8 byte;
+    if (!get(byte))
+      return false;
+    seed |= static_cast<u64>(byte) << (i * 8);
+  }
+  return true;
+}
+
+void record_frame(i64 time) {
+  if (mode() != Mode::Record)
+    return;
+  put(TAG_FRAME);
+  put_varint(static_cast<u64>(time - last_time));
+  last_time = time;
+}
+
+JoystickState record_joystick(JoystickState joystick) {
+  i16 x = quantize(joystick.x), y = quantize(joystick.y);
+  if (mode() == Mode::Record && (x != last_x || y != last_y)) {
+    put(TAG_JOYSTICK);
+    put_u16(static_cast<u16>(x));
+    put_u16(static_cast<u16>(y));
+  }
+  last_x = x;
+  last_y = y;
+  return {dequantize(x), dequantize(y)};
+}
+
+bool next_frame(i64 &time, JoystickState &joystick) {
+  if (mode() != Mode::Replay)
+    return false;
+
+  // skip to the next frame, the seed is only read at startup
+  u8 tag;
+  do {
+    if (!get(tag))
+      return false;
+    if (tag == TAG_SEED)
+      pos += 8;
+  } while (tag != TAG_FRAME);
+
+  u64 delta;
+  if (!get_varint(delta))
+    return false;
+  last_time += static_cast<i64>(delta);
+
+  // everything up to the next frame belongs to this one
+  buttons.clear();
+  next_button_index = 0;
+  while (pos < data.size() && data[pos] != TAG_FRAME) {
+    tag = data[pos++];
+    if (tag == TAG_JOYSTICK) {
+      u16 x, y;
+      if (!get_u16(x) || !get_u16(y))
+        return false;
+      last_x = static_cast<i16>(x);
+      last_y = static_cast<i16>(y);
+    } else if ((tag & ~0x07) == TAG_BUTTON) {
+      buttons.push_back(tag);
+    } else {
+      std::fprintf(stderr, "replay: bad record %02x at offset %u\n", tag,
+                   static_cast<unsigned>(pos - 1));
+      return false;
+    }
+  }
+
+  time = last_time;
+  joystick = {dequantize(last_x), dequantize(last_y)};
+  ++num_frames;
+  return true;
+}
+
+bool next_button(ButtonEvent &event, Button &btn) {
+  if (next_button_index >= buttons.size())
+    return false;
+  u8 tag = buttons[next_button_index++];
+  event = static_cast<ButtonEvent>((tag >> 1) & 0x03);
+  btn = static_cast<Button>(tag & 0x01);
+  return true;
+}
+
+void button_event(App &app, ButtonEvent event, Button btn) {
+  if (mode() == Mode::Record)
+    put(TAG_BUTTON | static_cast<u8>(event) << 1 | static_cast<u8>(btn));
+
+  switch (event) {
+  case ButtonEvent::Clicked:
+    app.on_button_clicked(btn);
+    break;
+  case ButtonEvent::Held:
+    app.on_button_held(btn);
+    break;
+  case ButtonEvent::FinishedHold:
+    app.on_button_finished_hold(btn);
+    break;
+  }
+}
+
+void finish() {
+  if (current_mode == Mode::Record && out) {
+    std::fclose(out);
+    out = nullptr;
+    std::printf("replay: recorded to %s\n", path);
+  } else if (current_mode == Mode::Replay) {
+    std::printf("replay: %u frames from %s\n",
+                static_cast<unsigned>(num_frames), path);
+  }
+  current_mode = Mode::Off;
+}
+
+} // namespace replay
+} // namespace hal
+} // namespace ge
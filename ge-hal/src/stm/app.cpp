@@ -5,12 +5,16 @@
 #include <cstdlib>
 #include <cstring>
 
+#include "ge-hal/damage.hpp"
+#include "ge-hal/gpu.hpp"
 #include "ge-hal/stm/dma2d.hpp"
 #include "ge-hal/stm/framebuffer.hpp"
 #include "ge-hal/stm/gpio.hpp"
 #include "ge-hal/stm/joystick.hpp"
 #include "ge-hal/stm/sdram.hpp"
 #include "ge-hal/stm/time.hpp"
+#include "ge-hal/strips.hpp"
+#include "ge-hal/timestep.hpp"
 #include "stm32f429xx.h"
 #include <ge-hal/stm/uart.hpp>
 
@@ -24,7 +28,8 @@ constexpr hal::stm::Pin BUTTON1_PIN{'A', 0};
 constexpr hal::stm::Pin BUTTON2_PIN{'C', 13};
 constexpr int NUM_BUTTONS = 2;
 
-// Button state tracking for event detection
+// Button state tracking for event detection, on the SysTick clock: App::now()
+// is only updated by the main loop
 constexpr i64 BUTTON_HOLD_THRESHOLD_MS = 1000;
 struct ButtonState {
   bool last_state = false; // false = not pressed, true = pressed
@@ -46,14 +51,14 @@ void handle_button_interrupt(int button_index) {
 
   // Detect button down event
   if (pressed && !bs.last_state) {
-    bs.last_down = app_instance->now();
+    bs.last_down = hal::stm::systick_get();
     bs.last_up = -1;
     bs.handled_hold = false;
   }
 
   // Detect button up event
   if (!pressed && bs.last_state) {
-    bs.last_up = app_instance->now();
+    bs.last_up = hal::stm::systick_get();
     if (bs.last_down >= 0) {
       i64 held_time = bs.last_up - bs.last_down;
       if (held_time < BUTTON_HOLD_THRESHOLD_MS) {
@@ -109,6 +114,7 @@ App::App() {
     // Enable interrupt on both edges (press and release)
     pin.enable_exti(hal::stm::EXTITrigger::RisingFalling);
   }
+  hal::timestep::reset();
 }
 
 App::~App() = default;
@@ -117,7 +123,7 @@ App::operator bool() { return true; }
 
 static u32 buffer_index = 0;
 
-std::int64_t App::now() { return hal::stm::systick_get(); }
+std::int64_t App::now() { return hal::timestep::now(); }
 
 JoystickState App::get_joystick_state() {
   constexpr int JOY_MIN = 0;
@@ -156,6 +162,10 @@ void App::log(const char *fmt, ...) {
 
 void App::sleep(std::int64_t ms) { hal::stm::delay_timed(ms); }
 
+u32 hal::profiler::clock_ticks() { return DWT->CYCCNT; }
+
+u32 hal::profiler::ticks_per_us() { return hal::stm::SYS_FREQUENCY / 1000000; }
+
 void App::tick(float dt) {
   // Only check for hold events (press/release are handled by interrupts)
   for (int i = 0; i < NUM_BUTTONS; ++i) {
@@ -163,7 +173,7 @@ void App::tick(float dt) {
 
     // Check for hold event
     if (bs.last_state && bs.last_down >= 0 && !bs.handled_hold) {
-      i64 held_time = now() - bs.last_down;
+      i64 held_time = hal::stm::systick_get() - bs.last_down;
       if (held_time >= BUTTON_HOLD_THRESHOLD_MS) {
         on_button_held(static_cast<Button>(i));
         bs.handled_hold = true;
@@ -173,19 +183,57 @@ void App::tick(float dt) {
 }
 
 void App::loop() {
-  i64 last_tick = now();
+  hal::gpu::Fence frame_fence = 0;
+  bool present = true;
+  // Parts of the back buffer that are older than what is on screen
+  hal::damage::Region stale;
   while (*this) {
-    i64 current = now();
-    float dt = (current - last_tick) * 1e-3f;
-    tick(dt);
-    last_tick = current;
+    // debug commands over the UART: 'p' toggles the profiler overlay, 'd'
+    // dumps the profile back as CSV
+    if (stdout_usart.is_read_ready()) {
+      u8 c = stdout_usart.read();
+      if (c == 'p')
+        on_debug_command(DebugCommand::ToggleProfiler);
+      else if (c == 'd')
+        on_debug_command(DebugCommand::DumpProfile);
+    }
+
+    // The loop wakes up on every interrupt, ticks only run at TICK_RATE
+    hal::timestep::advance(hal::stm::systick_get());
+    while (hal::timestep::next_tick())
+      tick(hal::timestep::TICK_DT);
 
     // Check if vblank occurred and we should render this frame
-    if (hal::stm::begin_frame(buffer_index)) {
+    if (hal::stm::begin_frame(buffer_index, frame_fence, present)) {
+      // ticks since the last frame are counted towards this one
+      hal::profiler::begin_frame();
       auto buffer = hal::stm::pixel_buffer(buffer_index);
       Surface fb_region{buffer,      App::WIDTH,          App::WIDTH,
                         App::HEIGHT, PixelFormat::RGB565, buffer_index};
-      render(fb_region);
+
+      // Copy what changed last frame from the front buffer, so that render()
+      // only has to redraw this frame's damage, unless it redraws everything.
+      // These surfaces have no buffer index, so the copies don't count as
+      // damage themselves.
+      Surface back{buffer, App::WIDTH, App::WIDTH, App::HEIGHT};
+      ConstSurface front{hal::stm::pixel_buffer(buffer_index ^ 1), App::WIDTH,
+                         App::WIDTH, App::HEIGHT};
+      if (is_opaque())
+        stale.clear();
+      for (u32 i = 0; i < stale.count; ++i) {
+        const auto &r = stale.rects[i];
+        hal::gpu::blit(back.subsurface(r.x, r.y, r.w, r.h),
+                       front.subsurface(r.x, r.y, r.w, r.h));
+      }
+
+      hal::strips::render_frame(*this, fb_region);
+      // an unchanged frame is neither presented nor copied
+      stale = hal::damage::current();
+      present = !stale.empty();
+      // the DMA2D keeps drawing while we tick the next frame, begin_frame()
+      // waits for it before presenting the buffer
+      frame_fence = hal::gpu::insert_fence();
+      hal::profiler::end_frame();
     }
 
     // TODO: Process audio when needed
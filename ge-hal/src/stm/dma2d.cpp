@@ -1,21 +1,13 @@
 #include "ge-hal/stm/dma2d.hpp"
-#include "ge-hal/gpu.hpp"
 #include "ge-hal/stm/time.hpp"
 #include "ge-hal/surface.hpp"
+#include "ge-hal/typed_surface.hpp"
+#include "gpu_backend.hpp"
 #include <algorithm>
 
 namespace ge {
 namespace hal {
-
 namespace stm {
-void init_dma2d() { RCC->AHB1ENR |= RCC_AHB1ENR_DMA2DEN; }
-} // namespace stm
-
-namespace gpu {
-void wait_idle() {
-  while (DMA2D->CR & DMA2D_CR_START)
-    stm::delay_spin(1);
-}
 
 enum class Mode : u8 {
   R2M = 0x3,
@@ -24,52 +16,160 @@ enum class Mode : u8 {
   M2M_BLEND = 0x2,
 };
 
-static void set_mode(Mode mode) {
-  auto cr = DMA2D->CR;
-  cr &= ~DMA2D_CR_MODE_Msk;
-  cr = static_cast<u32>(mode) << DMA2D_CR_MODE_Pos;
-  DMA2D->CR = cr;
+// Register values for one transfer, written out when it reaches the head of
+// the queue
+struct Transfer {
+  bool load_clut;
+  u32 cr;
+  u32 fgpfccr;
+  usize fgmar;
+  u32 fgor;
+  u32 fgcolr;
+  u32 bgpfccr;
+  usize bgmar;
+  u32 bgor;
+  u32 opfccr;
+  u32 ocolr;
+  usize omar;
+  u32 oor;
+  u32 nlr;
+  usize fgcmar;
+};
+
+static constexpr u32 QUEUE_SIZE = 32;
+static constexpr u32 IRQ_ENABLE =
+    DMA2D_CR_TCIE | DMA2D_CR_CTCIE | DMA2D_CR_TEIE | DMA2D_CR_CEIE;
+
+// Written by submit() with the DMA2D interrupt masked, and by the interrupt
+static Transfer queue[QUEUE_SIZE];
+static volatile u32 queue_head = 0, queue_size = 0;
+static volatile bool running = false;
+// Fences: number of transfers submitted and completed so far
+static volatile u32 submitted = 0, completed = 0;
+static Dma2dStats stats;
+
+// CLUT size and format from the last load_palette(). Every FGPFCCR written
+// after that must keep them, as the hardware would.
+static u32 clut_config = 0;
+
+void init_dma2d() {
+  RCC->AHB1ENR |= RCC_AHB1ENR_DMA2DEN;
+  NVIC_SetPriority(DMA2D_IRQn, 1);
+  NVIC_EnableIRQ(DMA2D_IRQn);
 }
 
-static void setup_output(Surface dst) {
-  DMA2D->OPFCCR = static_cast<u32>(dst.get_pixel_format());
-  DMA2D->OMAR = reinterpret_cast<u32>(dst.data());
-  DMA2D->OOR = dst.get_stride() - dst.get_width();
-  DMA2D->NLR = (dst.get_width() << DMA2D_NLR_PL_Pos) |
-               (dst.get_height() << DMA2D_NLR_NL_Pos);
+const Dma2dStats &dma2d_stats() { return stats; }
+
+void reset_dma2d_stats() { stats = {}; }
+
+static usize bus_address(const void *ptr) {
+  return reinterpret_cast<usize>(ptr);
 }
 
-static void setup_background(Surface bg) {
-  DMA2D->BGPFCCR = static_cast<u32>(bg.get_pixel_format());
-  DMA2D->BGMAR = reinterpret_cast<u32>(bg.data());
-  DMA2D->BGOR = bg.get_stride() - bg.get_width();
+static void start(const Transfer &t) {
+  if (t.load_clut) {
+    DMA2D->CR = IRQ_ENABLE;
+    DMA2D->FGCMAR = t.fgcmar;
+    DMA2D->FGPFCCR = t.fgpfccr;
+    DMA2D->FGPFCCR = t.fgpfccr | DMA2D_FGPFCCR_START;
+    return;
+  }
+
+  DMA2D->FGPFCCR = t.fgpfccr;
+  DMA2D->FGMAR = t.fgmar;
+  DMA2D->FGOR = t.fgor;
+  DMA2D->FGCOLR = t.fgcolr;
+  DMA2D->BGPFCCR = t.bgpfccr;
+  DMA2D->BGMAR = t.bgmar;
+  DMA2D->BGOR = t.bgor;
+  DMA2D->OPFCCR = t.opfccr;
+  DMA2D->OCOLR = t.ocolr;
+  DMA2D->OMAR = t.omar;
+  DMA2D->OOR = t.oor;
+  DMA2D->NLR = t.nlr;
+  DMA2D->CR = t.cr | DMA2D_CR_START;
+}
+
+static u32 submit(const Transfer &t) {
+  NVIC_DisableIRQ(DMA2D_IRQn);
+  if (queue_size == QUEUE_SIZE) {
+    ++stats.full_stalls;
+    while (queue_size == QUEUE_SIZE) {
+      NVIC_EnableIRQ(DMA2D_IRQn);
+      delay_spin(1);
+      NVIC_DisableIRQ(DMA2D_IRQn);
+    }
+  }
+
+  u32 fence = ++submitted;
+  ++stats.submitted;
+  if (!running) {
+    running = true;
+    start(t);
+  } else {
+    queue[(queue_head + queue_size) % QUEUE_SIZE] = t;
+    ++queue_size;
+    stats.max_depth = std::max<u32>(stats.max_depth, u32{queue_size});
+  }
+  NVIC_EnableIRQ(DMA2D_IRQn);
+  return fence;
+}
+
+static void wait_fence(u32 fence) {
+  while (static_cast<i32>(completed - fence) < 0)
+    delay_spin(1);
 }
 
-static void setup_input(ConstSurface src, u8 global_alpha = 0,
+} // namespace stm
+
+namespace gpu {
+namespace backend {
+
+using stm::Mode;
+using stm::Transfer;
+
+void wait_idle() { stm::wait_fence(stm::submitted); }
+
+u32 insert_fence() { return stm::submitted; }
+
+void wait_fence(u32 fence) { stm::wait_fence(fence); }
+
+static Transfer transfer(Mode mode) {
+  Transfer t{};
+  t.cr = (static_cast<u32>(mode) << DMA2D_CR_MODE_Pos) | stm::IRQ_ENABLE;
+  return t;
+}
+
+static void setup_output(Transfer &t, Surface dst) {
+  t.opfccr = static_cast<u32>(dst.get_pixel_format());
+  t.omar = stm::bus_address(dst.data());
+  t.oor = dst.get_stride() - dst.get_width();
+  t.nlr = (dst.get_width() << DMA2D_NLR_PL_Pos) |
+          (dst.get_height() << DMA2D_NLR_NL_Pos);
+}
+
+static void setup_background(Transfer &t, Surface bg) {
+  t.bgpfccr = static_cast<u32>(bg.get_pixel_format());
+  t.bgmar = stm::bus_address(bg.data());
+  t.bgor = bg.get_stride() - bg.get_width();
+}
+
+static void setup_input(Transfer &t, ConstSurface src, u8 global_alpha = 0,
                         u8 alpha_mode = 0) {
-  uint32_t current_clut =
-      DMA2D->FGPFCCR &
-      (DMA2D_FGPFCCR_CCM | DMA2D_FGPFCCR_CS | DMA2D_FGPFCCR_START);
-  DMA2D->FGPFCCR =
-      current_clut |
+  t.fgpfccr =
+      stm::clut_config |
       (static_cast<u32>(src.get_pixel_format()) << DMA2D_FGPFCCR_CM_Pos) |
       (alpha_mode << DMA2D_FGPFCCR_AM_Pos) |
       (global_alpha << DMA2D_FGPFCCR_ALPHA_Pos);
-  DMA2D->FGMAR = reinterpret_cast<u32>(src.data());
-  DMA2D->FGOR = src.get_stride() - src.get_width();
-}
-
-static void fire() {
-  DMA2D->CR |= DMA2D_CR_START;
-  wait_idle();
+  t.fgmar = stm::bus_address(src.data());
+  t.fgor = src.get_stride() - src.get_width();
 }
 
 void fill(Surface dst, u32 color) {
-  wait_idle();
-  set_mode(Mode::R2M);
-  DMA2D->OCOLR = color;
-  setup_output(dst);
-  fire();
+  auto t = transfer(Mode::R2M);
+  t.ocolr = color;
+  setup_output(t, dst);
+  stm::submit(t);
 }
 
 static void normalize_regions(Surface &dst, ConstSurface &src) {
@@ -81,53 +181,93 @@ static void normalize_regions(Surface &dst, ConstSurface &src) {
 
 void blit(Surface dst, ConstSurface src) {
   normalize_regions(dst, src);
-  wait_idle();
-  set_mode((src.get_pixel_format() == dst.get_pixel_format()) ? Mode::M2M
-                                                              : Mode::M2M_PFC);
-  setup_output(dst);
-  setup_input(src);
-  fire();
+  auto t = transfer((src.get_pixel_format() == dst.get_pixel_format())
+                        ? Mode::M2M
+                        : Mode::M2M_PFC);
+  setup_output(t, dst);
+  setup_input(t, src);
+  stm::submit(t);
 }
 
 void blit_blend(Surface dst, ConstSurface src, u8 global_alpha) {
   normalize_regions(dst, src);
-  wait_idle();
-  set_mode(Mode::M2M_BLEND);
-  setup_output(dst);
-  setup_input(src, global_alpha, 2);
-  setup_background(dst);
-  fire();
+  auto t = transfer(Mode::M2M_BLEND);
+  setup_output(t, dst);
+  setup_input(t, src, global_alpha, 2);
+  setup_background(t, dst);
+  stm::submit(t);
 }
 
-void load_palette(const u32 *colors, usize num_colors) {
-  wait_idle();
+// A8/A4 sources have no color of their own, the DMA2D takes it from FGCOLR
+void blit_blend_alpha(Surface dst, ConstSurface src, u32 color,
+                      u8 global_alpha) {
+  normalize_regions(dst, src);
+  auto t = transfer(Mode::M2M_BLEND);
+  setup_output(t, dst);
+  setup_input(t, src, global_alpha, 2);
+  t.fgcolr = color & 0x00FFFFFF;
+  setup_background(t, dst);
+  stm::submit(t);
+}
 
-  // 1. Point to Colors
-  DMA2D->FGCMAR = reinterpret_cast<u32>(colors);
+// The DMA2D only blends straight alpha: these are blended by the CPU once
+// the transfers that may touch dst are done. The frontend only passes
+// ARGB8888 sources.
+void blit_blend_premultiplied(Surface dst, ConstSurface src, u8 global_alpha) {
+  normalize_regions(dst, src);
+  stm::wait_fence(stm::submitted);
+  ConstTypedSurface<PixelFormat::ARGB8888> typed_src{src};
+  visit(dst, [&](auto typed_dst) {
+    pixel::blend_premultiplied(typed_dst, typed_src, global_alpha);
+  });
+}
 
-  // 2. Configure Load
+void load_palette(const u32 *colors, usize num_colors) {
   // Size = count - 1. Mode = ARGB8888 (0).
-  DMA2D->FGPFCCR = ((num_colors - 1) << DMA2D_FGPFCCR_CS_Pos) |
-                   (0x00 << DMA2D_FGPFCCR_CCM_Pos);
+  stm::clut_config = ((num_colors - 1) << DMA2D_FGPFCCR_CS_Pos) |
+                     (0x00 << DMA2D_FGPFCCR_CCM_Pos);
 
-  // 3. Start Load
-  DMA2D->FGPFCCR |= DMA2D_FGPFCCR_START;
-
-  // 4. Wait strictly for CLUT load to finish
-  while (!(DMA2D->ISR & DMA2D_ISR_CTCIF))
-    stm::delay_spin(1);
-  DMA2D->IFCR = DMA2D_IFCR_CCTCIF;
+  // Queued like any other transfer, so blits submitted before this still
+  // use the previous palette. colors must stay valid until it has run.
+  Transfer t{};
+  t.load_clut = true;
+  t.fgcmar = stm::bus_address(colors);
+  t.fgpfccr = stm::clut_config;
+  stm::submit(t);
 }
 
 void blit_indexed(Surface dst, ConstSurface src) {
   normalize_regions(dst, src);
-  wait_idle();
-  set_mode(Mode::M2M_PFC);
-  setup_output(dst);
-  setup_input(src);
-  fire();
+  auto t = transfer(Mode::M2M_PFC);
+  setup_output(t, dst);
+  setup_input(t, src);
+  stm::submit(t);
 }
 
+} // namespace backend
 } // namespace gpu
 } // namespace hal
 } // namespace ge
+
+extern "C" void DMA2D_IRQHandler() {
+  using namespace ge::hal::stm;
+  auto isr = DMA2D->ISR;
+  DMA2D->IFCR = DMA2D_IFCR_CTEIF | DMA2D_IFCR_CTCIF | DMA2D_IFCR_CCTCIF |
+                DMA2D_IFCR_CCEIF;
+  if (!(isr & (DMA2D_ISR_TCIF | DMA2D_ISR_CTCIF | DMA2D_ISR_TEIF |
+               DMA2D_ISR_CEIF)))
+    return;
+
+  // a failed transfer is dropped, so that waiting on it can't hang
+  if (isr & (DMA2D_ISR_TEIF | DMA2D_ISR_CEIF))
+    ++stats.errors;
+  ++completed;
+
+  if (queue_size == 0) {
+    running = false;
+    return;
+  }
+  start(queue[queue_head]);
+  queue_head = (queue_head + 1) % QUEUE_SIZE;
+  --queue_size;
+}
@@ -0,0 +1,252 @@
+#include "ge-hal/stm/dma2d_model.hpp"
+#include "ge-hal/stm/time.hpp"
+#include "ge-hal/surface.hpp"
+#include "ge-hal/sw/blit.hpp"
+#include <cstdio>
+
+namespace ge {
+namespace hal {
+namespace stm {
+namespace model {
+
+DMA2D_TypeDef dma2d_regs;
+RCC_TypeDef rcc_regs;
+
+namespace {
+
+// Rough DMA2D costs in CPU cycles, with the framebuffer in SDRAM. Only meant
+// for comparing one schedule against another.
+constexpr u64 SETUP_CYCLES = 16;
+constexpr u64 CYCLES_PER_PIXEL[] = {
+    2, // M2M
+    3, // M2M_PFC
+    4, // M2M_BLEND
+    1, // R2M
+};
+
+Stats model_stats;
+bool irq_enabled = false;
+bool in_irq = false;
+
+// What the engine is doing. Registers are latched when a transfer starts,
+// the pixels are written when it completes.
+enum class State : u8 { Idle, Transfer, LoadClut };
+State state = State::Idle;
+DMA2D_TypeDef latched;
+u64 done_at = 0;
+
+u32 irq_flags() {
+  u32 cr = dma2d_regs.CR, isr = dma2d_regs.ISR, flags = 0;
+  if (cr & DMA2D_CR_TCIE)
+    flags |= isr & DMA2D_ISR_TCIF;
+  if (cr & DMA2D_CR_CTCIE)
+    flags |= isr & DMA2D_ISR_CTCIF;
+  if (cr & DMA2D_CR_TEIE)
+    flags |= isr & DMA2D_ISR_TEIF;
+  if (cr & DMA2D_CR_CEIE)
+    flags |= isr & DMA2D_ISR_CEIF;
+  return flags;
+}
+
+void apply_ifcr() {
+  // IFCR bits clear the ISR bits at the same positions
+  dma2d_regs.ISR &= ~dma2d_regs.IFCR;
+  dma2d_regs.IFCR = 0;
+}
+
+void service_irq() {
+  apply_ifcr();
+  // the line stays asserted until the handler clears the flag
+  while (irq_enabled && !in_irq && irq_flags()) {
+    in_irq = true;
+    ++model_stats.irqs;
+    DMA2D_IRQHandler();
+    apply_ifcr();
+    in_irq = false;
+  }
+}
+
+void config_error(const char *what) {
+  std::printf("dma2d model: configuration error: %s\n", what);
+  ++model_stats.config_errors;
+  dma2d_regs.CR &= ~DMA2D_CR_START;
+  dma2d_regs.ISR |= DMA2D_ISR_CEIF;
+}
+
+u32 pixels_per_line(const DMA2D_TypeDef &r) {
+  return (r.NLR & DMA2D_NLR_PL_Msk) >> DMA2D_NLR_PL_Pos;
+}
+
+u32 number_of_lines(const DMA2D_TypeDef &r) {
+  return (r.NLR & DMA2D_NLR_NL_Msk) >> DMA2D_NLR_NL_Pos;
+}
+
+u32 mode_of(const DMA2D_TypeDef &r) {
+  return (r.CR & DMA2D_CR_MODE_Msk) >> DMA2D_CR_MODE_Pos;
+}
+
+// Sample the start bits, like the peripheral does on a register write
+void poll() {
+  if (state != State::Idle)
+    return;
+
+  if (dma2d_regs.FGPFCCR & DMA2D_FGPFCCR_START) {
+    if (dma2d_regs.FGPFCCR & DMA2D_FGPFCCR_CCM) {
+      dma2d_regs.FGPFCCR &= ~DMA2D_FGPFCCR_START;
+      config_error("only ARGB8888 CLUTs are modelled");
+      return;
+    }
+    latched = dma2d_regs;
+    u32 entries = ((latched.FGPFCCR & DMA2D_FGPFCCR_CS_Msk) >>
+                   DMA2D_FGPFCCR_CS_Pos) +
+                  1;
+    state = State::LoadClut;
+    done_at = model_stats.cycles + SETUP_CYCLES + entries;
+    return;
+  }
+
+  if (!(dma2d_regs.CR & DMA2D_CR_START))
+    return;
+
+  latched = dma2d_regs;
+  u32 pl = pixels_per_line(latched), nl = number_of_lines(latched);
+  if (pl == 0 || nl == 0)
+    return config_error("empty transfer");
+  u32 out_fmt = latched.OPFCCR & DMA2D_OPFCCR_CM_Msk;
+  if (out_fmt > static_cast<u32>(PixelFormat::ARGB4444))
+    return config_error("invalid output color mode");
+  u32 mode = mode_of(latched);
+  if (mode != 0x3) {
+    u32 fg_fmt = latched.FGPFCCR & DMA2D_FGPFCCR_CM_Msk;
+    if (fg_fmt > static_cast<u32>(PixelFormat::A4))
+      return config_error("invalid foreground color mode");
+    if (mode == 0x0 && fg_fmt != out_fmt)
+      return config_error("M2M without PFC needs matching color modes");
+  }
+
+  state = State::Transfer;
+  done_at = model_stats.cycles + SETUP_CYCLES +
+            static_cast<u64>(pl) * nl * CYCLES_PER_PIXEL[mode];
+}
+
+template <class T>
+BaseSurface<T> surface_at(usize address, u32 offset, u32 fmt,
+                          const DMA2D_TypeDef &r) {
+  u32 pl = pixels_per_line(r);
+  return BaseSurface<T>{reinterpret_cast<T *>(address), pl + offset, pl,
+                        number_of_lines(r), static_cast<PixelFormat>(fmt)};
+}
+
+void run_transfer(const DMA2D_TypeDef &r) {
+  Surface out = surface_at<void>(r.OMAR, r.OOR & DMA2D_OOR_LO_Msk,
+                                 r.OPFCCR & DMA2D_OPFCCR_CM_Msk, r);
+  ConstSurface fg =
+      surface_at<const void>(r.FGMAR, r.FGOR & DMA2D_FGOR_LO_Msk,
+                             r.FGPFCCR & DMA2D_FGPFCCR_CM_Msk, r);
+  u32 alpha_mode = (r.FGPFCCR & DMA2D_FGPFCCR_AM_Msk) >> DMA2D_FGPFCCR_AM_Pos;
+  u8 alpha = (r.FGPFCCR & DMA2D_FGPFCCR_ALPHA_Msk) >> DMA2D_FGPFCCR_ALPHA_Pos;
+
+  switch (mode_of(r)) {
+  case 0x3:
+    sw::fill(out, r.OCOLR);
+    break;
+  case 0x0:
+  case 0x1:
+    if (alpha_mode != 0)
+      std::printf("dma2d model: alpha modes are ignored without blending\n");
+    sw::blit(out, fg);
+    break;
+  case 0x2: {
+    ConstSurface bg =
+        surface_at<const void>(r.BGMAR, r.BGOR & DMA2D_BGOR_LO_Msk,
+                               r.BGPFCCR & DMA2D_FGPFCCR_CM_Msk, r);
+    // sw blends onto the output, so start from the background
+    if (bg.data() != out.data() || bg.get_stride() != out.get_stride() ||
+        bg.get_pixel_format() != out.get_pixel_format())
+      sw::blit(out, bg);
+    if (alpha_mode == 1)
+      std::printf("dma2d model: alpha replacement is not modelled\n");
+    u8 global_alpha = alpha_mode == 0 ? 0xFF : alpha;
+    // the RGB of alpha-only pixels is FGCOLR
+    auto fg_fmt = fg.get_pixel_format();
+    if (fg_fmt == PixelFormat::A8 || fg_fmt == PixelFormat::A4)
+      sw::blit_blend_alpha(out, fg, r.FGCOLR, global_alpha);
+    else
+      sw::blit_blend(out, fg, global_alpha);
+    break;
+  }
+  }
+}
+
+void complete() {
+  if (state == State::LoadClut) {
+    u32 entries = ((latched.FGPFCCR & DMA2D_FGPFCCR_CS_Msk) >>
+                   DMA2D_FGPFCCR_CS_Pos) +
+                  1;
+    sw::load_palette(reinterpret_cast<const u32 *>(latched.FGCMAR), entries);
+    dma2d_regs.FGPFCCR &= ~DMA2D_FGPFCCR_START;
+    dma2d_regs.ISR |= DMA2D_ISR_CTCIF;
+  } else {
+    run_transfer(latched);
+    dma2d_regs.CR &= ~DMA2D_CR_START;
+    dma2d_regs.ISR |= DMA2D_ISR_TCIF;
+  }
+  state = State::Idle;
+  ++model_stats.transfers;
+}
+
+} // namespace
+
+void advance(u64 cycles, bool cpu_waiting) {
+  u64 end = model_stats.cycles + cycles;
+  service_irq();
+  poll();
+  service_irq();
+
+  while (state != State::Idle && done_at <= end) {
+    u64 busy = done_at - model_stats.cycles;
+    model_stats.busy_cycles += busy;
+    if (cpu_waiting)
+      model_stats.wait_cycles += busy;
+    model_stats.cycles = done_at;
+
+    complete();
+    // the interrupt usually starts the next transfer right away
+    service_irq();
+    poll();
+    service_irq();
+  }
+
+  u64 rest = end - model_stats.cycles;
+  if (state != State::Idle)
+    model_stats.busy_cycles += rest;
+  else if (cpu_waiting)
+    model_stats.idle_waits += rest;
+  if (cpu_waiting)
+    model_stats.wait_cycles += rest;
+  model_stats.cycles = end;
+}
+
+const Stats &stats() { return model_stats; }
+
+void reset() {
+  dma2d_regs = {};
+  rcc_regs = {};
+  model_stats = {};
+  state = State::Idle;
+}
+
+void set_irq_enabled(bool enabled) {
+  irq_enabled = enabled;
+  if (enabled)
+    service_irq();
+}
+
+} // namespace model
+
+// Spinning is the only way the driver lets time pass, about 4 cycles a turn
+void delay_spin(volatile u32 count) { model::advance(count * 4ULL, true); }
+
+} // namespace stm
+} // namespace hal
+} // namespace ge
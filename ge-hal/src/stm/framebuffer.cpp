@@ -1,7 +1,10 @@
 #include "ge-hal/stm/framebuffer.hpp"
 
 #include "ge-hal/app.hpp"
+#include "ge-hal/gpu.hpp"
+#include "ge-hal/layers.hpp"
 #include "ge-hal/stm/gpio.hpp"
+#include "ge-hal/stm/ltdc.hpp"
 #include "ge-hal/stm/sdram.hpp"
 #include "ge-hal/stm/spi.hpp"
 #include "ge-hal/stm/time.hpp"
@@ -202,21 +205,8 @@ void init_ltdc() {
   LTDC->GCR &=
       ~(LTDC_GCR_HSPOL | LTDC_GCR_VSPOL | LTDC_GCR_DEPOL | LTDC_GCR_PCPOL);
 
-  // Layer1 setup
-  LTDC_Layer1->WHPCR =
-      ((hsw + hbp) << LTDC_LxWHPCR_WHSTPOS_Pos) |
-      ((hsw + hbp + App::WIDTH - 1) << LTDC_LxWHPCR_WHSPPOS_Pos);
-  LTDC_Layer1->WVPCR =
-      ((vsw + vbp) << LTDC_LxWVPCR_WVSTPOS_Pos) |
-      ((vsw + vbp + App::HEIGHT - 1) << LTDC_LxWVPCR_WVSPPOS_Pos);
-  LTDC_Layer1->PFCR = 0x02UL << LTDC_LxPFCR_PF_Pos;
-  LTDC_Layer1->CACR = 0xFFUL << LTDC_LxCACR_CONSTA_Pos;
-  LTDC_Layer1->CFBAR = reinterpret_cast<u32>(framebuffer_storage[0]);
-  u32 pitch = App::WIDTH * 2;
-  u32 line_length = App::WIDTH * 2;
-  LTDC_Layer1->CFBLR = (pitch << 16) | (line_length + 3);
-  LTDC_Layer1->CFBLNR = App::HEIGHT << LTDC_LxCFBLNR_CFBLNBR_Pos;
-  LTDC_Layer1->CR |= 1;
+  // Layer setup, the framebuffer alone until hal::layers says otherwise
+  write_layer_registers(framebuffer_storage[0]);
 
   LCD lcd;
   lcd.exec(LCD::Command::eRGB_INTERFACE, {0xC2});
@@ -236,13 +226,30 @@ void init_ltdc() {
 }
 
 volatile bool vblank = false;
+// The hal::layers::revision() in the layer registers
+static u32 layers_revision = 0;
 
-bool begin_frame(u32 &buffer_index) {
+bool begin_frame(u32 &buffer_index, u32 render_fence, bool present) {
   // 1. Basic check: Did the ISR fire?
   if (!vblank) {
     return false;
   }
 
+  // Nothing changed last frame, keep rendering into the same buffer
+  if (!present) {
+    vblank = false;
+    // but a layer may have scrolled, reloaded at the next vblank
+    if (hal::layers::revision() != layers_revision) {
+      write_layer_registers(pixel_buffer(buffer_index ^ 1));
+      layers_revision = hal::layers::revision();
+      LTDC->SRCR = LTDC_SRCR_VBR;
+    }
+    return true;
+  }
+
+  // The buffer we are about to present may still be drawn by the DMA2D
+  gpu::wait_fence(render_fence);
+
   // 2. TIMING CHECK (Crucial for Audio/Polling)
   // Check if we are currently in the Active Video area.
   // VDES (Vertical Data Enable) is High when pixels are being drawn.
@@ -258,7 +265,9 @@ bool begin_frame(u32 &buffer_index) {
   // 3. We are in the Safe Zone (VBlank). Commit the Swap.
   vblank = false;
 
-  LTDC_Layer1->CFBAR = reinterpret_cast<u32>(pixel_buffer(buffer_index));
+  // the new buffer, and whatever changed in hal::layers
+  write_layer_registers(pixel_buffer(buffer_index));
+  layers_revision = hal::layers::revision();
 
   // Since we verified we are in VBlank (via VDES check above),
   // we can use Immediate Reload (IMR) safely, or VBR.
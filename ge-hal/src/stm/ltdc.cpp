@@ -0,0 +1,64 @@
+#include "ge-hal/stm/ltdc.hpp"
+#include "ge-hal/app.hpp"
+#include "ge-hal/layers.hpp"
+
+namespace ge {
+namespace hal {
+namespace stm {
+
+namespace {
+
+// Blending factors: pixel alpha x constant alpha over the layers below
+constexpr u32 BF1_PAxCA = 6, BF2_PAxCA = 7;
+
+void write_layer(LTDC_Layer_TypeDef *regs, const ConstSurface &window,
+                 u8 alpha) {
+  const u32 w = window.get_width(), h = window.get_height();
+  if (!window.data() || w == 0 || h == 0) {
+    regs->CR &= ~LTDC_LxCR_LEN;
+    return;
+  }
+
+  // the first active pixel, right after the back porches
+  const u32 x0 = ((LTDC->BPCR & LTDC_BPCR_AHBP_Msk) >> LTDC_BPCR_AHBP_Pos) + 1;
+  const u32 y0 = ((LTDC->BPCR & LTDC_BPCR_AVBP_Msk) >> LTDC_BPCR_AVBP_Pos) + 1;
+  regs->WHPCR = (x0 << LTDC_LxWHPCR_WHSTPOS_Pos) |
+                ((x0 + w - 1) << LTDC_LxWHPCR_WHSPPOS_Pos);
+  regs->WVPCR = (y0 << LTDC_LxWVPCR_WVSTPOS_Pos) |
+                ((y0 + h - 1) << LTDC_LxWVPCR_WVSPPOS_Pos);
+
+  // the LTDC pixel formats have the same codes as PixelFormat
+  const auto fmt = window.get_pixel_format();
+  regs->PFCR = static_cast<u32>(fmt) << LTDC_LxPFCR_PF_Pos;
+  regs->CACR = u32(alpha) << LTDC_LxCACR_CONSTA_Pos;
+  regs->DCCR = 0;
+  regs->BFCR = (BF1_PAxCA << LTDC_LxBFCR_BF1_Pos) |
+               (BF2_PAxCA << LTDC_LxBFCR_BF2_Pos);
+
+  // scrolling is only a matter of where the window starts in the buffer
+  const u32 bytes_per_pixel = pixel_format_bpp(fmt) / 8;
+  const u32 pitch = window.get_stride() * bytes_per_pixel;
+  const u32 line_length = w * bytes_per_pixel;
+  regs->CFBAR = reinterpret_cast<usize>(window.data());
+  regs->CFBLR = (pitch << LTDC_LxCFBLR_CFBP_Pos) |
+                ((line_length + 3) << LTDC_LxCFBLR_CFBLL_Pos);
+  regs->CFBLNR = h << LTDC_LxCFBLNR_CFBLNBR_Pos;
+  regs->CR |= LTDC_LxCR_LEN;
+}
+
+} // namespace
+
+void write_layer_registers(const u16 *framebuffer) {
+  ConstSurface fb{framebuffer, App::WIDTH, App::WIDTH, App::HEIGHT};
+  LTDC_Layer_TypeDef *const regs[layers::NUM_LAYERS] = {LTDC_Layer1,
+                                                         LTDC_Layer2};
+  for (u32 i = 0; i < layers::NUM_LAYERS; ++i) {
+    auto layer = static_cast<layers::Layer>(i);
+    write_layer(regs[i], layers::window(layer, fb),
+                layers::state(layer).alpha);
+  }
+}
+
+} // namespace stm
+} // namespace hal
+} // namespace ge
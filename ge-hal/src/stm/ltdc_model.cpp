@@ -0,0 +1,171 @@
+#include "ge-hal/stm/ltdc_model.hpp"
+#include "ge-hal/pixel.hpp"
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+namespace ge {
+namespace hal {
+namespace stm {
+namespace model {
+
+LTDC_TypeDef ltdc_regs;
+LTDC_Layer_TypeDef layer_regs[2];
+
+namespace {
+
+// What the LTDC scans out with, loaded from the shadow registers on reload
+LTDC_Layer_TypeDef active[2];
+u32 errors = 0;
+
+u32 field(u32 reg, u32 mask, u32 pos) { return (reg & mask) >> pos; }
+
+void config_error(const char *what) {
+  std::printf("ltdc model: configuration error: %s\n", what);
+  ++errors;
+}
+
+// The pixel at the given address, expanded to ARGB8888 by the pixel format
+// converter, or false for the formats the model does not handle
+bool fetch(u32 pf, const u8 *address, pixel::Rgba &c) {
+  auto load = [&](auto format_tag) {
+    constexpr auto format = decltype(format_tag)::value;
+    pixel::type_t<format> raw;
+    std::memcpy(&raw, address, sizeof(raw));
+    c = pixel::Traits<format>::unpack(raw);
+  };
+  switch (static_cast<PixelFormat>(pf)) {
+  case PixelFormat::ARGB8888:
+    load(std::integral_constant<PixelFormat, PixelFormat::ARGB8888>{});
+    return true;
+  case PixelFormat::RGB565:
+    load(std::integral_constant<PixelFormat, PixelFormat::RGB565>{});
+    return true;
+  case PixelFormat::ARGB1555:
+    load(std::integral_constant<PixelFormat, PixelFormat::ARGB1555>{});
+    return true;
+  case PixelFormat::ARGB4444:
+    load(std::integral_constant<PixelFormat, PixelFormat::ARGB4444>{});
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Blending factor from its BFCR code, in 1/255ths
+u32 factor(u32 code, u32 constant_alpha, u32 pixel_alpha) {
+  u32 ca_pa = (constant_alpha * pixel_alpha + 127) / 255;
+  switch (code) {
+  case 4: // constant alpha
+    return constant_alpha;
+  case 5: // 1 - constant alpha
+    return 255 - constant_alpha;
+  case 6: // pixel alpha x constant alpha
+    return ca_pa;
+  case 7: // 1 - pixel alpha x constant alpha
+    return 255 - ca_pa;
+  default:
+    config_error("reserved blending factor");
+    return 0;
+  }
+}
+
+// Blends layer l over color at the screen position (hx, hy), in the
+// coordinates of the timing registers
+bool blend_layer(const LTDC_Layer_TypeDef &l, u32 hx, u32 hy, u32 &color) {
+  const u32 x0 = field(l.WHPCR, LTDC_LxWHPCR_WHSTPOS_Msk,
+                       LTDC_LxWHPCR_WHSTPOS_Pos);
+  const u32 x1 = field(l.WHPCR, LTDC_LxWHPCR_WHSPPOS_Msk,
+                       LTDC_LxWHPCR_WHSPPOS_Pos);
+  const u32 y0 = field(l.WVPCR, LTDC_LxWVPCR_WVSTPOS_Msk,
+                       LTDC_LxWVPCR_WVSTPOS_Pos);
+  const u32 y1 = field(l.WVPCR, LTDC_LxWVPCR_WVSPPOS_Msk,
+                       LTDC_LxWVPCR_WVSPPOS_Pos);
+  // outside its window a layer is not blended at all
+  if (hx < x0 || hx > x1 || hy < y0 || hy > y1)
+    return true;
+
+  const u32 pf = field(l.PFCR, LTDC_LxPFCR_PF_Msk, LTDC_LxPFCR_PF_Pos);
+  const u32 bytes_per_pixel =
+      pixel_format_bpp(static_cast<PixelFormat>(pf)) / 8;
+  const u32 pitch = field(l.CFBLR, LTDC_LxCFBLR_CFBP_Msk,
+                          LTDC_LxCFBLR_CFBP_Pos);
+  const u32 line_length =
+      field(l.CFBLR, LTDC_LxCFBLR_CFBLL_Msk, LTDC_LxCFBLR_CFBLL_Pos) - 3;
+  const u32 lines = field(l.CFBLNR, LTDC_LxCFBLNR_CFBLNBR_Msk,
+                          LTDC_LxCFBLNR_CFBLNBR_Pos);
+
+  // past the end of the line or of the frame buffer: the default color
+  const u32 col = (hx - x0) * bytes_per_pixel, line = hy - y0;
+  pixel::Rgba c{(l.DCCR >> 16) & 0xFF, (l.DCCR >> 8) & 0xFF, l.DCCR & 0xFF,
+                l.DCCR >> 24};
+  if (col < line_length && line < lines) {
+    const auto *address = reinterpret_cast<const u8 *>(l.CFBAR) +
+                          usize(line) * pitch + col;
+    if (l.CR & (LTDC_LxCR_COLKEN | LTDC_LxCR_CLUTEN)) {
+      config_error("color keying and CLUTs are not modelled");
+      return false;
+    }
+    if (!fetch(pf, address, c)) {
+      config_error("unsupported pixel format");
+      return false;
+    }
+  }
+
+  const u32 ca = field(l.CACR, LTDC_LxCACR_CONSTA_Msk, LTDC_LxCACR_CONSTA_Pos);
+  const u32 bf1 = field(l.BFCR, LTDC_LxBFCR_BF1_Msk, LTDC_LxBFCR_BF1_Pos);
+  const u32 bf2 = field(l.BFCR, LTDC_LxBFCR_BF2_Msk, LTDC_LxBFCR_BF2_Pos);
+  const u32 f1 = factor(bf1, ca, c.a), f2 = factor(bf2, ca, c.a);
+  // BC = BF1 x C + BF2 x Cs, channel by channel
+  auto blend = [&](u32 channel, u32 shift) {
+    u32 below = (color >> shift) & 0xFF;
+    return ((f1 * channel + f2 * below + 127) / 255) << shift;
+  };
+  color = blend(c.r, 16) | blend(c.g, 8) | blend(c.b, 0);
+  return true;
+}
+
+} // namespace
+
+void vertical_blank() {
+  if (ltdc_regs.SRCR & (LTDC_SRCR_IMR | LTDC_SRCR_VBR)) {
+    for (int i = 0; i < 2; ++i)
+      active[i] = layer_regs[i];
+  }
+  ltdc_regs.SRCR = 0;
+}
+
+void scan_out(u32 *pixels) {
+  const auto &r = ltdc_regs;
+  const u32 ahbp = field(r.BPCR, LTDC_BPCR_AHBP_Msk, LTDC_BPCR_AHBP_Pos);
+  const u32 avbp = field(r.BPCR, LTDC_BPCR_AVBP_Msk, LTDC_BPCR_AVBP_Pos);
+  const u32 aaw = field(r.AWCR, LTDC_AWCR_AAW_Msk, LTDC_AWCR_AAW_Pos);
+  const u32 aah = field(r.AWCR, LTDC_AWCR_AAH_Msk, LTDC_AWCR_AAH_Pos);
+
+  for (u32 hy = avbp + 1; hy <= aah; ++hy) {
+    for (u32 hx = ahbp + 1; hx <= aaw; ++hx) {
+      u32 color = r.BCCR & 0xFFFFFF;
+      for (const auto &layer : active) {
+        if ((layer.CR & LTDC_LxCR_LEN) && !blend_layer(layer, hx, hy, color))
+          return;
+      }
+      *pixels++ = color;
+    }
+  }
+}
+
+u32 config_errors() { return errors; }
+
+void reset() {
+  ltdc_regs = {};
+  for (int i = 0; i < 2; ++i) {
+    layer_regs[i] = {};
+    active[i] = {};
+  }
+  errors = 0;
+}
+
+} // namespace model
+} // namespace stm
+} // namespace hal
+} // namespace ge
@@ -45,6 +45,11 @@ void setup_clock() {
 
   RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
   SysTick_Config(SystemCoreClock / 1000); // Tick every 1 ms
+
+  // Cycle counter, for the profiler
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 }
 
 } // namespace stm
@@ -0,0 +1,82 @@
+#include "ge-hal/strips.hpp"
+#include "ge-hal/app.hpp"
+#include "ge-hal/damage.hpp"
+#include "ge-hal/gpu.hpp"
+#include "ge-hal/profiler.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+#ifndef GE_STRIP_HEIGHT
+#define GE_STRIP_HEIGHT 0
+#endif
+
+namespace ge {
+namespace hal {
+namespace strips {
+
+namespace {
+
+// .bss, which is in the internal SRAM on STM32
+u16 scratch[App::WIDTH * MAX_HEIGHT];
+
+u32 initial_height() {
+  u32 rows = GE_STRIP_HEIGHT;
+#ifndef GE_HAL_STM32
+  if (const char *env = std::getenv("GE_STRIP_HEIGHT"))
+    rows = static_cast<u32>(std::atoi(env));
+#endif
+  return std::min(rows, MAX_HEIGHT);
+}
+
+u32 strip_height = initial_height();
+
+void render_bands(App &app, const Surface &fb) {
+  const u32 width = fb.get_width(), height = fb.get_height();
+  const auto fmt = fb.get_pixel_format();
+
+  for (u32 y = 0; y < height; y += strip_height) {
+    GE_PROFILE_SCOPE("strips::band", profiler::Category::Render);
+    const u32 rows = std::min(strip_height, height - y);
+
+    // The frame is opaque, so the band is drawn over completely and needs
+    // none of the framebuffer's pixels. These two have no buffer index, so
+    // copying the band back is not damage.
+    Surface strip{scratch, width, width, rows, fmt};
+    Surface frame_rows{fb.pixel_at(0, y), fb.get_stride(), width, rows, fmt};
+
+    auto band = Surface::band(scratch, width, width, height, y, rows, fmt,
+                              fb.get_buffer_index());
+    damage::begin_band(band);
+    app.render(band);
+
+    // all of the band was drawn
+    hal::gpu::blit(frame_rows, strip.as_const());
+  }
+  damage::begin_band(fb);
+}
+
+} // namespace
+
+void set_height(u32 rows) { strip_height = std::min(rows, MAX_HEIGHT); }
+
+u32 height() { return strip_height; }
+
+void render_frame(App &app, const Surface &fb) {
+  damage::begin_frame(fb);
+  // A frame that redraws only parts of the framebuffer would have to copy
+  // each band in first, which costs more SDRAM bandwidth than drawing those
+  // parts in place. The scratch buffer is only as wide as the screen.
+  if (strip_height == 0 || !app.is_opaque() || !fb.is_backed() ||
+      fb.get_width() > App::WIDTH ||
+      pixel_format_bpp(fb.get_pixel_format()) != 16) {
+    Surface whole = fb;
+    app.render(whole);
+  } else {
+    render_bands(app, fb);
+  }
+  app.on_rendered();
+}
+
+} // namespace strips
+} // namespace hal
+} // namespace ge
@@ -0,0 +1,1184 @@
+#include "ge-hal/sw/blit.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define GE_SW_SSE2 1
+#endif
+
+// AVX2 kernels are compiled with a function-level target attribute and picked
+// at runtime, so the binary still runs on machines without AVX2.
+#if defined(GE_SW_SSE2) && defined(__GNUC__) &&                               \
+    (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define GE_SW_AVX2 1
+#define GE_SW_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace ge {
+namespace hal {
+namespace sw {
+
+// DMA2D CLUT, always stored as ARGB8888
+static u32 clut[256];
+// The same colors expanded once to RGB565, for indexed copies to RGB565, and
+// whether every loaded entry is opaque
+static u16 clut_rgb565[256];
+static bool clut_opaque = true;
+
+// Number of pixels converted at a time by the generic paths
+static constexpr u32 CHUNK = 64;
+
+// --- Scalar helpers ---
+// These define the reference results: the SIMD kernels below must match them
+// bit for bit.
+
+// round(x / 255) for x in [0, 255 * 255]
+static inline u32 div255(u32 x) {
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+// DMA2D expands narrow channels by replicating their MSBs into the LSBs
+static inline u32 expand4(u32 v) { return (v << 4) | v; }
+static inline u32 expand5(u32 v) { return (v << 3) | (v >> 2); }
+static inline u32 expand6(u32 v) { return (v << 2) | (v >> 4); }
+
+static inline u16 pack_rgb565(u32 r, u32 g, u32 b) {
+  return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+}
+
+static inline u16 argb8888_to_rgb565(u32 c) {
+  return pack_rgb565((c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF);
+}
+
+static inline u16 argb1555_to_rgb565(u16 c) {
+  u32 g = (c >> 5) & 0x1F;
+  return ((c & 0x7C00) << 1) | (((g << 1) | (g >> 4)) << 5) | (c & 0x1F);
+}
+
+static inline u16 blend_rgb565(u16 d, u32 r, u32 g, u32 b, u32 a) {
+  u32 ia = 255 - a;
+  return pack_rgb565(div255(r * a + expand5(d >> 11) * ia),
+                     div255(g * a + expand6((d >> 5) & 0x3F) * ia),
+                     div255(b * a + expand5(d & 0x1F) * ia));
+}
+
+// The premultiplied color plus the destination times 1 - a
+static inline u16 blend_premultiplied_rgb565(u16 d, u32 r, u32 g, u32 b,
+                                             u32 a) {
+  u32 ia = 255 - a;
+  return pack_rgb565(r + div255(expand5(d >> 11) * ia),
+                     g + div255(expand6((d >> 5) & 0x3F) * ia),
+                     b + div255(expand5(d & 0x1F) * ia));
+}
+
+// --- Row kernels: scalar ---
+
+static void blend_argb8888_rgb565_scalar(u16 *dst, const u32 *src, u32 n,
+                                         u8 global_alpha) {
+  for (u32 i = 0; i < n; ++i) {
+    u32 c = src[i];
+    u32 a = c >> 24;
+    if (global_alpha != 0xFF)
+      a = div255(a * global_alpha);
+    if (a == 0)
+      continue;
+    if (a == 0xFF)
+      dst[i] = argb8888_to_rgb565(c);
+    else
+      dst[i] =
+          blend_rgb565(dst[i], (c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF, a);
+  }
+}
+
+static void blend_premultiplied_argb8888_rgb565_scalar(u16 *dst,
+                                                      const u32 *src, u32 n,
+                                                      u8 global_alpha) {
+  for (u32 i = 0; i < n; ++i) {
+    u32 c = src[i];
+    u32 a = c >> 24, r = (c >> 16) & 0xFF, g = (c >> 8) & 0xFF, b = c & 0xFF;
+    if (global_alpha != 0xFF) {
+      a = div255(a * global_alpha);
+      r = div255(r * global_alpha);
+      g = div255(g * global_alpha);
+      b = div255(b * global_alpha);
+    }
+    if (a == 0xFF)
+      dst[i] = pack_rgb565(r, g, b);
+    else if (a | r | g | b)
+      dst[i] = blend_premultiplied_rgb565(dst[i], r, g, b, a);
+  }
+}
+
+// color (RGB888) through the A8 coverage in src
+static void blend_a8_rgb565_scalar(u16 *dst, const u8 *src, u32 n, u32 color,
+                                   u8 global_alpha) {
+  const u32 r = (color >> 16) & 0xFF, g = (color >> 8) & 0xFF, b = color & 0xFF;
+  const u16 opaque = pack_rgb565(r, g, b);
+  for (u32 i = 0; i < n; ++i) {
+    u32 a = src[i];
+    if (global_alpha != 0xFF)
+      a = div255(a * global_alpha);
+    if (a == 0)
+      continue;
+    dst[i] = a == 0xFF ? opaque : blend_rgb565(dst[i], r, g, b, a);
+  }
+}
+
+static void blend_rgb565_rgb565_scalar(u16 *dst, const u16 *src, u32 n,
+                                       u8 global_alpha) {
+  for (u32 i = 0; i < n; ++i) {
+    u16 c = src[i];
+    dst[i] = blend_rgb565(dst[i], expand5(c >> 11), expand6((c >> 5) & 0x3F),
+                          expand5(c & 0x1F), global_alpha);
+  }
+}
+
+static void blend_argb1555_rgb565_scalar(u16 *dst, const u16 *src, u32 n,
+                                         u8 global_alpha) {
+  for (u32 i = 0; i < n; ++i) {
+    u16 c = src[i];
+    if (!(c & 0x8000))
+      continue;
+    if (global_alpha == 0xFF)
+      dst[i] = argb1555_to_rgb565(c);
+    else
+      dst[i] = blend_rgb565(dst[i], expand5((c >> 10) & 0x1F),
+                            expand5((c >> 5) & 0x1F), expand5(c & 0x1F),
+                            global_alpha);
+  }
+}
+
+static void convert_argb8888_rgb565_scalar(u16 *dst, const u32 *src, u32 n) {
+  for (u32 i = 0; i < n; ++i)
+    dst[i] = argb8888_to_rgb565(src[i]);
+}
+
+static void convert_argb1555_rgb565_scalar(u16 *dst, const u16 *src, u32 n) {
+  for (u32 i = 0; i < n; ++i)
+    dst[i] = argb1555_to_rgb565(src[i]);
+}
+
+// --- Row kernels: SSE2 ---
+// 8 RGB565 pixels per iteration, one 8-bit channel per 16-bit lane.
+
+#ifdef GE_SW_SSE2
+namespace sse2 {
+
+static inline __m128i div255(__m128i x) {
+  x = _mm_add_epi16(x, _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+static inline __m128i pack_rgb565(__m128i r, __m128i g, __m128i b) {
+  r = _mm_slli_epi16(_mm_and_si128(r, _mm_set1_epi16(0xF8)), 8);
+  g = _mm_slli_epi16(_mm_and_si128(g, _mm_set1_epi16(0xFC)), 3);
+  b = _mm_srli_epi16(b, 3);
+  return _mm_or_si128(r, _mm_or_si128(g, b));
+}
+
+static inline __m128i expand5(__m128i v) {
+  return _mm_or_si128(_mm_slli_epi16(v, 3), _mm_srli_epi16(v, 2));
+}
+
+static inline __m128i expand6(__m128i v) {
+  return _mm_or_si128(_mm_slli_epi16(v, 2), _mm_srli_epi16(v, 4));
+}
+
+// r, g, b, a are 8-bit values in 16-bit lanes, d is packed RGB565
+static inline __m128i blend_rgb565(__m128i d, __m128i r, __m128i g, __m128i b,
+                                   __m128i a) {
+  const __m128i mask5 = _mm_set1_epi16(0x1F);
+  __m128i ia = _mm_sub_epi16(_mm_set1_epi16(255), a);
+  __m128i dr = expand5(_mm_srli_epi16(d, 11));
+  __m128i dg =
+      expand6(_mm_and_si128(_mm_srli_epi16(d, 5), _mm_set1_epi16(0x3F)));
+  __m128i db = expand5(_mm_and_si128(d, mask5));
+  r = div255(_mm_add_epi16(_mm_mullo_epi16(r, a), _mm_mullo_epi16(dr, ia)));
+  g = div255(_mm_add_epi16(_mm_mullo_epi16(g, a), _mm_mullo_epi16(dg, ia)));
+  b = div255(_mm_add_epi16(_mm_mullo_epi16(b, a), _mm_mullo_epi16(db, ia)));
+  return pack_rgb565(r, g, b);
+}
+
+static inline __m128i blend_premultiplied_rgb565(__m128i d, __m128i r,
+                                                 __m128i g, __m128i b,
+                                                 __m128i a) {
+  __m128i ia = _mm_sub_epi16(_mm_set1_epi16(255), a);
+  __m128i dr = expand5(_mm_srli_epi16(d, 11));
+  __m128i dg =
+      expand6(_mm_and_si128(_mm_srli_epi16(d, 5), _mm_set1_epi16(0x3F)));
+  __m128i db = expand5(_mm_and_si128(d, _mm_set1_epi16(0x1F)));
+  r = _mm_add_epi16(r, div255(_mm_mullo_epi16(dr, ia)));
+  g = _mm_add_epi16(g, div255(_mm_mullo_epi16(dg, ia)));
+  b = _mm_add_epi16(b, div255(_mm_mullo_epi16(db, ia)));
+  return pack_rgb565(r, g, b);
+}
+
+// Split 8 ARGB8888 pixels into 16-bit channel lanes
+static inline void unpack_argb8888(const u32 *src, __m128i &a, __m128i &r,
+                                   __m128i &g, __m128i &b) {
+  const __m128i mask = _mm_set1_epi32(0xFF);
+  __m128i s0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+  __m128i s1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 4));
+  a = _mm_packs_epi32(_mm_srli_epi32(s0, 24), _mm_srli_epi32(s1, 24));
+  r = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(s0, 16), mask),
+                      _mm_and_si128(_mm_srli_epi32(s1, 16), mask));
+  g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(s0, 8), mask),
+                      _mm_and_si128(_mm_srli_epi32(s1, 8), mask));
+  b = _mm_packs_epi32(_mm_and_si128(s0, mask), _mm_and_si128(s1, mask));
+}
+
+static void blend_argb8888_rgb565(u16 *dst, const u32 *src, u32 n,
+                                  u8 global_alpha) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i v255 = _mm_set1_epi16(255);
+  const __m128i ga = _mm_set1_epi16(global_alpha);
+  u32 i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i a, r, g, b;
+    unpack_argb8888(src + i, a, r, g, b);
+    if (global_alpha != 0xFF)
+      a = div255(_mm_mullo_epi16(a, ga));
+
+    // fully transparent and fully opaque groups are common in sprites
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(a, zero)) == 0xFFFF)
+      continue;
+    auto dptr = reinterpret_cast<__m128i *>(dst + i);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(a, v255)) == 0xFFFF) {
+      _mm_storeu_si128(dptr, pack_rgb565(r, g, b));
+      continue;
+    }
+    __m128i d = _mm_loadu_si128(dptr);
+    _mm_storeu_si128(dptr, blend_rgb565(d, r, g, b, a));
+  }
+  blend_argb8888_rgb565_scalar(dst + i, src + i, n - i, global_alpha);
+}
+
+static void blend_premultiplied_argb8888_rgb565(u16 *dst, const u32 *src,
+                                               u32 n, u8 global_alpha) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i v255 = _mm_set1_epi16(255);
+  const __m128i ga = _mm_set1_epi16(global_alpha);
+  u32 i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i a, r, g, b;
+    unpack_argb8888(src + i, a, r, g, b);
+    if (global_alpha != 0xFF) {
+      a = div255(_mm_mullo_epi16(a, ga));
+      r = div255(_mm_mullo_epi16(r, ga));
+      g = div255(_mm_mullo_epi16(g, ga));
+      b = div255(_mm_mullo_epi16(b, ga));
+    }
+
+    __m128i any = _mm_or_si128(_mm_or_si128(a, r), _mm_or_si128(g, b));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(any, zero)) == 0xFFFF)
+      continue;
+    auto dptr = reinterpret_cast<__m128i *>(dst + i);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(a, v255)) == 0xFFFF) {
+      _mm_storeu_si128(dptr, pack_rgb565(r, g, b));
+      continue;
+    }
+    __m128i d = _mm_loadu_si128(dptr);
+    _mm_storeu_si128(dptr, blend_premultiplied_rgb565(d, r, g, b, a));
+  }
+  blend_premultiplied_argb8888_rgb565_scalar(dst + i, src + i, n - i,
+                                             global_alpha);
+}
+
+static void blend_a8_rgb565(u16 *dst, const u8 *src, u32 n, u32 color,
+                            u8 global_alpha) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i v255 = _mm_set1_epi16(255);
+  const __m128i ga = _mm_set1_epi16(global_alpha);
+  const __m128i r = _mm_set1_epi16((color >> 16) & 0xFF);
+  const __m128i g = _mm_set1_epi16((color >> 8) & 0xFF);
+  const __m128i b = _mm_set1_epi16(color & 0xFF);
+  const __m128i opaque = pack_rgb565(r, g, b);
+  u32 i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i a = _mm_unpacklo_epi8(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i)), zero);
+    if (global_alpha != 0xFF)
+      a = div255(_mm_mullo_epi16(a, ga));
+
+    // glyphs are mostly empty or fully covered pixels
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(a, zero)) == 0xFFFF)
+      continue;
+    auto dptr = reinterpret_cast<__m128i *>(dst + i);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(a, v255)) == 0xFFFF) {
+      _mm_storeu_si128(dptr, opaque);
+      continue;
+    }
+    __m128i d = _mm_loadu_si128(dptr);
+    _mm_storeu_si128(dptr, blend_rgb565(d, r, g, b, a));
+  }
+  blend_a8_rgb565_scalar(dst + i, src + i, n - i, color, global_alpha);
+}
+
+static void blend_rgb565_rgb565(u16 *dst, const u16 *src, u32 n,
+                                u8 global_alpha) {
+  const __m128i a = _mm_set1_epi16(global_alpha);
+  const __m128i mask5 = _mm_set1_epi16(0x1F);
+  const __m128i mask6 = _mm_set1_epi16(0x3F);
+  u32 i = 0;
+  for (; i + 8 <= n; i += 8) {
+    auto dptr = reinterpret_cast<__m128i *>(dst + i);
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    __m128i r = expand5(_mm_srli_epi16(s, 11));
+    __m128i g = expand6(_mm_and_si128(_mm_srli_epi16(s, 5), mask6));
+    __m128i b = expand5(_mm_and_si128(s, mask5));
+    _mm_storeu_si128(dptr, blend_rgb565(_mm_loadu_si128(dptr), r, g, b, a));
+  }
+  blend_rgb565_rgb565_scalar(dst + i, src + i, n - i, global_alpha);
+}
+
+static inline __m128i argb1555_to_rgb565(__m128i s) {
+  __m128i r = _mm_slli_epi16(_mm_and_si128(s, _mm_set1_epi16(0x7C00)), 1);
+  __m128i rb = _mm_or_si128(r, _mm_and_si128(s, _mm_set1_epi16(0x1F)));
+  __m128i g = _mm_and_si128(_mm_srli_epi16(s, 5), _mm_set1_epi16(0x1F));
+  g = _mm_or_si128(_mm_slli_epi16(g, 1), _mm_srli_epi16(g, 4));
+  return _mm_or_si128(rb, _mm_slli_epi16(g, 5));
+}
+
+static void blend_argb1555_rgb565(u16 *dst, const u16 *src, u32 n,
+                                  u8 global_alpha) {
+  const __m128i mask5 = _mm_set1_epi16(0x1F);
+  const __m128i ga = _mm_set1_epi16(global_alpha);
+  u32 i = 0;
+  for (; i + 8 <= n; i += 8) {
+    auto dptr = reinterpret_cast<__m128i *>(dst + i);
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    // all ones where the pixel is opaque
+    __m128i key = _mm_srai_epi16(s, 15);
+    int keymask = _mm_movemask_epi8(key);
+    if (keymask == 0)
+      continue;
+    if (global_alpha == 0xFF) {
+      __m128i c = argb1555_to_rgb565(s);
+      if (keymask != 0xFFFF)
+        c = _mm_or_si128(_mm_and_si128(key, c),
+                         _mm_andnot_si128(key, _mm_loadu_si128(dptr)));
+      _mm_storeu_si128(dptr, c);
+      continue;
+    }
+    __m128i r = expand5(_mm_and_si128(_mm_srli_epi16(s, 10), mask5));
+    __m128i g = expand5(_mm_and_si128(_mm_srli_epi16(s, 5), mask5));
+    __m128i b = expand5(_mm_and_si128(s, mask5));
+    __m128i a = _mm_and_si128(key, ga);
+    _mm_storeu_si128(dptr, blend_rgb565(_mm_loadu_si128(dptr), r, g, b, a));
+  }
+  blend_argb1555_rgb565_scalar(dst + i, src + i, n - i, global_alpha);
+}
+
+static void convert_argb8888_rgb565(u16 *dst, const u32 *src, u32 n) {
+  u32 i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i a, r, g, b;
+    unpack_argb8888(src + i, a, r, g, b);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                     pack_rgb565(r, g, b));
+  }
+  convert_argb8888_rgb565_scalar(dst + i, src + i, n - i);
+}
+
+static void convert_argb1555_rgb565(u16 *dst, const u16 *src, u32 n) {
+  u32 i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                     argb1555_to_rgb565(s));
+  }
+  convert_argb1555_rgb565_scalar(dst + i, src + i, n - i);
+}
+
+} // namespace sse2
+#endif
+
+// --- Row kernels: AVX2 ---
+// Same as the SSE2 kernels with 16 pixels per iteration. The tails are
+// handed over to the SSE2 kernels.
+
+#ifdef GE_SW_AVX2
+namespace avx2 {
+
+GE_SW_TARGET_AVX2 static inline __m256i div255(__m256i x) {
+  x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+  return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+GE_SW_TARGET_AVX2 static inline __m256i pack_rgb565(__m256i r, __m256i g,
+                                                    __m256i b) {
+  r = _mm256_slli_epi16(_mm256_and_si256(r, _mm256_set1_epi16(0xF8)), 8);
+  g = _mm256_slli_epi16(_mm256_and_si256(g, _mm256_set1_epi16(0xFC)), 3);
+  b = _mm256_srli_epi16(b, 3);
+  return _mm256_or_si256(r, _mm256_or_si256(g, b));
+}
+
+GE_SW_TARGET_AVX2 static inline __m256i expand5(__m256i v) {
+  return _mm256_or_si256(_mm256_slli_epi16(v, 3), _mm256_srli_epi16(v, 2));
+}
+
+GE_SW_TARGET_AVX2 static inline __m256i expand6(__m256i v) {
+  return _mm256_or_si256(_mm256_slli_epi16(v, 2), _mm256_srli_epi16(v, 4));
+}
+
+GE_SW_TARGET_AVX2 static inline __m256i
+blend_rgb565(__m256i d, __m256i r, __m256i g, __m256i b, __m256i a) {
+  __m256i ia = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+  __m256i dr = expand5(_mm256_srli_epi16(d, 11));
+  __m256i dg = expand6(
+      _mm256_and_si256(_mm256_srli_epi16(d, 5), _mm256_set1_epi16(0x3F)));
+  __m256i db = expand5(_mm256_and_si256(d, _mm256_set1_epi16(0x1F)));
+  r = div255(
+      _mm256_add_epi16(_mm256_mullo_epi16(r, a), _mm256_mullo_epi16(dr, ia)));
+  g = div255(
+      _mm256_add_epi16(_mm256_mullo_epi16(g, a), _mm256_mullo_epi16(dg, ia)));
+  b = div255(
+      _mm256_add_epi16(_mm256_mullo_epi16(b, a), _mm256_mullo_epi16(db, ia)));
+  return pack_rgb565(r, g, b);
+}
+
+GE_SW_TARGET_AVX2 static inline __m256i
+blend_premultiplied_rgb565(__m256i d, __m256i r, __m256i g, __m256i b,
+                           __m256i a) {
+  __m256i ia = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+  __m256i dr = expand5(_mm256_srli_epi16(d, 11));
+  __m256i dg = expand6(
+      _mm256_and_si256(_mm256_srli_epi16(d, 5), _mm256_set1_epi16(0x3F)));
+  __m256i db = expand5(_mm256_and_si256(d, _mm256_set1_epi16(0x1F)));
+  r = _mm256_add_epi16(r, div255(_mm256_mullo_epi16(dr, ia)));
+  g = _mm256_add_epi16(g, div255(_mm256_mullo_epi16(dg, ia)));
+  b = _mm256_add_epi16(b, div255(_mm256_mullo_epi16(db, ia)));
+  return pack_rgb565(r, g, b);
+}
+
+// _mm256_packs_epi32 works per 128-bit lane, so the channels come out as
+// pixels 0-3, 8-11, 4-7, 12-15. Swapping the middle quadwords (0xD8) converts
+// between that order and the memory order, in both directions.
+GE_SW_TARGET_AVX2 static inline __m256i swap_quads(__m256i v) {
+  return _mm256_permute4x64_epi64(v, 0xD8);
+}
+
+GE_SW_TARGET_AVX2 static inline void unpack_argb8888(const u32 *src,
+                                                     __m256i &a, __m256i &r,
+                                                     __m256i &g, __m256i &b) {
+  const __m256i mask = _mm256_set1_epi32(0xFF);
+  __m256i s0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+  __m256i s1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 8));
+  a = _mm256_packs_epi32(_mm256_srli_epi32(s0, 24), _mm256_srli_epi32(s1, 24));
+  r = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(s0, 16), mask),
+                         _mm256_and_si256(_mm256_srli_epi32(s1, 16), mask));
+  g = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(s0, 8), mask),
+                         _mm256_and_si256(_mm256_srli_epi32(s1, 8), mask));
+  b = _mm256_packs_epi32(_mm256_and_si256(s0, mask),
+                         _mm256_and_si256(s1, mask));
+}
+
+GE_SW_TARGET_AVX2 static void blend_argb8888_rgb565(u16 *dst, const u32 *src,
+                                                    u32 n, u8 global_alpha) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i v255 = _mm256_set1_epi16(255);
+  const __m256i ga = _mm256_set1_epi16(global_alpha);
+  u32 i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256i a, r, g, b;
+    unpack_argb8888(src + i, a, r, g, b);
+    if (global_alpha != 0xFF)
+      a = div255(_mm256_mullo_epi16(a, ga));
+
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(a, zero)) == -1)
+      continue;
+    auto dptr = reinterpret_cast<__m256i *>(dst + i);
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(a, v255)) == -1) {
+      _mm256_storeu_si256(dptr, swap_quads(pack_rgb565(r, g, b)));
+      continue;
+    }
+    __m256i d = swap_quads(_mm256_loadu_si256(dptr));
+    _mm256_storeu_si256(dptr, swap_quads(blend_rgb565(d, r, g, b, a)));
+  }
+  sse2::blend_argb8888_rgb565(dst + i, src + i, n - i, global_alpha);
+}
+
+GE_SW_TARGET_AVX2 static void
+blend_premultiplied_argb8888_rgb565(u16 *dst, const u32 *src, u32 n,
+                                    u8 global_alpha) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i v255 = _mm256_set1_epi16(255);
+  const __m256i ga = _mm256_set1_epi16(global_alpha);
+  u32 i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256i a, r, g, b;
+    unpack_argb8888(src + i, a, r, g, b);
+    if (global_alpha != 0xFF) {
+      a = div255(_mm256_mullo_epi16(a, ga));
+      r = div255(_mm256_mullo_epi16(r, ga));
+      g = div255(_mm256_mullo_epi16(g, ga));
+      b = div255(_mm256_mullo_epi16(b, ga));
+    }
+
+    __m256i any = _mm256_or_si256(_mm256_or_si256(a, r), _mm256_or_si256(g, b));
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(any, zero)) == -1)
+      continue;
+    auto dptr = reinterpret_cast<__m256i *>(dst + i);
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(a, v255)) == -1) {
+      _mm256_storeu_si256(dptr, swap_quads(pack_rgb565(r, g, b)));
+      continue;
+    }
+    __m256i d = swap_quads(_mm256_loadu_si256(dptr));
+    _mm256_storeu_si256(dptr,
+                        swap_quads(blend_premultiplied_rgb565(d, r, g, b, a)));
+  }
+  sse2::blend_premultiplied_argb8888_rgb565(dst + i, src + i, n - i,
+                                            global_alpha);
+}
+
+// _mm256_cvtepu8_epi16 widens across the lanes, so unlike the ARGB8888
+// kernels the pixels stay in memory order
+GE_SW_TARGET_AVX2 static void blend_a8_rgb565(u16 *dst, const u8 *src, u32 n,
+                                              u32 color, u8 global_alpha) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i v255 = _mm256_set1_epi16(255);
+  const __m256i ga = _mm256_set1_epi16(global_alpha);
+  const __m256i r = _mm256_set1_epi16((color >> 16) & 0xFF);
+  const __m256i g = _mm256_set1_epi16((color >> 8) & 0xFF);
+  const __m256i b = _mm256_set1_epi16(color & 0xFF);
+  const __m256i opaque = pack_rgb565(r, g, b);
+  u32 i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256i a = _mm256_cvtepu8_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)));
+    if (global_alpha != 0xFF)
+      a = div255(_mm256_mullo_epi16(a, ga));
+
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(a, zero)) == -1)
+      continue;
+    auto dptr = reinterpret_cast<__m256i *>(dst + i);
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(a, v255)) == -1) {
+      _mm256_storeu_si256(dptr, opaque);
+      continue;
+    }
+    _mm256_storeu_si256(dptr,
+                        blend_rgb565(_mm256_loadu_si256(dptr), r, g, b, a));
+  }
+  sse2::blend_a8_rgb565(dst + i, src + i, n - i, color, global_alpha);
+}
+
+GE_SW_TARGET_AVX2 static void blend_rgb565_rgb565(u16 *dst, const u16 *src,
+                                                  u32 n, u8 global_alpha) {
+  const __m256i a = _mm256_set1_epi16(global_alpha);
+  const __m256i mask5 = _mm256_set1_epi16(0x1F);
+  const __m256i mask6 = _mm256_set1_epi16(0x3F);
+  u32 i = 0;
+  for (; i + 16 <= n; i += 16) {
+    auto dptr = reinterpret_cast<__m256i *>(dst + i);
+    __m256i s =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    __m256i r = expand5(_mm256_srli_epi16(s, 11));
+    __m256i g = expand6(_mm256_and_si256(_mm256_srli_epi16(s, 5), mask6));
+    __m256i b = expand5(_mm256_and_si256(s, mask5));
+    _mm256_storeu_si256(dptr,
+                        blend_rgb565(_mm256_loadu_si256(dptr), r, g, b, a));
+  }
+  sse2::blend_rgb565_rgb565(dst + i, src + i, n - i, global_alpha);
+}
+
+GE_SW_TARGET_AVX2 static void blend_argb1555_rgb565(u16 *dst, const u16 *src,
+                                                    u32 n, u8 global_alpha) {
+  const __m256i mask5 = _mm256_set1_epi16(0x1F);
+  const __m256i ga = _mm256_set1_epi16(global_alpha);
+  u32 i = 0;
+  for (; i + 16 <= n; i += 16) {
+    auto dptr = reinterpret_cast<__m256i *>(dst + i);
+    __m256i s =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    __m256i key = _mm256_srai_epi16(s, 15);
+    int keymask = _mm256_movemask_epi8(key);
+    if (keymask == 0)
+      continue;
+    __m256i r = expand5(_mm256_and_si256(_mm256_srli_epi16(s, 10), mask5));
+    __m256i g = expand5(_mm256_and_si256(_mm256_srli_epi16(s, 5), mask5));
+    __m256i b = expand5(_mm256_and_si256(s, mask5));
+    if (global_alpha == 0xFF) {
+      __m256i c = pack_rgb565(r, g, b);
+      if (keymask != -1)
+        c = _mm256_blendv_epi8(_mm256_loadu_si256(dptr), c, key);
+      _mm256_storeu_si256(dptr, c);
+      continue;
+    }
+    __m256i a = _mm256_and_si256(key, ga);
+    _mm256_storeu_si256(dptr,
+                        blend_rgb565(_mm256_loadu_si256(dptr), r, g, b, a));
+  }
+  sse2::blend_argb1555_rgb565(dst + i, src + i, n - i, global_alpha);
+}
+
+} // namespace avx2
+
+static bool cpu_has_avx2() {
+  static const bool supported = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+  }();
+  return supported;
+}
+#endif
+
+// --- Kernel selection ---
+
+using BlendArgb8888Fn = void (*)(u16 *, const u32 *, u32, u8);
+using Blend16Fn = void (*)(u16 *, const u16 *, u32, u8);
+using BlendA8Fn = void (*)(u16 *, const u8 *, u32, u32, u8);
+using ConvertArgb8888Fn = void (*)(u16 *, const u32 *, u32);
+using Convert16Fn = void (*)(u16 *, const u16 *, u32);
+
+static BlendArgb8888Fn select_blend_argb8888_rgb565() {
+#if defined(GE_SW_AVX2)
+  if (cpu_has_avx2())
+    return avx2::blend_argb8888_rgb565;
+#endif
+#if defined(GE_SW_SSE2)
+  return sse2::blend_argb8888_rgb565;
+#else
+  return blend_argb8888_rgb565_scalar;
+#endif
+}
+
+static BlendArgb8888Fn select_blend_premultiplied_argb8888_rgb565() {
+#if defined(GE_SW_AVX2)
+  if (cpu_has_avx2())
+    return avx2::blend_premultiplied_argb8888_rgb565;
+#endif
+#if defined(GE_SW_SSE2)
+  return sse2::blend_premultiplied_argb8888_rgb565;
+#else
+  return blend_premultiplied_argb8888_rgb565_scalar;
+#endif
+}
+
+static BlendA8Fn select_blend_a8_rgb565() {
+#if defined(GE_SW_AVX2)
+  if (cpu_has_avx2())
+    return avx2::blend_a8_rgb565;
+#endif
+#if defined(GE_SW_SSE2)
+  return sse2::blend_a8_rgb565;
+#else
+  return blend_a8_rgb565_scalar;
+#endif
+}
+
+static Blend16Fn select_blend_rgb565_rgb565() {
+#if defined(GE_SW_AVX2)
+  if (cpu_has_avx2())
+    return avx2::blend_rgb565_rgb565;
+#endif
+#if defined(GE_SW_SSE2)
+  return sse2::blend_rgb565_rgb565;
+#else
+  return blend_rgb565_rgb565_scalar;
+#endif
+}
+
+static Blend16Fn select_blend_argb1555_rgb565() {
+#if defined(GE_SW_AVX2)
+  if (cpu_has_avx2())
+    return avx2::blend_argb1555_rgb565;
+#endif
+#if defined(GE_SW_SSE2)
+  return sse2::blend_argb1555_rgb565;
+#else
+  return blend_argb1555_rgb565_scalar;
+#endif
+}
+
+static ConvertArgb8888Fn select_convert_argb8888_rgb565() {
+#if defined(GE_SW_SSE2)
+  return sse2::convert_argb8888_rgb565;
+#else
+  return convert_argb8888_rgb565_scalar;
+#endif
+}
+
+static Convert16Fn select_convert_argb1555_rgb565() {
+#if defined(GE_SW_SSE2)
+  return sse2::convert_argb1555_rgb565;
+#else
+  return convert_argb1555_rgb565_scalar;
+#endif
+}
+
+// --- Generic paths ---
+// Any pixel format is converted to and from ARGB8888 rows, following the
+// DMA2D PFC rules.
+
+template <class T> static inline T *row_ptr(T *base, u32 y, u32 stride,
+                                            u32 bpp) {
+  using ByteT = std::conditional_t<std::is_const<T>::value, const u8, u8>;
+  return reinterpret_cast<T *>(reinterpret_cast<ByteT *>(base) +
+                               usize(y) * stride * bpp / 8);
+}
+
+static inline u32 lookup(u32 index) { return clut[index & 0xFF]; }
+
+// Convert n pixels of a row in format fmt to ARGB8888. For 4bpp formats,
+// phase is the nibble index of the first pixel.
+static void load_row(PixelFormat fmt, const u8 *row, u32 phase, u32 n,
+                     u32 *out) {
+  switch (fmt) {
+  case PixelFormat::ARGB8888:
+    std::memcpy(out, row, n * 4);
+    break;
+  case PixelFormat::RGB888:
+    for (u32 i = 0; i < n; ++i, row += 3)
+      out[i] = 0xFF000000u | (row[2] << 16) | (row[1] << 8) | row[0];
+    break;
+  case PixelFormat::RGB565:
+    for (u32 i = 0; i < n; ++i) {
+      u16 c = reinterpret_cast<const u16 *>(row)[i];
+      out[i] = 0xFF000000u | (expand5(c >> 11) << 16) |
+               (expand6((c >> 5) & 0x3F) << 8) | expand5(c & 0x1F);
+    }
+    break;
+  case PixelFormat::ARGB1555:
+    for (u32 i = 0; i < n; ++i) {
+      u16 c = reinterpret_cast<const u16 *>(row)[i];
+      out[i] = ((c & 0x8000) ? 0xFF000000u : 0) |
+               (expand5((c >> 10) & 0x1F) << 16) |
+               (expand5((c >> 5) & 0x1F) << 8) | expand5(c & 0x1F);
+    }
+    break;
+  case PixelFormat::ARGB4444:
+    for (u32 i = 0; i < n; ++i) {
+      u16 c = reinterpret_cast<const u16 *>(row)[i];
+      out[i] = (expand4(c >> 12) << 24) | (expand4((c >> 8) & 0xF) << 16) |
+               (expand4((c >> 4) & 0xF) << 8) | expand4(c & 0xF);
+    }
+    break;
+  case PixelFormat::L8:
+    for (u32 i = 0; i < n; ++i)
+      out[i] = lookup(row[i]);
+    break;
+  case PixelFormat::AL44:
+    for (u32 i = 0; i < n; ++i)
+      out[i] = (expand4(row[i] >> 4) << 24) |
+               (lookup(row[i] & 0xF) & 0x00FFFFFF);
+    break;
+  case PixelFormat::AL88:
+    for (u32 i = 0; i < n; ++i) {
+      u16 c = reinterpret_cast<const u16 *>(row)[i];
+      out[i] = (u32(c >> 8) << 24) | (lookup(c & 0xFF) & 0x00FFFFFF);
+    }
+    break;
+  case PixelFormat::A8:
+    for (u32 i = 0; i < n; ++i)
+      out[i] = u32(row[i]) << 24;
+    break;
+  case PixelFormat::L4:
+  case PixelFormat::A4:
+    for (u32 i = 0; i < n; ++i) {
+      u32 nibble = phase + i;
+      u32 v = row[nibble >> 1];
+      v = (nibble & 1) ? (v >> 4) : (v & 0xF);
+      out[i] = (fmt == PixelFormat::L4) ? lookup(v) : (expand4(v) << 24);
+    }
+    break;
+  }
+}
+
+static inline u32 pack_pixel(PixelFormat fmt, u32 c) {
+  u32 a = c >> 24, r = (c >> 16) & 0xFF, g = (c >> 8) & 0xFF, b = c & 0xFF;
+  switch (fmt) {
+  case PixelFormat::RGB565:
+    return pack_rgb565(r, g, b);
+  case PixelFormat::ARGB1555:
+    return ((a & 0x80) << 8) | ((r >> 3) << 10) | ((g >> 3) << 5) | (b >> 3);
+  case PixelFormat::ARGB4444:
+    return ((a >> 4) << 12) | ((r >> 4) << 8) | ((g >> 4) << 4) | (b >> 4);
+  default:
+    return c;
+  }
+}
+
+// Store n ARGB8888 pixels into a row of format fmt. Only the DMA2D output
+// formats are supported.
+static void store_row(PixelFormat fmt, u8 *row, u32 n, const u32 *in) {
+  switch (fmt) {
+  case PixelFormat::ARGB8888:
+    std::memcpy(row, in, n * 4);
+    break;
+  case PixelFormat::RGB888:
+    for (u32 i = 0; i < n; ++i, row += 3) {
+      row[0] = in[i] & 0xFF;
+      row[1] = (in[i] >> 8) & 0xFF;
+      row[2] = (in[i] >> 16) & 0xFF;
+    }
+    break;
+  case PixelFormat::RGB565:
+  case PixelFormat::ARGB1555:
+  case PixelFormat::ARGB4444:
+    for (u32 i = 0; i < n; ++i)
+      reinterpret_cast<u16 *>(row)[i] = pack_pixel(fmt, in[i]);
+    break;
+  default:
+    assert(false && "unsupported DMA2D output format");
+    break;
+  }
+}
+
+// DMA2D blending equations with the foreground alpha already multiplied by
+// the global alpha.
+static u32 blend_pixel(u32 fg, u32 bg, u32 fg_a) {
+  u32 bg_a = bg >> 24;
+  u32 mult = div255(fg_a * bg_a);
+  u32 out_a = fg_a + bg_a - mult;
+  if (out_a == 0)
+    return 0;
+  u32 out = out_a << 24;
+  for (u32 shift = 0; shift < 24; shift += 8) {
+    u32 cf = (fg >> shift) & 0xFF, cb = (bg >> shift) & 0xFF;
+    u32 num = cf * fg_a + cb * bg_a - cb * mult;
+    out |= (out_a == 0xFF ? div255(num) : num / out_a) << shift;
+  }
+  return out;
+}
+
+// The same for a premultiplied fg: fg times the global alpha, plus bg times
+// one minus that alpha, alpha included
+static u32 blend_premultiplied_pixel(u32 fg, u32 bg, u8 global_alpha) {
+  u32 ia = 255 - div255((fg >> 24) * global_alpha);
+  u32 out = 0;
+  for (u32 shift = 0; shift < 32; shift += 8) {
+    u32 cf = div255(((fg >> shift) & 0xFF) * global_alpha);
+    out |= (cf + div255(((bg >> shift) & 0xFF) * ia)) << shift;
+  }
+  return out;
+}
+
+enum class RowOp : u8 { Copy, Blend, BlendPremultiplied };
+
+// Blend n ARGB8888 pixels onto a row of format fmt
+static void blend_row(PixelFormat fmt, u8 *row, u32 n, const u32 *in,
+                      u8 global_alpha, bool premultiplied) {
+  if (fmt == PixelFormat::RGB565) {
+    auto kernel = premultiplied ? select_blend_premultiplied_argb8888_rgb565()
+                                : select_blend_argb8888_rgb565();
+    kernel(reinterpret_cast<u16 *>(row), in, n, global_alpha);
+    return;
+  }
+
+  u32 bg[CHUNK], fg[CHUNK];
+  for (u32 done = 0; done < n; done += CHUNK) {
+    u32 count = std::min(CHUNK, n - done);
+    u8 *ptr = row + done * pixel_format_bpp(fmt) / 8;
+    load_row(fmt, ptr, 0, count, bg);
+    for (u32 i = 0; i < count; ++i) {
+      if (premultiplied) {
+        fg[i] = blend_premultiplied_pixel(in[done + i], bg[i], global_alpha);
+        continue;
+      }
+      u32 a = div255((in[done + i] >> 24) * global_alpha);
+      fg[i] = blend_pixel(in[done + i], bg[i], a);
+    }
+    store_row(fmt, ptr, count, fg);
+  }
+}
+
+// A8/A4 sources take their RGB from fg_color, like from FGCOLR on the DMA2D
+static void generic_blit(Surface dst, ConstSurface src, RowOp op,
+                         u8 global_alpha, u32 fg_color = 0) {
+  PixelFormat dst_fmt = dst.get_pixel_format();
+  PixelFormat src_fmt = src.get_pixel_format();
+  u32 dst_bpp = pixel_format_bpp(dst_fmt);
+  u32 src_bpp = pixel_format_bpp(src_fmt);
+  bool alpha_only = src_fmt == PixelFormat::A8 || src_fmt == PixelFormat::A4;
+  u32 w = dst.get_width();
+  u32 tmp[CHUNK];
+  for (u32 y = 0; y < dst.get_height(); ++y) {
+    auto src_row = row_ptr(static_cast<const u8 *>(src.data()), y,
+                           src.get_stride(), src_bpp);
+    auto dst_row =
+        row_ptr(static_cast<u8 *>(dst.data()), y, dst.get_stride(), dst_bpp);
+    // 4bpp rows may start in the middle of a byte
+    u32 phase = src_bpp == 4 ? (y * src.get_stride()) & 1 : 0;
+    for (u32 x = 0; x < w; x += CHUNK) {
+      u32 count = std::min(CHUNK, w - x);
+      load_row(src_fmt, src_row + (phase + x) * src_bpp / 8, (phase + x) & 1,
+               count, tmp);
+      if (alpha_only)
+        for (u32 i = 0; i < count; ++i)
+          tmp[i] |= fg_color & 0x00FFFFFF;
+      u8 *out = dst_row + x * dst_bpp / 8;
+      if (op == RowOp::Copy)
+        store_row(dst_fmt, out, count, tmp);
+      else
+        blend_row(dst_fmt, out, count, tmp, global_alpha,
+                  op == RowOp::BlendPremultiplied);
+    }
+  }
+}
+
+// --- Region Normalization ---
+// Identical logic to the STM32 driver
+static void normalize_regions(Surface &dst, ConstSurface &src) {
+  u32 width = std::min(src.get_width(), dst.get_width());
+  u32 height = std::min(src.get_height(), dst.get_height());
+  src = src.subsurface(0, 0, width, height);
+  dst = dst.subsurface(0, 0, width, height);
+}
+
+// Rows of both surfaces are back to back, so the region can be processed as
+// one long row
+static bool is_contiguous(const Surface &dst, const ConstSurface &src) {
+  return dst.get_stride() == dst.get_width() &&
+         src.get_stride() == src.get_width();
+}
+
+// Row pitches in bytes, so that DstT/SrcT don't have to match the pixel size
+static inline usize pitch_of(const ConstSurface &s) {
+  return usize(s.get_stride()) * pixel_format_bpp(s.get_pixel_format()) / 8;
+}
+
+template <class DstT, class SrcT, class Fn, class... Args>
+static void for_each_row(Surface dst, ConstSurface src, Fn fn, Args... args) {
+  auto d = static_cast<u8 *>(dst.data());
+  auto s = static_cast<const u8 *>(src.data());
+  u32 w = dst.get_width(), h = dst.get_height();
+  if (is_contiguous(dst, src)) {
+    fn(reinterpret_cast<DstT *>(d), reinterpret_cast<const SrcT *>(s), w * h,
+       args...);
+    return;
+  }
+  usize dst_pitch = pitch_of(dst.as_const()), src_pitch = pitch_of(src);
+  for (u32 y = 0; y < h; ++y, d += dst_pitch, s += src_pitch)
+    fn(reinterpret_cast<DstT *>(d), reinterpret_cast<const SrcT *>(s), w,
+       args...);
+}
+
+template <class T> static void fill_rows(Surface dst, T color) {
+  auto d = static_cast<T *>(dst.data());
+  u32 w = dst.get_width(), h = dst.get_height();
+  if (dst.get_stride() == w) {
+    std::fill_n(d, usize(w) * h, color);
+    return;
+  }
+  for (u32 y = 0; y < h; ++y, d += dst.get_stride())
+    std::fill_n(d, w, color);
+}
+
+// 4bpp rows may start in the middle of a byte, and so may the whole surface
+// when its stride is odd, so this walks nibble indices
+static void expand_l4_rgb565(Surface dst, ConstSurface src) {
+  auto s = static_cast<const u8 *>(src.data());
+  for (u32 y = 0; y < dst.get_height(); ++y) {
+    auto d = row_ptr(static_cast<u16 *>(dst.data()), y, dst.get_stride(), 16);
+    usize nibble = usize(y) * src.get_stride();
+    for (u32 x = 0; x < dst.get_width(); ++x, ++nibble) {
+      u32 v = s[nibble >> 1];
+      d[x] = clut_rgb565[(nibble & 1) ? (v >> 4) : (v & 0xF)];
+    }
+  }
+}
+
+void fill(Surface dst, u32 color) {
+  if (dst.get_width() == 0 || dst.get_height() == 0)
+    return;
+
+  switch (pixel_format_bpp(dst.get_pixel_format())) {
+  case 32:
+    fill_rows<u32>(dst, color);
+    break;
+  case 16:
+    fill_rows<u16>(dst, color);
+    break;
+  case 8:
+    fill_rows<u8>(dst, color);
+    break;
+  case 24: {
+    u8 bytes[3] = {u8(color), u8(color >> 8), u8(color >> 16)};
+    for (u32 y = 0; y < dst.get_height(); ++y) {
+      auto row =
+          row_ptr(static_cast<u8 *>(dst.data()), y, dst.get_stride(), 24);
+      for (u32 x = 0; x < dst.get_width(); ++x)
+        std::memcpy(row + x * 3, bytes, 3);
+    }
+    break;
+  }
+  default:
+    assert(false && "unsupported DMA2D output format");
+    break;
+  }
+}
+
+// Copy with pixel format conversion, alpha is ignored (DMA2D M2M / M2M_PFC)
+void blit(Surface dst, ConstSurface src) {
+  normalize_regions(dst, src);
+  if (dst.get_width() == 0 || dst.get_height() == 0)
+    return;
+
+  PixelFormat dst_fmt = dst.get_pixel_format();
+  PixelFormat src_fmt = src.get_pixel_format();
+  u32 bpp = pixel_format_bpp(dst_fmt);
+
+  if (src_fmt == dst_fmt && bpp >= 8) {
+    for_each_row<u8, u8>(
+        dst, src, [bpp](u8 *d, const u8 *s, u32 n) {
+          std::memcpy(d, s, n * bpp / 8);
+        });
+    return;
+  }
+
+  if (dst_fmt == PixelFormat::RGB565) {
+    switch (src_fmt) {
+    case PixelFormat::ARGB8888:
+      for_each_row<u16, u32>(dst, src, select_convert_argb8888_rgb565());
+      return;
+    case PixelFormat::ARGB1555:
+      for_each_row<u16, u16>(dst, src, select_convert_argb1555_rgb565());
+      return;
+    case PixelFormat::L8:
+      for_each_row<u16, u8>(dst, src, [](u16 *d, const u8 *s, u32 n) {
+        for (u32 i = 0; i < n; ++i)
+          d[i] = clut_rgb565[s[i]];
+      });
+      return;
+    case PixelFormat::L4:
+      expand_l4_rgb565(dst, src);
+      return;
+    default:
+      break;
+    }
+  }
+
+  generic_blit(dst, src, RowOp::Copy, 0xFF);
+}
+
+// Alpha blend src over dst (DMA2D M2M_BLEND, foreground alpha multiplied by
+// global_alpha)
+void blit_blend(Surface dst, ConstSurface src, u8 global_alpha) {
+  normalize_regions(dst, src);
+  if (dst.get_width() == 0 || dst.get_height() == 0 || global_alpha == 0)
+    return;
+
+  PixelFormat src_fmt = src.get_pixel_format();
+  if (dst.get_pixel_format() == PixelFormat::RGB565) {
+    switch (src_fmt) {
+    case PixelFormat::ARGB8888:
+      for_each_row<u16, u32>(dst, src, select_blend_argb8888_rgb565(),
+                             global_alpha);
+      return;
+    case PixelFormat::RGB565:
+      if (global_alpha == 0xFF)
+        break; // plain copy
+      for_each_row<u16, u16>(dst, src, select_blend_rgb565_rgb565(),
+                             global_alpha);
+      return;
+    case PixelFormat::ARGB1555:
+      for_each_row<u16, u16>(dst, src, select_blend_argb1555_rgb565(),
+                             global_alpha);
+      return;
+    case PixelFormat::L8: {
+      auto kernel = select_blend_argb8888_rgb565();
+      for_each_row<u16, u8>(dst, src, [kernel](u16 *d, const u8 *s, u32 n,
+                                               u8 ga) {
+        u32 tmp[CHUNK];
+        for (u32 x = 0; x < n; x += CHUNK) {
+          u32 count = std::min(CHUNK, n - x);
+          for (u32 i = 0; i < count; ++i)
+            tmp[i] = clut[s[x + i]];
+          kernel(d + x, tmp, count, ga);
+        }
+      }, global_alpha);
+      return;
+    }
+    default:
+      break;
+    }
+  }
+
+  // opaque sources don't need the background at all
+  bool indexed = src_fmt == PixelFormat::L8 || src_fmt == PixelFormat::L4;
+  if ((indexed ? clut_opaque : !has_alpha_channel(src_fmt)) &&
+      global_alpha == 0xFF) {
+    blit(dst, src);
+    return;
+  }
+
+  generic_blit(dst, src, RowOp::Blend, global_alpha);
+}
+
+// src colors are premultiplied by their alpha: dst = src * global_alpha +
+// dst * (1 - src alpha * global_alpha)
+void blit_blend_premultiplied(Surface dst, ConstSurface src,
+                              u8 global_alpha) {
+  normalize_regions(dst, src);
+  if (dst.get_width() == 0 || dst.get_height() == 0 || global_alpha == 0)
+    return;
+
+  if (dst.get_pixel_format() == PixelFormat::RGB565 &&
+      src.get_pixel_format() == PixelFormat::ARGB8888) {
+    for_each_row<u16, u32>(dst, src,
+                           select_blend_premultiplied_argb8888_rgb565(),
+                           global_alpha);
+    return;
+  }
+
+  generic_blit(dst, src, RowOp::BlendPremultiplied, global_alpha);
+}
+
+void blit_blend_alpha(Surface dst, ConstSurface src, u32 color,
+                      u8 global_alpha) {
+  normalize_regions(dst, src);
+  if (dst.get_width() == 0 || dst.get_height() == 0 || global_alpha == 0)
+    return;
+
+  if (dst.get_pixel_format() == PixelFormat::RGB565) {
+    auto kernel = select_blend_a8_rgb565();
+    switch (src.get_pixel_format()) {
+    case PixelFormat::A8:
+      for_each_row<u16, u8>(dst, src, kernel, color, global_alpha);
+      return;
+    case PixelFormat::A4: {
+      // expanded to A8 a chunk at a time, rows start on a byte
+      auto s = static_cast<const u8 *>(src.data());
+      for (u32 y = 0; y < dst.get_height(); ++y) {
+        auto d =
+            row_ptr(static_cast<u16 *>(dst.data()), y, dst.get_stride(), 16);
+        usize nibble = usize(y) * src.get_stride();
+        u8 tmp[CHUNK];
+        for (u32 x = 0; x < dst.get_width(); x += CHUNK) {
+          u32 count = std::min(CHUNK, dst.get_width() - x);
+          for (u32 i = 0; i < count; ++i, ++nibble) {
+            u32 v = s[nibble >> 1];
+            tmp[i] = expand4((nibble & 1) ? (v >> 4) : (v & 0xF));
+          }
+          kernel(d + x, tmp, count, color, global_alpha);
+        }
+      }
+      return;
+    }
+    default:
+      break;
+    }
+  }
+
+  generic_blit(dst, src, RowOp::Blend, global_alpha, color);
+}
+
+void load_palette(const u32 *colors, usize num_colors) {
+  num_colors = std::min<usize>(num_colors, GE_ARRAY_SIZE(clut));
+  std::copy_n(colors, num_colors, clut);
+  clut_opaque = true;
+  for (usize i = 0; i < num_colors; ++i) {
+    clut_rgb565[i] = argb8888_to_rgb565(colors[i]);
+    clut_opaque &= (colors[i] >> 24) == 0xFF;
+  }
+}
+
+// CLUT lookups are part of the PFC
+void blit_indexed(Surface dst, ConstSurface src) { blit(dst, src); }
+
+} // namespace sw
+} // namespace hal
+} // namespace ge
@@ -0,0 +1,68 @@
+#include "ge-hal/sw/compose.hpp"
+#include "ge-hal/typed_surface.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace ge {
+namespace hal {
+namespace sw {
+
+namespace {
+
+// One row of the screen, as the LTDC blends it
+std::vector<pixel::Rgba> row;
+
+template <PixelFormat format>
+void blend_row(pixel::Rgba *out, const pixel::type_t<format> *in, u32 n,
+               u32 alpha) {
+  for (u32 x = 0; x < n; ++x) {
+    auto c = pixel::Traits<format>::unpack(in[x]);
+    // BF1 = pixel alpha x constant alpha, BF2 = 1 - BF1
+    u32 a = pixel::div255(c.a * alpha);
+    if (a == 0)
+      continue;
+    u32 ia = 255 - a;
+    auto &d = out[x];
+    d = {pixel::div255(c.r * a + d.r * ia), pixel::div255(c.g * a + d.g * ia),
+         pixel::div255(c.b * a + d.b * ia), 0xFF};
+  }
+}
+
+} // namespace
+
+void compose(Surface dst, const ComposeLayer *layers, u32 num_layers) {
+  const u32 width = dst.get_width();
+  row.resize(width);
+
+  for (u32 y = dst.get_row_begin(); y < dst.get_row_end(); ++y) {
+    // the background color, black
+    std::fill(row.begin(), row.end(), pixel::Rgba{0, 0, 0, 0xFF});
+    for (u32 i = 0; i < num_layers; ++i) {
+      const auto &layer = layers[i];
+      if (y >= layer.pixels.get_height() || layer.alpha == 0)
+        continue;
+      bool blended = visit(layer.pixels, [&](auto src) {
+        constexpr auto format = decltype(src)::format;
+        blend_row<format>(row.data(), src.row(y).begin(),
+                          std::min(width, src.get_width()), layer.alpha);
+      });
+      if (!blended) {
+        std::printf("Unsupported layer pixel format %d\r\n",
+                    static_cast<int>(layer.pixels.get_pixel_format()));
+        return;
+      }
+    }
+
+    visit(dst, [&](auto out) {
+      using traits = typename decltype(out)::traits;
+      auto out_row = out.row(y);
+      for (u32 x = 0; x < width; ++x)
+        out_row[x] = traits::pack(row[x]);
+    });
+  }
+}
+
+} // namespace sw
+} // namespace hal
+} // namespace ge
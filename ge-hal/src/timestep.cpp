@@ -0,0 +1,74 @@
+#include "ge-hal/timestep.hpp"
+
+namespace ge {
+namespace hal {
+namespace timestep {
+
+namespace {
+
+bool started = false;
+i64 start_time = 0;
+// clock time minus simulation time, grows with the dropped time
+i64 offset = 0;
+u64 ticks = 0;
+u32 pending = 0;
+// simulation time of the clock at the last advance()
+i64 target = 0;
+
+// integer ms from the start, so that the ticks don't drift
+i64 tick_time(u64 n) {
+  return start_time + static_cast<i64>(n * 1000 / TICK_RATE);
+}
+
+} // namespace
+
+void reset(i64 time) {
+  started = false;
+  start_time = time;
+  ticks = 0;
+  pending = 0;
+  target = time;
+}
+
+void advance(i64 clock, u32 max_ticks) {
+  if (!started) {
+    started = true;
+    offset = clock - start_time;
+  }
+
+  // tick n + 1 runs as soon as the clock is past tick n
+  target = clock - offset;
+  pending = 0;
+  while (pending < max_ticks && tick_time(ticks + pending) < target)
+    ++pending;
+
+  i64 last = tick_time(ticks + pending);
+  if (last < target) {
+    offset += target - last;
+    target = last;
+  }
+}
+
+bool next_tick() {
+  if (pending == 0)
+    return false;
+  --pending;
+  ++ticks;
+  return true;
+}
+
+i64 now() { return tick_time(ticks); }
+
+u64 tick_count() { return ticks; }
+
+float alpha() {
+  if (ticks == 0)
+    return 1.0f;
+  i64 prev = tick_time(ticks - 1), cur = tick_time(ticks);
+  float a = static_cast<float>(target - prev) / static_cast<float>(cur - prev);
+  return a < 0.0f ? 0.0f : a > 1.0f ? 1.0f : a;
+}
+
+} // namespace timestep
+} // namespace hal
+} // namespace ge
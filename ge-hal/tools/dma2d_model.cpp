@@ -0,0 +1,296 @@
+// Runs the STM32 DMA2D driver against the host-side register model
+// (ge-hal/stm/dma2d_model.hpp) and checks its output against the software
+// backend. Also reports how much of the DMA2D time the asynchronous queue
+// hides behind CPU work, compared to waiting after every transfer.
+
+#include "ge-hal/stm/dma2d.hpp"
+#include "ge-hal/sw/blit.hpp"
+#include "gpu_backend.hpp"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace ge;
+namespace model = hal::stm::model;
+
+namespace {
+
+constexpr u32 WIDTH = 240, HEIGHT = 320;
+constexpr int FRAMES = 4;
+
+struct Assets {
+  std::vector<u16> tile, sprite1555;
+  std::vector<u32> sprite, premultiplied;
+  std::vector<u8> indexed, coverage8, coverage4;
+  u32 palette_a[256], palette_b[256];
+
+  ConstSurface tile_surface() const {
+    return {tile.data(), 64, 64, 32, PixelFormat::RGB565};
+  }
+  ConstSurface sprite_surface() const {
+    return {sprite.data(), 48, 48, 48, PixelFormat::ARGB8888};
+  }
+  ConstSurface premultiplied_surface() const {
+    return {premultiplied.data(), 48, 48, 48, PixelFormat::ARGB8888};
+  }
+  ConstSurface sprite1555_surface() const {
+    return {sprite1555.data(), 32, 32, 32, PixelFormat::ARGB1555};
+  }
+  ConstSurface indexed_surface() const {
+    return {indexed.data(), 40, 40, 40, PixelFormat::L8};
+  }
+  ConstSurface coverage8_surface() const {
+    return {coverage8.data(), 16, 16, 24, PixelFormat::A8};
+  }
+  ConstSurface coverage4_surface() const {
+    return {coverage4.data(), 16, 16, 24, PixelFormat::A4};
+  }
+};
+
+u32 next_random(u32 &state) {
+  state = state * 1664525u + 1013904223u;
+  return state >> 8;
+}
+
+Assets make_assets() {
+  Assets a;
+  u32 seed = 12345;
+  a.tile.resize(64 * 32);
+  for (auto &px : a.tile)
+    px = next_random(seed);
+  a.sprite.resize(48 * 48);
+  for (auto &px : a.sprite) {
+    px = next_random(seed);
+    // plenty of fully transparent and fully opaque pixels, like real sprites
+    u32 alpha = (px & 3) == 0 ? 0x00 : (px & 3) == 1 ? 0xFF : px >> 24;
+    px = (alpha << 24) | (next_random(seed) & 0xFFFFFF);
+  }
+  for (u32 px : a.sprite) {
+    u32 alpha = px >> 24, c = alpha << 24;
+    for (u32 shift = 0; shift < 24; shift += 8)
+      c |= (((px >> shift) & 0xFF) * alpha + 127) / 255 << shift;
+    a.premultiplied.push_back(c);
+  }
+  a.sprite1555.resize(32 * 32);
+  for (auto &px : a.sprite1555)
+    px = next_random(seed);
+  a.indexed.resize(40 * 40);
+  for (auto &px : a.indexed)
+    px = next_random(seed);
+  // anti-aliased glyphs: mostly empty or fully covered
+  for (u32 i = 0; i < 16 * 24; ++i) {
+    u32 v = next_random(seed), pick = v & 3;
+    a.coverage8.push_back(pick < 2 ? 0 : pick == 2 ? 0xFF : v >> 8);
+  }
+  for (u32 i = 0; i < 16 * 24 / 2; ++i)
+    a.coverage4.push_back(next_random(seed));
+  for (u32 i = 0; i < 256; ++i) {
+    a.palette_a[i] = 0xFF000000 | next_random(seed);
+    a.palette_b[i] = (next_random(seed) << 24) | next_random(seed);
+  }
+  return a;
+}
+
+// The driver, with simulated CPU work between submissions
+template <bool SYNC> struct Driver {
+  static void after_submit() {
+    if (SYNC)
+      hal::gpu::backend::wait_idle();
+  }
+  static void fill(Surface dst, u32 color) {
+    hal::gpu::backend::fill(dst, color);
+    after_submit();
+  }
+  static void blit(Surface dst, ConstSurface src) {
+    hal::gpu::backend::blit(dst, src);
+    after_submit();
+  }
+  static void blit_blend(Surface dst, ConstSurface src, u8 alpha) {
+    hal::gpu::backend::blit_blend(dst, src, alpha);
+    after_submit();
+  }
+  static void blit_blend_premultiplied(Surface dst, ConstSurface src,
+                                       u8 alpha) {
+    hal::gpu::backend::blit_blend_premultiplied(dst, src, alpha);
+    after_submit();
+  }
+  static void blit_blend_alpha(Surface dst, ConstSurface src, u32 color,
+                               u8 alpha) {
+    hal::gpu::backend::blit_blend_alpha(dst, src, color, alpha);
+    after_submit();
+  }
+  static void load_palette(const u32 *colors, usize num_colors) {
+    hal::gpu::backend::load_palette(colors, num_colors);
+    after_submit();
+  }
+  static void blit_indexed(Surface dst, ConstSurface src) {
+    hal::gpu::backend::blit_indexed(dst, src);
+    after_submit();
+  }
+  static u32 insert_fence() { return hal::gpu::backend::insert_fence(); }
+  static void wait_fence(u32 fence) { hal::gpu::backend::wait_fence(fence); }
+  static void cpu_work(u64 cycles) { model::advance(cycles); }
+};
+
+// What the PC backend does with the same calls
+struct Reference {
+  static void fill(Surface dst, u32 color) { hal::sw::fill(dst, color); }
+  static void blit(Surface dst, ConstSurface src) { hal::sw::blit(dst, src); }
+  static void blit_blend(Surface dst, ConstSurface src, u8 alpha) {
+    hal::sw::blit_blend(dst, src, alpha);
+  }
+  static void blit_blend_premultiplied(Surface dst, ConstSurface src,
+                                       u8 alpha) {
+    hal::sw::blit_blend_premultiplied(dst, src, alpha);
+  }
+  static void blit_blend_alpha(Surface dst, ConstSurface src, u32 color,
+                               u8 alpha) {
+    hal::sw::blit_blend_alpha(dst, src, color, alpha);
+  }
+  static void load_palette(const u32 *colors, usize num_colors) {
+    hal::sw::load_palette(colors, num_colors);
+  }
+  static void blit_indexed(Surface dst, ConstSurface src) {
+    hal::sw::blit_indexed(dst, src);
+  }
+  static u32 insert_fence() { return 0; }
+  static void wait_fence(u32) {}
+  static void cpu_work(u64) {}
+};
+
+// Roughly the shape of a game frame: backgrounds, many small fills, tiles,
+// blended sprites, palette switches and a CPU read-back.
+template <class Gpu> void draw_frame(Surface fb, const Assets &a, int frame) {
+  Gpu::fill(fb, 0x3186);
+
+  for (u32 y = 0; y < 80; ++y) {
+    Gpu::fill(fb.subsurface(0, y, WIDTH, 1), 0x001F + (y << 6));
+    Gpu::cpu_work(40);
+  }
+
+  for (u32 y = 160; y < HEIGHT; y += 32) {
+    for (u32 x = 0; x < WIDTH; x += 64)
+      Gpu::blit(fb.subsurface(x, y, 64, 32), a.tile_surface());
+    Gpu::cpu_work(200);
+  }
+
+  u32 seed = 777 + frame;
+  for (int i = 0; i < 60; ++i) {
+    u32 x = next_random(seed) % 200, y = 20 + next_random(seed) % 60;
+    u32 len = 4 + next_random(seed) % 36;
+    Gpu::fill(fb.subsurface(x, y, len, 1), next_random(seed) & 0xFFFF);
+    Gpu::cpu_work(30);
+  }
+
+  Gpu::blit_blend(fb.subsurface(96 + frame, 140, 48, 48), a.sprite_surface(),
+                  0xFF);
+  Gpu::cpu_work(500);
+  Gpu::blit_blend(fb.subsurface(20, 150, 48, 48), a.sprite_surface(), 0x80);
+  Gpu::blit_blend(fb.subsurface(150, 100, 32, 32), a.sprite1555_surface(),
+                  0xFF);
+  Gpu::cpu_work(500);
+  // blended by the CPU on the board, after the transfers before it
+  Gpu::blit_blend_premultiplied(fb.subsurface(180, 130, 48, 48),
+                                a.premultiplied_surface(), 0xFF);
+  Gpu::blit_blend_premultiplied(fb.subsurface(30, 210, 48, 48),
+                                a.premultiplied_surface(), 0x80);
+
+  // text: the color comes from FGCOLR
+  for (u32 x = 4; x < 200; x += 14)
+    Gpu::blit_blend_alpha(fb.subsurface(x, 290, 16, 24), a.coverage8_surface(),
+                          0xFFE0C0 + x, 0xFF);
+  Gpu::blit_blend_alpha(fb.subsurface(200, 260, 16, 24),
+                        a.coverage4_surface(), 0x40FF80, 0xFF);
+  Gpu::blit_blend_alpha(fb.subsurface(220, 260, 16, 24),
+                        a.coverage4_surface(), 0x2040FF, 0x90);
+  Gpu::cpu_work(300);
+
+  // the CLUT must switch between the two blits, not before the first
+  Gpu::load_palette(a.palette_a, 256);
+  Gpu::blit_indexed(fb.subsurface(10, 10, 40, 40), a.indexed_surface());
+  Gpu::load_palette(a.palette_b, 256);
+  Gpu::blit_indexed(fb.subsurface(60, 10, 40, 40), a.indexed_surface());
+  Gpu::blit_blend(fb.subsurface(110, 10, 40, 40), a.indexed_surface(), 0xC0);
+
+  // strided source and destination
+  Gpu::blit(fb.subsurface(200, 10, 30, 20),
+            a.tile_surface().subsurface(7, 3, 30, 20));
+  Gpu::cpu_work(300);
+
+  // read back what the DMA2D drew, then draw on top of it with the CPU
+  u32 fence = Gpu::insert_fence();
+  Gpu::cpu_work(2000);
+  Gpu::wait_fence(fence);
+  for (u32 x = 0; x < 100; ++x) {
+    u16 px = fb.get_pixel(x, 30);
+    fb.set_pixel(x, 31, static_cast<u16>(~px));
+  }
+  Gpu::blit(fb.subsurface(0, 200, 100, 2),
+            fb.subsurface(0, 30, 100, 2).as_const());
+}
+
+template <class Gpu> void draw(std::vector<u16> &pixels, const Assets &a) {
+  Surface fb{pixels.data(), WIDTH, WIDTH, HEIGHT, PixelFormat::RGB565};
+  for (int frame = 0; frame < FRAMES; ++frame) {
+    draw_frame<Gpu>(fb, a, frame);
+    // tick() of the next frame
+    Gpu::cpu_work(100000);
+  }
+  hal::gpu::backend::wait_idle();
+}
+
+struct Run {
+  model::Stats model;
+  hal::stm::Dma2dStats queue;
+  bool matches;
+};
+
+template <bool SYNC>
+Run run_driver(const Assets &a, const std::vector<u16> &reference) {
+  std::vector<u16> pixels(WIDTH * HEIGHT);
+  model::reset();
+  hal::stm::reset_dma2d_stats();
+  hal::stm::init_dma2d();
+  draw<Driver<SYNC>>(pixels, a);
+  bool matches = std::memcmp(pixels.data(), reference.data(),
+                             pixels.size() * sizeof(u16)) == 0;
+  return {model::stats(), hal::stm::dma2d_stats(), matches};
+}
+
+void print_run(const char *name, const Run &run) {
+  const auto &s = run.model;
+  u64 overlap = s.busy_cycles - (s.wait_cycles - s.idle_waits);
+  std::printf("%-6s %10llu %10llu %10llu %9.1f%% %6u %6u %6u %s\n", name,
+              static_cast<unsigned long long>(s.cycles),
+              static_cast<unsigned long long>(s.busy_cycles),
+              static_cast<unsigned long long>(s.wait_cycles),
+              s.busy_cycles ? 100.0 * overlap / s.busy_cycles : 0.0,
+              run.queue.submitted, run.queue.max_depth, run.queue.full_stalls,
+              run.matches ? "ok" : "MISMATCH");
+}
+
+} // namespace
+
+int main() {
+  auto assets = make_assets();
+
+  std::vector<u16> reference(WIDTH * HEIGHT);
+  draw<Reference>(reference, assets);
+
+  auto sync = run_driver<true>(assets, reference);
+  auto async = run_driver<false>(assets, reference);
+
+  std::printf("%-6s %10s %10s %10s %10s %6s %6s %6s %s\n", "mode", "cycles",
+              "dma busy", "cpu wait", "overlap", "xfers", "depth", "stalls",
+              "output");
+  print_run("sync", sync);
+  print_run("async", async);
+
+  bool ok = sync.matches && async.matches && sync.queue.errors == 0 &&
+            async.queue.errors == 0 && sync.model.config_errors == 0 &&
+            async.model.config_errors == 0;
+  if (!ok)
+    std::printf("dma2d model: driver output differs from the software "
+                "backend\n");
+  return ok ? 0 : 1;
+}